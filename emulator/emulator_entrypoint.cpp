@@ -2,6 +2,7 @@
 
 #include "../src/common/platform/interface/platform.hpp"
 #include "../src/common/platform/emulator/sfml_display.hpp"
+#include "../src/common/platform/emulator/sfml_event_pump.hpp"
 #include "../src/common/platform/emulator/emulator_delay.cpp"
 #include "../src/common/platform/emulator/sfml_controller.hpp"
 #include "../src/common/platform/emulator/sfml_awsd_controller.hpp"
@@ -9,9 +10,16 @@
 #include "../src/common/platform/emulator/sfml_action_controller.hpp"
 #include "../src/common/platform/emulator/persistent_storage.hpp"
 
+#include "../src/common/key_repeat.hpp"
+#include "../src/common/latency_tracer.hpp"
 #include "../src/common/logging.hpp"
+#include "../src/common/record_store.hpp"
+#include "../src/common/replay.hpp"
 
 #include "../src/games/game_menu.hpp"
+#include "../src/games/high_scores.hpp"
+#include "../src/games/settings_cache.hpp"
+#include <cstring>
 #include <iostream>
 
 // TODO: clean up the mainteinance of the size constants
@@ -22,11 +30,11 @@
 
 SfmlDisplay *display;
 EmulatorDelay delay;
-SfmlInputController controller;
-SfmlAwsdInputController awsd_controller;
-SfmlHjklInputController hjkl_controller;
-SfmlActionInputController action_controller;
-PersistentStorage persistent_storage;
+SfmlEventPump *event_pump;
+SfmlInputController *controller;
+SfmlAwsdInputController *awsd_controller;
+SfmlHjklInputController *hjkl_controller;
+SfmlActionInputController *action_controller;
 
 void print_version(char *argv[]);
 int main(int argc, char *argv[])
@@ -50,25 +58,40 @@ int main(int argc, char *argv[])
         LOG_DEBUG(TAG, "Window rendered!");
 
         LOG_DEBUG(TAG, "Initializing the display...");
-        display = new SfmlDisplay(&window, &texture);
+        // The key events are dispatched to the controllers by the event pump,
+        // so it needs to exist before both the display and the controllers.
+        event_pump = new SfmlEventPump(&window, &delay);
+        display = new SfmlDisplay(&window, &texture, event_pump);
         display->setup();
         LOG_DEBUG(TAG, "Display initialized!");
 
-        controller = SfmlInputController{};
-        awsd_controller = SfmlAwsdInputController{};
-        hjkl_controller = SfmlHjklInputController{};
-        action_controller = SfmlActionInputController{};
-
-        persistent_storage = PersistentStorage{};
+        controller = new SfmlInputController(event_pump);
+        awsd_controller = new SfmlAwsdInputController(event_pump);
+        hjkl_controller = new SfmlHjklInputController(event_pump);
+        action_controller = new SfmlActionInputController(event_pump);
+
+        // The EEPROM image can be swapped using `--storage <file>`, e.g. to
+        // keep the settings used for recording replays separate.
+        const char *storage_path = PERSISTENT_STORAGE_FILE;
+        if (argc >= 3 && strcmp(argv[argc - 2], "--storage") == 0) {
+                storage_path = argv[argc - 1];
+                argc -= 2;
+        }
+        PersistentStorage persistent_storage(storage_path);
+        RecordStore record_store(&persistent_storage);
+        record_store.mount();
+        SettingsCache settings_cache(&record_store);
+        settings_cache.load();
+        HighScores high_scores(&record_store);
 
         std::vector<DirectionalController *> controllers = {
-            &controller,
-            &awsd_controller,
-            &hjkl_controller,
+            controller,
+            awsd_controller,
+            hjkl_controller,
         };
 
         std::vector<ActionController *> action_controllers = {
-            &action_controller,
+            action_controller,
         };
 
 
@@ -76,18 +99,45 @@ int main(int argc, char *argv[])
                              .directional_controllers = &controllers,
                              .action_controllers = &action_controllers,
                              .delay_provider = &delay,
-                             .persistent_storage = &persistent_storage};
+                             .persistent_storage = &persistent_storage,
+                             .record_store = &record_store,
+                             .settings_cache = &settings_cache,
+                             .high_scores = &high_scores};
+
+        // When started with `--replay <file>`, the emulator plays back the
+        // recorded game and exits. With `--replay-stored` it plays back the
+        // last game kept in the EEPROM image instead.
+        bool replay_file = argc == 3 && strcmp(argv[1], "--replay") == 0;
+        bool replay_stored =
+            argc == 2 && strcmp(argv[1], "--replay-stored") == 0;
+        if (replay_file || replay_stored) {
+                ReplayLog *log = new ReplayLog();
+                bool loaded = replay_file ? load_replay_file(log, argv[2])
+                                          : load_replay(log, &record_store);
+                if (loaded) {
+                        replay_game(&platform, log);
+                } else if (replay_stored) {
+                        LOG_INFO(TAG, "No replay found in %s.", storage_path);
+                }
+                delete log;
+                log_drain();
+                return 0;
+        }
 
+        KeyRepeatPlatform key_repeat(&platform);
+        LatencyTracer latency_tracer(key_repeat.get_platform());
         while (window.isOpen()) {
                 LOG_DEBUG(TAG, "Entering game loop...");
                 // We need to loop forever here as the game loop exits when the
                 // game is over.
                 while (true) {
                         try {
-                                select_game(&platform);
+                                select_game(latency_tracer.get_platform());
                         } catch (std::runtime_error &e) {
                                 LOG_DEBUG(TAG, "Game loop exited: %s",
                                           e.what());
+                                latency_tracer.report();
+                                log_drain();
                                 break;
                         }
                 }
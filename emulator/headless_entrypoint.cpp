@@ -0,0 +1,189 @@
+#include "emulator_config.h"
+
+#include "../src/common/platform/interface/platform.hpp"
+#include "../src/common/platform/headless/headless_display.hpp"
+#include "../src/common/platform/headless/null_delay.hpp"
+#include "../src/common/platform/headless/scripted_controller.hpp"
+#include "../src/common/platform/emulator/persistent_storage.hpp"
+
+#include "../src/common/constants.hpp"
+#include "../src/common/key_repeat.hpp"
+#include "../src/common/latency_tracer.hpp"
+#include "../src/common/logging.hpp"
+#include "../src/common/record_store.hpp"
+#include "../src/common/replay.hpp"
+
+#include "../src/games/game_menu.hpp"
+#include "../src/games/high_scores.hpp"
+#include "../src/games/settings_cache.hpp"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#define DISPLAY_HEIGHT 240
+#define DISPLAY_WIDTH 280
+
+/**
+ * Once the script runs out of inputs, the console is given this much time
+ * to finish the current game before the run is stopped.
+ */
+#define HEADLESS_IDLE_TIMEOUT_MS 10000
+#define FUZZ_MAX_INTERVAL_MS 400
+
+#define TAG "headless_entrypoint"
+
+void print_usage(char *argv[]);
+void print_summary(HeadlessDisplay *display, NullDelayProvider *delay,
+                   InputScript *script,
+                   std::chrono::steady_clock::duration wall_time);
+
+/**
+ * Runs the game console without a window and without sleeping, feeding it
+ * inputs from a script file, randomly generated inputs or a recorded replay.
+ * Once done, it prints the number of primitives drawn and the checksum of the
+ * final frame, which makes it usable for profiling and fuzzing the games.
+ */
+int main(int argc, char *argv[])
+{
+        if (argc < 2) {
+                print_usage(argv);
+                return 1;
+        }
+
+        const char *storage_path = PERSISTENT_STORAGE_FILE;
+        if (argc >= 4 && strcmp(argv[argc - 2], "--storage") == 0) {
+                storage_path = argv[argc - 1];
+                argc -= 2;
+        }
+        const char *screenshot = NULL;
+        if (argc >= 4 && strcmp(argv[argc - 2], "--screenshot") == 0) {
+                screenshot = argv[argc - 1];
+                argc -= 2;
+        }
+
+        HeadlessDisplay display(DISPLAY_WIDTH, DISPLAY_HEIGHT,
+                                DISPLAY_CORNER_RADIUS);
+        NullDelayProvider delay;
+        PersistentStorage persistent_storage(storage_path);
+        RecordStore record_store(&persistent_storage);
+        record_store.mount();
+        SettingsCache settings_cache(&record_store);
+        settings_cache.load();
+        HighScores high_scores(&record_store);
+        InputScript script(&delay);
+        ScriptedDirectionalController controller(&script);
+        ScriptedActionController action_controller(&script);
+
+        std::vector<DirectionalController *> controllers = {&controller};
+        std::vector<ActionController *> action_controllers = {
+            &action_controller};
+
+        Platform platform = {.display = &display,
+                             .directional_controllers = &controllers,
+                             .action_controllers = &action_controllers,
+                             .delay_provider = &delay,
+                             .persistent_storage = &persistent_storage,
+                             .record_store = &record_store,
+                             .settings_cache = &settings_cache,
+                             .high_scores = &high_scores};
+
+        auto start = std::chrono::steady_clock::now();
+        bool replay_file = argc == 3 && strcmp(argv[1], "--replay") == 0;
+        bool replay_stored =
+            argc == 2 && strcmp(argv[1], "--replay-stored") == 0;
+        if (replay_file || replay_stored) {
+                ReplayLog *log = new ReplayLog();
+                bool loaded = replay_file ? load_replay_file(log, argv[2])
+                                          : load_replay(log, &record_store);
+                if (loaded) {
+                        // The replay runs on the clock of the player, the
+                        // console clock is advanced by the same amount so
+                        // that the summary reports the virtual time.
+                        delay.delay_ms(replay_game(&platform, log));
+                } else if (replay_stored) {
+                        std::cerr << "No replay found in " << storage_path
+                                  << std::endl;
+                }
+                delete log;
+                if (!loaded) {
+                        return 1;
+                }
+        } else {
+                if (argc == 3 && strcmp(argv[1], "--script") == 0) {
+                        if (!script.load(argv[2])) {
+                                return 1;
+                        }
+                } else if (argc == 4 && strcmp(argv[1], "--fuzz") == 0) {
+                        unsigned int seed = strtoul(argv[2], NULL, 10);
+                        srand(seed);
+                        script.generate_random(seed, atoi(argv[3]),
+                                               FUZZ_MAX_INTERVAL_MS);
+                } else {
+                        print_usage(argv);
+                        return 1;
+                }
+
+                // The game loop never returns on its own, the time limit is
+                // the only way to stop it once the script is over.
+                delay.set_time_limit(script.get_end_time() +
+                                     HEADLESS_IDLE_TIMEOUT_MS);
+                KeyRepeatPlatform key_repeat(&platform);
+                LatencyTracer latency_tracer(key_repeat.get_platform());
+                try {
+                        while (true) {
+                                select_game(latency_tracer.get_platform());
+                        }
+                } catch (std::runtime_error &e) {
+                        LOG_DEBUG(TAG, "Game loop exited: %s", e.what());
+                }
+                // The run usually ends in the middle of a game, so the
+                // latencies of that game haven't been reported yet.
+                latency_tracer.report();
+        }
+        // The messages logged since the last game returned are still
+        // buffered in the binary logging mode.
+        log_drain();
+        print_summary(&display, &delay, &script,
+                      std::chrono::steady_clock::now() - start);
+
+        if (screenshot && !display.save_ppm(screenshot)) {
+                std::cerr << "Unable to write " << screenshot << std::endl;
+                return 1;
+        }
+        return 0;
+}
+
+void print_usage(char *argv[])
+{
+        std::cerr << argv[0] << " version " << EMULATOR_VERSION_MAJOR << "."
+                  << EMULATOR_VERSION_MINOR << "\n"
+                  << "Usage:\n"
+                  << "  " << argv[0]
+                  << " --script <file> [options]\n"
+                  << "  " << argv[0] << " --fuzz <seed> <inputs> [options]\n"
+                  << "  " << argv[0] << " --replay <file> [options]\n"
+                  << "  " << argv[0] << " --replay-stored [options]\n"
+                  << "Options, in this order:\n"
+                  << "  --screenshot <ppm>  save the final frame\n"
+                  << "  --storage <file>    EEPROM image to use instead of "
+                  << PERSISTENT_STORAGE_FILE << std::endl;
+}
+
+void print_summary(HeadlessDisplay *display, NullDelayProvider *delay,
+                   InputScript *script,
+                   std::chrono::steady_clock::duration wall_time)
+{
+        HeadlessDisplayStats stats = display->get_stats();
+        long wall_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(wall_time)
+                .count();
+        printf("Virtual time: %lu ms\n", delay->get_time_ms());
+        printf("Wall time:    %ld ms\n", wall_ms);
+        printf("Primitives:   %lu\n", stats.primitives);
+        printf("Strings:      %lu\n", stats.strings);
+        printf("Bitmaps:      %lu\n", stats.bitmaps);
+        printf("Pixels:       %lu\n", stats.pixels);
+        printf("Dropped:      %d inputs\n", script->get_dropped_inputs());
+        printf("Checksum:     %016llx\n",
+               (unsigned long long)display->checksum());
+}
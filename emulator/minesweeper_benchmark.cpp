@@ -0,0 +1,180 @@
+#include "../src/common/platform/emulator/emulator_delay.cpp"
+#include "../src/common/logging.hpp"
+#include "../src/games/minesweeper_generator.hpp"
+#include "../src/games/minesweeper_solver.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#define TAG "minesweeper_benchmark"
+
+/**
+ * Number of boards generated for each grid size and mine count.
+ */
+#define BENCHMARK_ITERATIONS 100
+
+typedef struct BenchmarkGridSize {
+        int rows;
+        int cols;
+        const char *description;
+} BenchmarkGridSize;
+
+/**
+ * The grid size depends on the display and the font width, we benchmark the
+ * sizes used on the console and the emulator.
+ */
+BenchmarkGridSize GRID_SIZES[] = {
+    {.rows = 12, .cols = 21, .description = "console"},
+    {.rows = 12, .cols = 24, .description = "emulator"},
+};
+
+/**
+ * Those need to be kept in sync with the options in the Minesweeper config.
+ */
+int MINES_NUMS[] = {10, 15, 25, 30, 35};
+
+/**
+ * Mine counts used for measuring the solver latency per move. Dense boards
+ * have the longest frontiers, which is where the solver does the most work.
+ */
+int DENSE_MINES_NUMS[] = {35, 45, 55, 65};
+
+typedef struct SolverLatency {
+        int moves;
+        double total_us;
+        double max_us;
+} SolverLatency;
+
+/**
+ * Plays a single game the same way as the in-game solver is driven: each move
+ * uncovers one cell and the solver is updated incrementally. The simulated
+ * player uncovers cells that the solver deduced to be safe and guesses a
+ * random safe cell whenever no deduction is available (this way the game
+ * always runs until the whole board is uncovered).
+ */
+static void measure_solver_moves(MinesweeperBoard *board,
+                                 MinesweeperSolver *solver, int mines_num,
+                                 SolverLatency *latency)
+{
+        int remaining = board->size() - mines_num;
+        while (remaining > 0) {
+                int idx = solver->find_safe_cell();
+                if (idx == -1) {
+                        do {
+                                idx = rand() % board->size();
+                        } while (board->is_bomb(idx) ||
+                                 board->is_uncovered(idx));
+                }
+
+                auto start = std::chrono::steady_clock::now();
+                board->set_uncovered(idx, true);
+                solver->cell_uncovered(idx);
+                solver->propagate();
+                while (solver->next_deduced_mine() != -1) {
+                }
+                std::chrono::duration<double, std::micro> elapsed =
+                    std::chrono::steady_clock::now() - start;
+
+                remaining--;
+                latency->moves++;
+                latency->total_us += elapsed.count();
+                if (elapsed.count() > latency->max_us) {
+                        latency->max_us = elapsed.count();
+                }
+        }
+}
+
+/**
+ * Measures the latency of the solvable Minesweeper board generator for all
+ * grid sizes and available mine counts, followed by the latency of a single
+ * incremental solver update on dense boards.
+ */
+int main()
+{
+        // We don't want the generator logs to clutter the benchmark output.
+        log_run_level = LogLevel::LOG_LVL_ERROR;
+        EmulatorDelay clock;
+        srand(0);
+
+        std::cout << "grid,rows,cols,mines,solvable_pct,avg_attempts,"
+                     "avg_ms,max_ms"
+                  << std::endl;
+
+        for (BenchmarkGridSize size : GRID_SIZES) {
+                for (int mines_num : MINES_NUMS) {
+                        MinesweeperBoard board(size.rows, size.cols);
+                        int solvable = 0;
+                        int total_attempts = 0;
+                        double total_ms = 0;
+                        double max_ms = 0;
+
+                        for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+                                Point first_click = {
+                                    .x = rand() % size.cols,
+                                    .y = rand() % size.rows};
+
+                                auto start = std::chrono::steady_clock::now();
+                                MinesweeperGenerationReport report =
+                                    generate_solvable_board(
+                                        &board, mines_num, &first_click,
+                                        &clock,
+                                        MINESWEEPER_GENERATION_BUDGET_MS);
+                                std::chrono::duration<double, std::milli>
+                                    elapsed =
+                                        std::chrono::steady_clock::now() -
+                                        start;
+
+                                solvable += report.solvable;
+                                total_attempts += report.attempts;
+                                total_ms += elapsed.count();
+                                if (elapsed.count() > max_ms) {
+                                        max_ms = elapsed.count();
+                                }
+                        }
+
+                        std::cout << size.description << "," << size.rows
+                                  << "," << size.cols << "," << mines_num
+                                  << ","
+                                  << 100.0 * solvable / BENCHMARK_ITERATIONS
+                                  << ","
+                                  << (double)total_attempts /
+                                         BENCHMARK_ITERATIONS
+                                  << "," << total_ms / BENCHMARK_ITERATIONS
+                                  << "," << max_ms << std::endl;
+                }
+        }
+
+        std::cout << std::endl
+                  << "grid,rows,cols,mines,moves,avg_move_us,max_move_us"
+                  << std::endl;
+
+        for (BenchmarkGridSize size : GRID_SIZES) {
+                for (int mines_num : DENSE_MINES_NUMS) {
+                        MinesweeperBoard board(size.rows, size.cols);
+                        MinesweeperSolver solver(&board, false);
+                        uint16_t *cell_indices = new uint16_t[board.size()];
+                        SolverLatency latency = {
+                            .moves = 0, .total_us = 0, .max_us = 0};
+
+                        for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+                                Point first_click = {
+                                    .x = rand() % size.cols,
+                                    .y = rand() % size.rows};
+                                board.clear();
+                                place_bombs(&board, mines_num, &first_click,
+                                            cell_indices);
+                                solver.reset();
+                                measure_solver_moves(&board, &solver,
+                                                     mines_num, &latency);
+                        }
+                        delete[] cell_indices;
+
+                        std::cout << size.description << "," << size.rows
+                                  << "," << size.cols << "," << mines_num
+                                  << "," << latency.moves << ","
+                                  << latency.total_us / latency.moves << ","
+                                  << latency.max_us << std::endl;
+                }
+        }
+}
@@ -0,0 +1,149 @@
+#include "../src/common/logging.hpp"
+#include "../src/games/minesweeper_flood_fill.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#define TAG "minesweeper_flood_fill_stress"
+
+/**
+ * The largest grid, it is used by the emulator. The console grid is 12x21.
+ */
+#define STRESS_GRID_ROWS 12
+#define STRESS_GRID_COLS 24
+
+/**
+ * The default capacity is what the game uses, a single seed makes the queue
+ * overflow on every span and forces the fill to rescan the grid.
+ */
+int QUEUE_CAPACITIES[] = {FLOOD_FILL_QUEUE_CAPACITY, 4, 1};
+
+typedef enum StressBoardLayout {
+        /**
+         * No mines and no flags, a single click uncovers the whole grid.
+         */
+        Empty,
+        /**
+         * Every other column is a wall of flagged cells with a gap
+         * alternating between its top and bottom cell. The empty region is a
+         * single serpentine path, so the fill has to go through many spans.
+         */
+        Serpentine,
+} StressBoardLayout;
+
+static const char *layout_to_string(StressBoardLayout layout)
+{
+        switch (layout) {
+        case Empty:
+                return "empty";
+        case Serpentine:
+                return "serpentine";
+        }
+        return "unknown";
+}
+
+static void set_up_board(MinesweeperBoard *board, StressBoardLayout layout)
+{
+        board->clear();
+        if (layout != Serpentine) {
+                return;
+        }
+        for (int x = 1; x < board->cols; x += 2) {
+                int gap_y = (x / 2) % 2 == 0 ? board->rows - 1 : 0;
+                for (int y = 0; y < board->rows; y++) {
+                        if (y != gap_y) {
+                                board->set_flagged(board->index(x, y), true);
+                        }
+                }
+        }
+}
+
+/**
+ * Runs the flood fill from the given cell and checks that all cells that
+ * aren't flagged got uncovered, each of them exactly once. Returns false and
+ * prints the reason if that's not the case.
+ */
+static bool run_flood_fill(MinesweeperBoard *board, StressBoardLayout layout,
+                           int start_x, int start_y, int queue_capacity)
+{
+        set_up_board(board, layout);
+        int total_uncovered = 0;
+        std::vector<uint16_t> batch;
+        flood_fill_from(board, start_x, start_y, &total_uncovered, &batch,
+                        queue_capacity);
+
+        int expected = 0;
+        for (int idx = 0; idx < board->size(); idx++) {
+                if (board->is_flagged(idx)) {
+                        continue;
+                }
+                expected++;
+                if (!board->is_uncovered(idx)) {
+                        std::cout << "FAIL " << layout_to_string(layout)
+                                  << " board, start (" << start_x << ", "
+                                  << start_y << "), queue capacity "
+                                  << queue_capacity << ": cell ("
+                                  << board->x_of(idx) << ", "
+                                  << board->y_of(idx) << ") is covered"
+                                  << std::endl;
+                        return false;
+                }
+        }
+
+        std::vector<bool> seen(board->size(), false);
+        for (uint16_t idx : batch) {
+                if (seen[idx]) {
+                        std::cout << "FAIL " << layout_to_string(layout)
+                                  << " board: cell " << idx
+                                  << " was uncovered twice" << std::endl;
+                        return false;
+                }
+                seen[idx] = true;
+        }
+
+        if (total_uncovered != expected || (int)batch.size() != expected) {
+                std::cout << "FAIL " << layout_to_string(layout)
+                          << " board, start (" << start_x << ", " << start_y
+                          << "), queue capacity " << queue_capacity
+                          << ": expected " << expected
+                          << " uncovered cells, counted " << total_uncovered
+                          << ", batch of " << batch.size() << std::endl;
+                return false;
+        }
+        return true;
+}
+
+int main()
+{
+        // The rescans after the queue overflows are logged, we only want to
+        // see the failures.
+        log_run_level = LogLevel::LOG_LVL_ERROR;
+
+        MinesweeperBoard board(STRESS_GRID_ROWS, STRESS_GRID_COLS);
+        int runs = 0;
+        int failures = 0;
+
+        for (StressBoardLayout layout : {Empty, Serpentine}) {
+                for (int queue_capacity : QUEUE_CAPACITIES) {
+                        for (int y = 0; y < board.rows; y++) {
+                                for (int x = 0; x < board.cols; x++) {
+                                        set_up_board(&board, layout);
+                                        if (board.is_flagged(
+                                                board.index(x, y))) {
+                                                continue;
+                                        }
+                                        runs++;
+                                        failures += !run_flood_fill(
+                                            &board, layout, x, y,
+                                            queue_capacity);
+                                }
+                        }
+                }
+        }
+
+        std::cout << runs << " flood fills on a " << STRESS_GRID_ROWS << "x"
+                  << STRESS_GRID_COLS << " grid, " << failures << " failed"
+                  << std::endl;
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,100 @@
+#include "../src/common/platform/emulator/emulator_delay.cpp"
+#include "../src/common/logging.hpp"
+#include "../src/games/minesweeper_generator.hpp"
+
+#include <cstdlib>
+#include <iostream>
+
+#define TAG "minesweeper_generator_test"
+
+/**
+ * Number of boards generated for each mine count, each with a different
+ * first click and different flags.
+ */
+#define TEST_ITERATIONS 50
+#define TEST_FLAGS_NUM 8
+
+/**
+ * The largest grid, it is used by the emulator.
+ */
+#define MINESWEEPER_TEST_ROWS 12
+#define MINESWEEPER_TEST_COLS 24
+#define MINESWEEPER_TEST_MAX_CELLS                                             \
+        (MINESWEEPER_TEST_ROWS * MINESWEEPER_TEST_COLS)
+
+/**
+ * Those need to be kept in sync with the options in the Minesweeper config.
+ */
+int MINES_NUMS[] = {10, 15, 25, 30, 35};
+
+/**
+ * The player can place flags before the first move, the generator needs to
+ * keep them while it tries out the mine layouts. Returns false and prints
+ * the reason if a flag got lost or the layout is wrong.
+ */
+static bool check_flags_survive(MinesweeperBoard *board, int mines_num,
+                                DelayProvider *clock)
+{
+        board->clear();
+        bool flagged[MINESWEEPER_TEST_MAX_CELLS] = {};
+        for (int i = 0; i < TEST_FLAGS_NUM; i++) {
+                int idx = rand() % board->size();
+                board->set_flagged(idx, true);
+                flagged[idx] = true;
+        }
+        Point first_click = {.x = rand() % board->cols,
+                             .y = rand() % board->rows};
+
+        generate_solvable_board(board, mines_num, &first_click, clock,
+                                MINESWEEPER_GENERATION_BUDGET_MS);
+
+        int bombs = 0;
+        for (int idx = 0; idx < board->size(); idx++) {
+                bombs += board->is_bomb(idx);
+                if (board->is_flagged(idx) != flagged[idx]) {
+                        std::cout << "FAIL " << mines_num << " mines: cell ("
+                                  << board->x_of(idx) << ", "
+                                  << board->y_of(idx) << ") "
+                                  << (flagged[idx] ? "lost its flag"
+                                                   : "got flagged")
+                                  << std::endl;
+                        return false;
+                }
+                if (board->is_uncovered(idx)) {
+                        std::cout << "FAIL " << mines_num << " mines: cell ("
+                                  << board->x_of(idx) << ", "
+                                  << board->y_of(idx) << ") is uncovered"
+                                  << std::endl;
+                        return false;
+                }
+        }
+        if (bombs != mines_num) {
+                std::cout << "FAIL " << mines_num << " mines: the board has "
+                          << bombs << " bombs" << std::endl;
+                return false;
+        }
+        return true;
+}
+
+int main()
+{
+        // We don't want the generator logs to clutter the test output.
+        log_run_level = LogLevel::LOG_LVL_ERROR;
+        EmulatorDelay clock;
+        srand(0);
+
+        MinesweeperBoard board(MINESWEEPER_TEST_ROWS, MINESWEEPER_TEST_COLS);
+        int runs = 0;
+        int failures = 0;
+        for (int mines_num : MINES_NUMS) {
+                for (int i = 0; i < TEST_ITERATIONS; i++) {
+                        runs++;
+                        failures +=
+                            !check_flags_survive(&board, mines_num, &clock);
+                }
+        }
+
+        std::cout << runs << " boards generated, " << failures << " failed"
+                  << std::endl;
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
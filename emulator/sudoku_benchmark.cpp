@@ -0,0 +1,136 @@
+#include "../src/common/platform/emulator/emulator_delay.cpp"
+#include "../src/common/logging.hpp"
+#include "../src/games/sudoku_generator.hpp"
+#include "../src/games/sudoku_solver.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#define TAG "sudoku_benchmark"
+
+/**
+ * Number of puzzles generated for each difficulty.
+ */
+#define BENCHMARK_ITERATIONS 100
+
+/**
+ * Generation budget used when producing the puzzle bank. The bank puzzles are
+ * generated offline, so they don't need to fit into the in-game budget.
+ */
+#define BANK_GENERATION_BUDGET_MS 60000
+
+SudokuDifficulty DIFFICULTIES[] = {Easy, Medium, Hard};
+
+const char *difficulty_to_str(SudokuDifficulty difficulty)
+{
+        switch (difficulty) {
+        case Easy:
+                return "easy";
+        case Medium:
+                return "medium";
+        default:
+                return "hard";
+        }
+}
+
+/**
+ * Prints `count` puzzles per difficulty in the format of the puzzle bank in
+ * `src/games/sudoku_puzzle_bank.cpp`.
+ */
+static void print_puzzle_bank(int count, EmulatorDelay *clock)
+{
+        uint8_t puzzle[SUDOKU_CELLS];
+        uint8_t solution[SUDOKU_CELLS];
+        for (SudokuDifficulty difficulty : DIFFICULTIES) {
+                std::cout << "// " << difficulty_to_str(difficulty)
+                          << std::endl;
+                int printed = 0;
+                while (printed < count) {
+                        SudokuGenerationReport report =
+                            generate_sudoku(puzzle, solution, difficulty,
+                                            clock, BANK_GENERATION_BUDGET_MS);
+                        if (report.from_bank) {
+                                continue;
+                        }
+                        std::cout << "\"";
+                        for (int i = 0; i < SUDOKU_CELLS; i++) {
+                                std::cout << (char)(puzzle[i] == 0
+                                                        ? '.'
+                                                        : '0' + puzzle[i]);
+                        }
+                        std::cout << "\"," << std::endl;
+                        printed++;
+                }
+        }
+}
+
+/**
+ * Measures the latency of the Sudoku generator for all difficulties, followed
+ * by the latency of the uniqueness check on the generated puzzles.
+ *
+ * If called with `--bank <count>`, it prints a new puzzle bank instead.
+ */
+int main(int argc, char *argv[])
+{
+        // We don't want the generator logs to clutter the benchmark output.
+        log_run_level = LogLevel::LOG_LVL_ERROR;
+        EmulatorDelay clock;
+        srand(0);
+
+        if (argc == 3 && strcmp(argv[1], "--bank") == 0) {
+                print_puzzle_bank(atoi(argv[2]), &clock);
+                return 0;
+        }
+
+        std::cout << "difficulty,target_clues,avg_clues,bank_pct,avg_ms,max_ms,"
+                     "avg_uniqueness_check_us"
+                  << std::endl;
+
+        uint8_t puzzle[SUDOKU_CELLS];
+        uint8_t solution[SUDOKU_CELLS];
+        SudokuSolver solver;
+        for (SudokuDifficulty difficulty : DIFFICULTIES) {
+                int total_clues = 0;
+                int from_bank = 0;
+                double total_ms = 0;
+                double max_ms = 0;
+                double total_check_us = 0;
+
+                for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+                        auto start = std::chrono::steady_clock::now();
+                        SudokuGenerationReport report = generate_sudoku(
+                            puzzle, solution, difficulty, &clock,
+                            SUDOKU_GENERATION_BUDGET_MS);
+                        std::chrono::duration<double, std::milli> elapsed =
+                            std::chrono::steady_clock::now() - start;
+
+                        total_clues += report.clues;
+                        from_bank += report.from_bank;
+                        total_ms += elapsed.count();
+                        if (elapsed.count() > max_ms) {
+                                max_ms = elapsed.count();
+                        }
+
+                        auto check_start = std::chrono::steady_clock::now();
+                        solver.load(puzzle);
+                        if (solver.count_solutions(2) != 1) {
+                                std::cerr << "Generated puzzle is not unique"
+                                          << std::endl;
+                                return 1;
+                        }
+                        std::chrono::duration<double, std::micro> check =
+                            std::chrono::steady_clock::now() - check_start;
+                        total_check_us += check.count();
+                }
+
+                std::cout << difficulty_to_str(difficulty) << ","
+                          << sudoku_target_clues(difficulty) << ","
+                          << (double)total_clues / BENCHMARK_ITERATIONS << ","
+                          << 100.0 * from_bank / BENCHMARK_ITERATIONS << ","
+                          << total_ms / BENCHMARK_ITERATIONS << "," << max_ms
+                          << "," << total_check_us / BENCHMARK_ITERATIONS
+                          << std::endl;
+        }
+}
@@ -3,14 +3,80 @@
 #include "src/common/platform/arduino/lcd_display.hpp"
 #include "src/common/platform/arduino/arduino_delay.cpp"
 #include "src/common/platform/interface/persistent_storage.hpp"
+#include "src/common/key_repeat.hpp"
+#include "src/common/record_store.hpp"
+#include "src/common/latency_tracer.hpp"
 
 #include "src/games/game_menu.hpp"
+#include "src/games/high_scores.hpp"
+#include "src/games/settings_cache.hpp"
 #include "src/games/2048.hpp"
 
+#include <FspTimer.h>
+
+/**
+ * Frequency at which the timer interrupt samples the keypad and the joystick.
+ * At 200 Hz the inputs are read every 5 ms, which is way shorter than even the
+ * quickest tap of a button.
+ */
+#define INPUT_SAMPLING_FREQUENCY_HZ 200.0f
+
 LcdDisplay display;
 JoystickController *joystick_controller;
 KeypadController *keypad_controller;
 PersistentStorage persistent_storage;
+RecordStore *record_store;
+SettingsCache *settings_cache;
+HighScores *high_scores;
+FspTimer input_sampling_timer;
+
+std::vector<DirectionalController *> controllers;
+std::vector<ActionController *> action_controllers;
+DelayProvider *delay_provider;
+Platform platform;
+/**
+ * The games run on top of the key repeat platform. It keeps the state of the
+ * held buttons, so it is created once and lives across the `loop` calls.
+ */
+KeyRepeatPlatform *key_repeat;
+LatencyTracer *latency_tracer;
+
+/**
+ * Timer interrupt handler feeding the input event queues of the controllers.
+ * It is the only producer of those queues, so no other code may call `sample`.
+ */
+void sample_inputs(timer_callback_args_t *args)
+{
+        unsigned long now = millis();
+        keypad_controller->sample(now);
+        joystick_controller->sample(now);
+}
+
+/**
+ * Starts a periodic timer sampling the inputs in the background. This way the
+ * inputs keep being recorded even while the game loop is blocked e.g. by
+ * rendering over SPI.
+ *
+ * Pin-change interrupts would fit the keypad better, but the pin of the blue
+ * button (9) has no external interrupt line on the UNO R4 Minima and the
+ * joystick needs to be sampled using the ADC anyway.
+ */
+void setup_input_sampling()
+{
+        uint8_t timer_type = GPT_TIMER;
+        int8_t channel = FspTimer::get_available_timer(timer_type);
+        if (channel < 0) {
+                // All general purpose timers are taken, force the use of a
+                // PWM timer instead.
+                channel = FspTimer::get_available_timer(timer_type, true);
+        }
+        input_sampling_timer.begin(TIMER_MODE_PERIODIC, timer_type, channel,
+                                   INPUT_SAMPLING_FREQUENCY_HZ, 0.0f,
+                                   sample_inputs);
+        input_sampling_timer.setup_overflow_irq();
+        input_sampling_timer.open();
+        input_sampling_timer.start();
+}
 
 void setup(void)
 {
@@ -30,6 +96,11 @@ void setup(void)
             new KeypadController((int (*)(unsigned char))&digitalRead);
 
         persistent_storage = PersistentStorage{};
+        record_store = new RecordStore(&persistent_storage);
+        record_store->mount();
+        settings_cache = new SettingsCache(record_store);
+        settings_cache->load();
+        high_scores = new HighScores(record_store);
 
         // Initialize the hardware LCD display
         display = LcdDisplay{};
@@ -40,24 +111,64 @@ void setup(void)
         // Todo: move this to some randomness provider as it is not specific
         // to the 2048 game.
         initialize_randomness_seed(analogRead(0));
+
+        // The stick must not be touched while the console is starting up, its
+        // resting position is measured before the sampling starts.
+        joystick_controller->calibrate();
+
+        // The sampling needs to start only after the controllers are created
+        // and after we are done using the ADC for the random seed.
+        setup_input_sampling();
+}
+
+/**
+ * Prints the whole EEPROM as hex over the serial port if `d` was sent to the
+ * console, e.g. to get the replay of the last game off the device. The output
+ * can be turned into an image using `xxd -r -p` and played back with
+ * `--replay-stored --storage <image>` in the emulator.
+ */
+void dump_storage_if_requested()
+{
+        bool requested = false;
+        while (Serial.available() > 0) {
+                requested |= Serial.read() == 'd';
+        }
+        if (!requested) {
+                return;
+        }
+        for (int offset = 0; offset < RECORD_STORE_SIZE; offset++) {
+                uint8_t byte;
+                persistent_storage.get(offset, byte);
+                Serial.print(byte >> 4, HEX);
+                Serial.print(byte & 0xF, HEX);
+                if (offset % 32 == 31) {
+                        Serial.println();
+                }
+        }
 }
 
 void loop(void)
 {
         Serial.println("Game console started.");
-        std::vector<DirectionalController *> controllers(1);
-        controllers[0] = joystick_controller;
-
-        std::vector<ActionController *> action_controllers(1);
-        action_controllers[0] = keypad_controller;
-
-        DelayProvider *delay_provider = new ArduinoDelay((void (*)(int))&delay);
-
-        Platform platform = {.display = &display,
-                             .directional_controllers = &controllers,
-                             .action_controllers = &action_controllers,
-                             .delay_provider = delay_provider,
-                             .persistent_storage = &persistent_storage};
+        // The loop returns after every game, so a dump requested during a
+        // game is printed once the user leaves it.
+        dump_storage_if_requested();
+        if (!key_repeat) {
+                controllers = {joystick_controller};
+                action_controllers = {keypad_controller};
+                delay_provider = new ArduinoDelay(
+                    (void (*)(int))&delay, (unsigned long (*)(void))&millis);
+                platform = {.display = &display,
+                            .directional_controllers = &controllers,
+                            .action_controllers = &action_controllers,
+                            .delay_provider = delay_provider,
+                            .persistent_storage = &persistent_storage,
+                            .record_store = record_store,
+                            .settings_cache = settings_cache,
+                            .high_scores = high_scores};
+                key_repeat = new KeyRepeatPlatform(&platform);
+                latency_tracer = new LatencyTracer(key_repeat->get_platform());
+        }
 
-        select_game(&platform);
+        select_game(latency_tracer->get_platform());
 }
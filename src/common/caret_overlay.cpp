@@ -0,0 +1,135 @@
+#include <cstring>
+
+#include "caret_overlay.hpp"
+
+/**
+ * The caret is rendered INSIDE the cell so that its border doesn't overlap
+ * the neighbouring cells.
+ */
+#define CARET_INSET 1
+
+CaretOverlay::CaretOverlay(Display *display, int cell_width, int cell_height,
+                           Color caret_color)
+    : display(display), cell_width(cell_width), cell_height(cell_height),
+      caret_color(caret_color), visible(false), position({.x = 0, .y = 0}),
+      saved_background(Black), saved_foreground(Black)
+{
+        int outline_width = cell_width - 2 * CARET_INSET;
+        int outline_height = cell_height - 2 * CARET_INSET;
+        int horizontal_size = (outline_width + 7) / 8;
+        int vertical_size = outline_height - 2;
+
+        saved_top = new uint8_t[horizontal_size];
+        saved_bottom = new uint8_t[horizontal_size];
+        saved_left = new uint8_t[vertical_size];
+        saved_right = new uint8_t[vertical_size];
+        int blank_size =
+            horizontal_size > vertical_size ? horizontal_size : vertical_size;
+        blank_strip = new uint8_t[blank_size];
+        memset(blank_strip, 0, blank_size);
+}
+
+CaretOverlay::~CaretOverlay()
+{
+        delete[] saved_top;
+        delete[] saved_bottom;
+        delete[] saved_left;
+        delete[] saved_right;
+        delete[] blank_strip;
+}
+
+void CaretOverlay::draw(Point cell_start, const uint8_t *cell_mask,
+                        Color background, Color foreground)
+{
+        if (visible &&
+            (position.x != cell_start.x || position.y != cell_start.y)) {
+                erase();
+        }
+
+        int outline_width = cell_width - 2 * CARET_INSET;
+        int outline_height = cell_height - 2 * CARET_INSET;
+        int left = CARET_INSET;
+        int right = cell_width - 1 - CARET_INSET;
+        int top = CARET_INSET;
+        int bottom = cell_height - 1 - CARET_INSET;
+
+        save_strip(cell_mask, left, top, outline_width, 1, saved_top);
+        save_strip(cell_mask, left, bottom, outline_width, 1, saved_bottom);
+        save_strip(cell_mask, left, top + 1, 1, outline_height - 2,
+                   saved_left);
+        save_strip(cell_mask, right, top + 1, 1, outline_height - 2,
+                   saved_right);
+        saved_background = background;
+        saved_foreground = foreground;
+        position = cell_start;
+        visible = true;
+
+        draw_outline(blank_strip, blank_strip, blank_strip, blank_strip,
+                     caret_color, caret_color);
+}
+
+void CaretOverlay::erase()
+{
+        if (!visible) {
+                return;
+        }
+        visible = false;
+        draw_outline(saved_top, saved_bottom, saved_left, saved_right,
+                     saved_background, saved_foreground);
+}
+
+/**
+ * Draws the four sides of the outline at the current position. Each side is
+ * sent as a separate bitmap, which gives us exact control over the covered
+ * pixels (the outlines drawn by `draw_rectangle` differ slightly between the
+ * platforms).
+ */
+void CaretOverlay::draw_outline(const uint8_t *top_mask,
+                                const uint8_t *bottom_mask,
+                                const uint8_t *left_mask,
+                                const uint8_t *right_mask, Color background,
+                                Color foreground)
+{
+        int outline_width = cell_width - 2 * CARET_INSET;
+        int outline_height = cell_height - 2 * CARET_INSET;
+        int left = position.x + CARET_INSET;
+        int right = position.x + cell_width - 1 - CARET_INSET;
+        int top = position.y + CARET_INSET;
+        int bottom = position.y + cell_height - 1 - CARET_INSET;
+
+        display->draw_bitmap({.x = left, .y = top}, outline_width, 1, top_mask,
+                             background, foreground);
+        display->draw_bitmap({.x = left, .y = bottom}, outline_width, 1,
+                             bottom_mask, background, foreground);
+        display->draw_bitmap({.x = left, .y = top + 1}, 1, outline_height - 2,
+                             left_mask, background, foreground);
+        display->draw_bitmap({.x = right, .y = top + 1}, 1, outline_height - 2,
+                             right_mask, background, foreground);
+}
+
+/**
+ * Copies a rectangular strip of the cell mask into a separate mask with rows
+ * padded to full bytes.
+ */
+void CaretOverlay::save_strip(const uint8_t *cell_mask, int x, int y,
+                              int width, int height, uint8_t *strip)
+{
+        int strip_stride = (width + 7) / 8;
+        memset(strip, 0, strip_stride * height);
+        if (cell_mask == nullptr) {
+                return;
+        }
+
+        int cell_stride = (cell_width + 7) / 8;
+        for (int row = 0; row < height; row++) {
+                for (int col = 0; col < width; col++) {
+                        int cx = x + col;
+                        int cy = y + row;
+                        if (cell_mask[cy * cell_stride + cx / 8] &
+                            (0x80 >> (cx % 8))) {
+                                strip[row * strip_stride + col / 8] |=
+                                    0x80 >> (col % 8);
+                        }
+                }
+        }
+}
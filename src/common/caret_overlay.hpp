@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+
+#include "platform/interface/display.hpp"
+
+/**
+ * Caret drawn as a 1px outline inset by 1px inside a grid cell. The overlay
+ * keeps a save-under copy of the pixels that the outline covers, so moving
+ * the caret away only restores those border pixels instead of re-rendering
+ * the whole cell.
+ *
+ * The display cannot be read back, so the saved pixels are taken from the
+ * appearance of the cell supplied by the game: a 1-bit-per-pixel mask (in the
+ * layout used by `draw_bitmap`) together with its two colors, or no mask at
+ * all for cells filled with a single color.
+ */
+class CaretOverlay
+{
+      public:
+        CaretOverlay(Display *display, int cell_width, int cell_height,
+                     Color caret_color);
+        ~CaretOverlay();
+
+        CaretOverlay(const CaretOverlay &) = delete;
+        CaretOverlay &operator=(const CaretOverlay &) = delete;
+
+        /**
+         * Draws the caret over the cell whose top left corner is at
+         * `cell_start`. If the caret is currently visible over a different
+         * cell, it is erased first. Calling this again for the same cell
+         * refreshes the saved pixels, which is needed after the cell under
+         * the caret has been redrawn.
+         *
+         * `cell_mask` can be null, in which case the cell is assumed to be
+         * filled with `background`.
+         */
+        void draw(Point cell_start, const uint8_t *cell_mask, Color background,
+                  Color foreground);
+
+        /**
+         * Restores the pixels covered by the caret. Does nothing if the caret
+         * isn't visible.
+         */
+        void erase();
+
+        bool is_visible() { return visible; }
+
+      private:
+        void save_strip(const uint8_t *cell_mask, int x, int y, int width,
+                        int height, uint8_t *strip);
+        void draw_outline(const uint8_t *top_mask, const uint8_t *bottom_mask,
+                          const uint8_t *left_mask, const uint8_t *right_mask,
+                          Color background, Color foreground);
+
+        Display *display;
+        int cell_width;
+        int cell_height;
+        Color caret_color;
+
+        bool visible;
+        Point position;
+        Color saved_background;
+        Color saved_foreground;
+        /**
+         * Save-under buffers for the four sides of the outline, stored as
+         * 1-bit-per-pixel masks. The vertical sides don't include the corner
+         * pixels, those are stored as a part of the horizontal ones.
+         */
+        uint8_t *saved_top;
+        uint8_t *saved_bottom;
+        uint8_t *saved_left;
+        uint8_t *saved_right;
+        /**
+         * Empty mask used for drawing the caret itself in a single color.
+         */
+        uint8_t *blank_strip;
+};
@@ -6,6 +6,8 @@
 #include "configuration.hpp"
 #include "maths_utils.hpp"
 #include "constants.hpp"
+#include "fixed_timestep.hpp"
+#include "latency_tracer.hpp"
 #include "logging.hpp"
 #include "user_interface.hpp"
 #include "platform/interface/controller.hpp"
@@ -259,7 +261,22 @@ void free_configuration(Configuration *config)
 {
         for (int i = 0; i < config->options_len; i++) {
                 ConfigurationOption *option = config->options[i];
-                free(option->available_values);
+                // The values are allocated using `new[]` in the
+                // `populate_*_option_values` functions, we need to delete
+                // them through the pointer of the correct type.
+                switch (option->type) {
+                case INT:
+                        delete[] static_cast<int *>(option->available_values);
+                        break;
+                case STRING:
+                        delete[] static_cast<const char **>(
+                            option->available_values);
+                        break;
+                case COLOR:
+                        delete[] static_cast<Color *>(
+                            option->available_values);
+                        break;
+                }
                 delete config->options[i];
         }
         delete config;
@@ -278,96 +295,156 @@ int get_config_option_string_value_index(ConfigurationOption *option,
         return -1;
 }
 
+/**
+ * Loop of the configuration screen driven by the `FixedTimestepScheduler`.
+ * Each update handles a single input and records what it changed in the
+ * diff, the change is then drawn by `render`.
+ */
+class ConfigurationSession : public FixedTimestepLoop
+{
+      public:
+        ConfigurationSession(Platform *p, Configuration *config,
+                             UserInterfaceCustomization *customization,
+                             bool allow_exit);
+        ~ConfigurationSession();
+
+        ConfigurationSession(const ConfigurationSession &) = delete;
+        ConfigurationSession &operator=(const ConfigurationSession &) = delete;
+
+        bool update() override;
+        void render() override;
+
+        std::optional<UserAction> get_interrupt() { return interrupt; }
+
+      private:
+        Platform *p;
+        Configuration *config;
+        UserInterfaceCustomization *customization;
+        bool allow_exit;
+        /**
+         * The diff only describes a single change, so no more input is
+         * handled until the pending change has been drawn.
+         */
+        ConfigurationDiff *diff;
+        bool diff_pending;
+        /**
+         * Set if something was drawn since the display was last refreshed.
+         */
+        bool refresh_pending;
+        std::optional<UserAction> interrupt;
+};
+
+ConfigurationSession::ConfigurationSession(
+    Platform *p, Configuration *config,
+    UserInterfaceCustomization *customization, bool allow_exit)
+    : p(p), config(config), customization(customization),
+      allow_exit(allow_exit), diff(empty_diff()), diff_pending(false),
+      refresh_pending(true), interrupt(std::nullopt)
+{
+}
+
+ConfigurationSession::~ConfigurationSession() { free(diff); }
+
+bool ConfigurationSession::update()
+{
+        if (diff_pending) {
+                return true;
+        }
+        bool confirmation_bar_selected =
+            config->curr_selected_option == config->options_len;
+
+        Action act;
+        if (action_input_registered(p->action_controllers, &act)) {
+                /* To make the UI more intuitive, we also allow users to
+                cycle configuration options and confirm final selection
+                using the green button. This change was inspired by
+                initial play testing by Tomek. */
+                if (act == Action::GREEN) {
+                        if (confirmation_bar_selected) {
+                                return false;
+                        }
+                        increment_current_option_value(config, diff);
+                        diff_pending = true;
+                        return true;
+                }
+                if (act == Action::BLUE && allow_exit) {
+                        interrupt = UserAction::Exit;
+                        return false;
+                }
+                if (act == Action::YELLOW) {
+                        interrupt = UserAction::ShowHelp;
+                        return false;
+                }
+        }
+
+        Direction dir;
+        if (!directional_input_registered(p->directional_controllers, &dir)) {
+                return true;
+        }
+        /* When the user selects the last config bar, i.e. the 'confirmation
+           cell' pressing right on it confirms the selected config and
+           breaks out of the config collection loop. */
+        if (confirmation_bar_selected) {
+                if (dir == RIGHT) {
+                        return false;
+                }
+                if (dir == LEFT) {
+                        return true;
+                }
+        }
+
+        switch (dir) {
+        case DOWN:
+                switch_edited_config_option_down(config, diff);
+                break;
+        case UP:
+                switch_edited_config_option_up(config, diff);
+                break;
+        case LEFT:
+                decrement_current_option_value(config, diff);
+                break;
+        case RIGHT:
+                increment_current_option_value(config, diff);
+                break;
+        }
+        diff_pending = true;
+        return true;
+}
+
+void ConfigurationSession::render()
+{
+        if (diff_pending) {
+                render_config_menu(p->display, config, diff, true,
+                                   customization);
+                // We get a fresh, empty diff after each change to avoid
+                // option value text rerendering when they are not modified.
+                free(diff);
+                diff = empty_diff();
+                diff_pending = false;
+                refresh_pending = true;
+        }
+        if (refresh_pending) {
+                p->display->refresh();
+                refresh_pending = false;
+        }
+}
+
 std::optional<UserAction>
 collect_configuration(Platform *p, Configuration *config,
                       UserInterfaceCustomization *customization,
                       bool allow_exit)
 {
+        const char *previous_screen = trace_latency_screen("Configuration");
         ConfigurationDiff *diff = empty_diff();
         render_config_menu(p->display, config, diff, false, customization);
         free(diff);
-        while (true) {
-                Action act;
-                Direction dir;
-                // We get a fresh, empty diff during each iteration to avoid
-                // option value text rerendering when they are not modified.
-                ConfigurationDiff *diff = empty_diff();
-                bool confirmation_bar_selected =
-                    config->curr_selected_option == config->options_len;
-
-                // Abstract out the repeatable delay functionality.
-                auto move_registered_delay = [&] {
-                        p->delay_provider->delay_ms(MOVE_REGISTERED_DELAY);
-                };
-
-                if (action_input_registered(p->action_controllers, &act)) {
-                        /* To make the UI more intuitive, we also allow users to
-                        cycle configuration options and confirm final selection
-                        using the green button. This change was inspired by
-                        initial play testing by Tomek. */
-                        if (act == Action::GREEN) {
-                                if (confirmation_bar_selected) {
-                                        move_registered_delay();
-                                        break;
-                                } else {
-                                        increment_current_option_value(config,
-                                                                       diff);
-                                        render_config_menu(p->display, config,
-                                                           diff, true,
-                                                           customization);
-                                        free(diff);
-                                        continue;
-                                }
-                        }
-                        if (act == Action::BLUE && allow_exit) {
-                                move_registered_delay();
-                                return UserAction::Exit;
-                        }
-                        if (act == Action::YELLOW) {
-                                move_registered_delay();
-                                return UserAction::ShowHelp;
-                        }
-                }
-                if (directional_input_registered(p->directional_controllers,
-                                                 &dir)) {
-                        /* When the user selects the last config bar,
-                           i.e. the 'confirmation cell' pressing right
-                           on it confirms the selected config and
-                           breaks out of the config collection loop. */
-                        if (confirmation_bar_selected) {
-                                p->delay_provider->delay_ms(
-                                    MOVE_REGISTERED_DELAY);
-                                if (dir == RIGHT) {
-                                        break;
-                                }
-                                if (dir == LEFT) {
-                                        continue;
-                                }
-                        }
 
-                        switch (dir) {
-                        case DOWN:
-                                switch_edited_config_option_down(config, diff);
-                                break;
-                        case UP:
-                                switch_edited_config_option_up(config, diff);
-                                break;
-                        case LEFT:
-                                decrement_current_option_value(config, diff);
-                                break;
-                        case RIGHT:
-                                increment_current_option_value(config, diff);
-                                break;
-                        }
+        ConfigurationSession session(p, config, customization, allow_exit);
+        FixedTimestepScheduler scheduler(p->delay_provider,
+                                         INPUT_POLLING_DELAY,
+                                         INPUT_LOOP_MAX_UPDATES_PER_FRAME);
+        scheduler.run(&session);
 
-                        render_config_menu(p->display, config, diff, true,
-                                           customization);
-
-                        p->delay_provider->delay_ms(MOVE_REGISTERED_DELAY);
-                }
-                p->delay_provider->delay_ms(INPUT_POLLING_DELAY);
-                p->display->refresh();
-                free(diff);
-        }
-        return std::nullopt;
+        trace_latency_screen(previous_screen);
+        return session.get_interrupt();
 }
@@ -26,14 +26,26 @@
 #define DISPLAY_CORNER_RADIUS 40
 
 /* Constants below control time intervals between input polling */
-#define INPUT_POLLING_DELAY 50
+#define INPUT_POLLING_DELAY 20
+/* The loops that only react to the input (menus, Minesweeper, Sudoku and
+ * the waits for input between the games) run on the
+ * `FixedTimestepScheduler` with the polling delay as their timestep. The
+ * inputs stay queued in the controllers while a frame is drawn, so there is
+ * nothing to catch up on and each frame runs a single update. */
+#define INPUT_LOOP_MAX_UPDATES_PER_FRAME 1
+
+/* Constants below control the debouncing and the key repeat of the inputs,
+ * see `KeyRepeatPlatform`. */
+#define INPUT_DEBOUNCE_MS 20
 
 #ifdef EMULATOR
 // On the emulator we are using the keyboard which is faster than the keypad
 // buttons on the Arduino input shield, because of this we can afford a shorter
-// timeout to make the experience more snappy.
-#define MOVE_REGISTERED_DELAY 100
+// repeat interval to make the experience more snappy.
+#define KEY_REPEAT_INITIAL_DELAY_MS 250
+#define KEY_REPEAT_INTERVAL_MS 100
 #endif
 #ifndef EMULATOR
-#define MOVE_REGISTERED_DELAY 150
+#define KEY_REPEAT_INITIAL_DELAY_MS 300
+#define KEY_REPEAT_INTERVAL_MS 150
 #endif
@@ -0,0 +1,56 @@
+#include "fixed_timestep.hpp"
+#include "logging.hpp"
+
+#define TAG "fixed_timestep"
+
+FixedTimestepScheduler::FixedTimestepScheduler(DelayProvider *clock,
+                                               int timestep_ms,
+                                               int max_updates_per_frame)
+    : clock(clock), timestep_ms(timestep_ms),
+      max_updates_per_frame(max_updates_per_frame)
+{
+        stats = {.updates = 0, .frames = 0, .dropped_updates = 0};
+}
+
+void FixedTimestepScheduler::run(FixedTimestepLoop *loop)
+{
+        unsigned long timestep = timestep_ms;
+        unsigned long previous_time = clock->get_time_ms();
+        unsigned long accumulated_ms = timestep;
+        bool running = true;
+        while (running) {
+                // The clock is monotonic and the subtraction is safe even
+                // when the unsigned millisecond counter wraps around.
+                unsigned long now = clock->get_time_ms();
+                accumulated_ms += now - previous_time;
+                previous_time = now;
+
+                int updates = 0;
+                while (running && accumulated_ms >= timestep &&
+                       updates < max_updates_per_frame) {
+                        running = loop->update();
+                        accumulated_ms -= timestep;
+                        updates++;
+                }
+                stats.updates += updates;
+
+                if (running && accumulated_ms >= timestep) {
+                        int dropped = accumulated_ms / timestep;
+                        LOG_DEBUG(TAG, "Fell behind, dropping %d updates.",
+                                  dropped);
+                        stats.dropped_updates += dropped;
+                        accumulated_ms %= timestep;
+                }
+
+                if (updates > 0) {
+                        loop->render();
+                        stats.frames++;
+                }
+
+                if (running) {
+                        clock->delay_ms(timestep - accumulated_ms);
+                }
+        }
+        LOG_DEBUG(TAG, "Loop finished after %lu updates and %lu frames.",
+                  stats.updates, stats.frames);
+}
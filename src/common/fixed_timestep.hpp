@@ -0,0 +1,73 @@
+#pragma once
+#include "platform/interface/delay.hpp"
+
+/**
+ * Game logic driven by the `FixedTimestepScheduler`. Instead of sleeping
+ * between iterations of its own loop, a game implements the two callbacks
+ * below and lets the scheduler decide when to call them.
+ */
+class FixedTimestepLoop
+{
+      public:
+        virtual ~FixedTimestepLoop() = default;
+
+        /**
+         * Advances the game by a single timestep. This is where the input is
+         * polled and the game state is updated. Each call corresponds to
+         * exactly the same amount of time, so logic counting the updates is
+         * paced in the same way no matter how long rendering takes.
+         *
+         * Returns false once the loop should stop.
+         */
+        virtual bool update() = 0;
+        /**
+         * Draws the changes of the game state made by the updates since the
+         * previous call. It is called at most once per frame, after all
+         * updates that were due in that frame.
+         */
+        virtual void render() = 0;
+};
+
+typedef struct FixedTimestepStats {
+        unsigned long updates;
+        unsigned long frames;
+        /**
+         * Updates that were skipped because the loop fell too far behind the
+         * clock, see `max_updates_per_frame`.
+         */
+        unsigned long dropped_updates;
+} FixedTimestepStats;
+
+/**
+ * Runs a `FixedTimestepLoop` using the fixed timestep scheme: the time that
+ * has passed on the clock is accumulated and consumed in steps of
+ * `timestep_ms`, each step being a single call to `update`. Once all due
+ * updates are done, the frame is rendered and the scheduler sleeps until the
+ * next update is due.
+ *
+ * If rendering takes longer than a timestep, the following frame runs the
+ * missed updates back to back to catch up with the clock. The number of
+ * updates per frame is capped at `max_updates_per_frame`; if the loop falls
+ * behind even further, the remaining backlog is dropped, which slows the game
+ * down instead of making it unresponsive.
+ */
+class FixedTimestepScheduler
+{
+      public:
+        FixedTimestepScheduler(DelayProvider *clock, int timestep_ms,
+                               int max_updates_per_frame);
+
+        /**
+         * Calls the loop callbacks until `update` returns false. The first
+         * update happens immediately.
+         */
+        void run(FixedTimestepLoop *loop);
+
+        FixedTimestepStats get_stats() { return stats; }
+
+      private:
+        DelayProvider *clock;
+        int timestep_ms;
+        int max_updates_per_frame;
+        FixedTimestepStats stats;
+};
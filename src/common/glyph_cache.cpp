@@ -0,0 +1,85 @@
+#include <cstring>
+
+#include "glyph_cache.hpp"
+#include "constants.hpp"
+#include "logging.hpp"
+
+#define TAG "glyph_cache"
+
+GlyphCache::GlyphCache(Display *display, FontSize font_size,
+                       const char *characters)
+{
+        characters_num = strlen(characters);
+        this->characters = new char[characters_num + 1];
+        strcpy(this->characters, characters);
+
+        if (font_size == Size24) {
+                glyph_width = HEADING_FONT_WIDTH;
+                glyph_height = HEADING_FONT_SIZE;
+        } else {
+                glyph_width = FONT_WIDTH;
+                glyph_height = FONT_SIZE;
+        }
+        glyph_stride = (glyph_width + 7) / 8;
+
+        int glyph_size = glyph_stride * glyph_height;
+        glyphs = new uint8_t[characters_num * glyph_size];
+
+        char buffer[2] = {0, 0};
+        for (int i = 0; i < characters_num; i++) {
+                buffer[0] = characters[i];
+                display->rasterize_string(buffer, font_size,
+                                          glyphs + i * glyph_size, glyph_width,
+                                          glyph_height);
+        }
+        LOG_DEBUG(TAG, "Cached %d glyphs using %d bytes", characters_num,
+                  characters_num * glyph_size);
+}
+
+GlyphCache::~GlyphCache()
+{
+        delete[] characters;
+        delete[] glyphs;
+}
+
+int GlyphCache::mask_size(int length)
+{
+        return ((length * glyph_width + 7) / 8) * glyph_height;
+}
+
+void GlyphCache::compose(const char *string, int length, uint8_t *mask)
+{
+        int mask_stride = (length * glyph_width + 7) / 8;
+        memset(mask, 0, mask_size(length));
+
+        int string_length = strlen(string);
+        for (int i = 0; i < length && i < string_length; i++) {
+                int idx = glyph_index(string[i]);
+                if (idx < 0) {
+                        continue;
+                }
+                const uint8_t *glyph =
+                    glyphs + idx * glyph_stride * glyph_height;
+                int x_offset = i * glyph_width;
+                for (int row = 0; row < glyph_height; row++) {
+                        const uint8_t *glyph_row = glyph + row * glyph_stride;
+                        uint8_t *mask_row = mask + row * mask_stride;
+                        for (int col = 0; col < glyph_width; col++) {
+                                if (glyph_row[col / 8] & (0x80 >> (col % 8))) {
+                                        int x = x_offset + col;
+                                        mask_row[x / 8] |= 0x80 >> (x % 8);
+                                }
+                        }
+                }
+        }
+}
+
+int GlyphCache::glyph_index(char c)
+{
+        for (int i = 0; i < characters_num; i++) {
+                if (characters[i] == c) {
+                        return i;
+                }
+        }
+        return -1;
+}
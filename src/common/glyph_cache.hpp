@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+
+#include "platform/interface/display.hpp"
+
+/**
+ * Caches 1-bit-per-pixel masks of a small set of characters so that strings
+ * composed of those characters can be assembled in memory and sent to the
+ * display using a single `draw_bitmap` call.
+ *
+ * Rasterizing text through the display is slow (especially on the LCD where
+ * each glyph pixel is written separately), so the glyphs are rendered only
+ * once when the cache is created.
+ */
+class GlyphCache
+{
+      public:
+        /**
+         * Rasterizes all `characters` (a null-terminated string) using the
+         * given font size.
+         */
+        GlyphCache(Display *display, FontSize font_size,
+                   const char *characters);
+        ~GlyphCache();
+
+        int get_glyph_width() { return glyph_width; }
+        int get_glyph_height() { return glyph_height; }
+
+        /**
+         * Returns the number of bytes required to store the mask of a string
+         * that is `length` characters long.
+         */
+        int mask_size(int length);
+
+        /**
+         * Assembles the mask of the first `length` characters of the string
+         * out of the cached glyphs. If the string is shorter than `length`, it
+         * is padded with blank space. Characters that are not present in the
+         * cache are also rendered as blank space.
+         */
+        void compose(const char *string, int length, uint8_t *mask);
+
+      private:
+        int glyph_index(char c);
+
+        char *characters;
+        int characters_num;
+        int glyph_width;
+        int glyph_height;
+        int glyph_stride;
+        uint8_t *glyphs;
+};
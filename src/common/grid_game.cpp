@@ -0,0 +1,38 @@
+#include "grid_game.hpp"
+#include "logging.hpp"
+
+#define TAG "grid_game"
+
+CellGridDimensions *calculate_cell_grid_dimensions(
+    int display_width, int display_height, int display_rounded_corner_radius,
+    int cell_width, int cell_height)
+{
+        // Bind input params to short names for improved readability.
+        int w = display_width;
+        int h = display_height;
+        int r = display_rounded_corner_radius;
+
+        int usable_width = w - r;
+        int usable_height = h - r;
+
+        int max_cols = usable_width / cell_width;
+        int max_rows = usable_height / cell_height;
+
+        int actual_width = max_cols * cell_width;
+        int actual_height = max_rows * cell_height;
+
+        // We calculate centering margins
+        int left_horizontal_margin = (w - actual_width) / 2;
+        int top_vertical_margin = (h - actual_height) / 2;
+
+        LOG_DEBUG(TAG,
+                  "Calculated grid dimensions: %d rows, %d cols, "
+                  "left margin: %d, top margin: %d, actual width: %d, "
+                  "actual height: %d",
+                  max_rows, max_cols, left_horizontal_margin,
+                  top_vertical_margin, actual_width, actual_height);
+
+        return new CellGridDimensions(max_rows, max_cols, top_vertical_margin,
+                                      left_horizontal_margin, actual_width,
+                                      actual_height, cell_width, cell_height);
+}
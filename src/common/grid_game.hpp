@@ -0,0 +1,228 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+#include "caret_overlay.hpp"
+#include "point.hpp"
+#include "platform/interface/display.hpp"
+
+/**
+ * Stores all information required for rendering a grid of equally-sized
+ * cells centered on the display. Shared by all games that are played on a
+ * grid of cells (Minesweeper, Game of Life, ...).
+ */
+typedef struct CellGridDimensions {
+        int rows;
+        int cols;
+        int top_vertical_margin;
+        int left_horizontal_margin;
+        int actual_width;
+        int actual_height;
+        int cell_width;
+        int cell_height;
+
+        CellGridDimensions(int r, int c, int tvm, int lhm, int aw, int ah,
+                           int cw, int ch)
+            : rows(r), cols(c), top_vertical_margin(tvm),
+              left_horizontal_margin(lhm), actual_width(aw), actual_height(ah),
+              cell_width(cw), cell_height(ch)
+        {
+        }
+
+        /**
+         * Returns the position of the top left pixel of the cell.
+         */
+        Point cell_start(int x, int y)
+        {
+                return {.x = left_horizontal_margin + x * cell_width,
+                        .y = top_vertical_margin + y * cell_height};
+        }
+} CellGridDimensions;
+
+/**
+ * Fits the largest grid of `cell_width` x `cell_height` cells into the part of
+ * the display that isn't cut off by its rounded corners and centers it.
+ */
+CellGridDimensions *calculate_cell_grid_dimensions(
+    int display_width, int display_height, int display_rounded_corner_radius,
+    int cell_width, int cell_height);
+
+/**
+ * Describes how a cell looks like on the display: a 1-bit-per-pixel mask in
+ * the `draw_bitmap` layout expanded using two colors. Cells filled with a
+ * single color can leave the mask null.
+ */
+typedef struct CellAppearance {
+        const uint8_t *mask;
+        Color background;
+        Color foreground;
+} CellAppearance;
+
+/**
+ * Engine for games played on a grid of cells. It owns the cell storage, keeps
+ * track of the cells that changed since they were last drawn, renders them in
+ * batches and handles the caret. The games only need to implement their rules
+ * on top of the cells and supply a renderer that turns cells into pixels.
+ *
+ * The storage is sized at compile time to hold up to `MAX_CELLS` cells, so
+ * the engine doesn't allocate. If the dimensions don't fit, the number of rows
+ * is reduced.
+ *
+ * `Renderer` needs to provide the following methods:
+ *
+ * - `CellAppearance get_appearance(const Cell &cell)` returning the current
+ *   look of a cell, used for drawing the caret on top of it,
+ * - `void draw_run(Display *display, Point start, const Cell *cells,
+ *   int length)` drawing `length` adjacent cells in the same row, starting at
+ *   the pixel `start`.
+ *
+ * Dirty cells are rendered in the row-major order and adjacent dirty cells in
+ * the same row are passed to the renderer as a single run. This lets the
+ * renderer send them to the display in one write and keeps the display
+ * address window moving forward.
+ */
+template <typename Cell, typename Renderer, int MAX_CELLS> class GridGame
+{
+      public:
+        GridGame(Display *display, CellGridDimensions *dimensions,
+                 Renderer *renderer, Color caret_color)
+            : display(display), dimensions(dimensions), renderer(renderer),
+              caret(display, dimensions->cell_width, dimensions->cell_height,
+                    caret_color),
+              caret_position({.x = 0, .y = 0}), caret_enabled(false)
+        {
+                if (dimensions->rows * dimensions->cols > MAX_CELLS) {
+                        int rows = MAX_CELLS / dimensions->cols;
+                        int removed_height =
+                            (dimensions->rows - rows) * dimensions->cell_height;
+                        dimensions->rows = rows;
+                        dimensions->actual_height -= removed_height;
+                        dimensions->top_vertical_margin += removed_height / 2;
+                }
+                memset(dirty, 0, sizeof(dirty));
+        }
+
+        GridGame(const GridGame &) = delete;
+        GridGame &operator=(const GridGame &) = delete;
+
+        int rows() { return dimensions->rows; }
+        int cols() { return dimensions->cols; }
+        int size() { return dimensions->rows * dimensions->cols; }
+        int index(int x, int y) { return y * dimensions->cols + x; }
+
+        /**
+         * Raw access to the row-major cell storage for the game rules. Cells
+         * modified this way need to be marked dirty explicitly.
+         */
+        Cell *get_cells() { return cells; }
+
+        Cell get(int x, int y) { return cells[index(x, y)]; }
+        void set(int x, int y, Cell cell)
+        {
+                int idx = index(x, y);
+                if (!(cells[idx] == cell)) {
+                        cells[idx] = cell;
+                        mark_dirty(idx);
+                }
+        }
+
+        void mark_dirty(int idx) { dirty[idx / 8] |= 1 << (idx % 8); }
+        void mark_all_dirty() { memset(dirty, 0xFF, sizeof(dirty)); }
+
+        /**
+         * Draws all dirty cells. If the cell under the caret was redrawn, the
+         * caret is drawn on top of it again.
+         */
+        void render()
+        {
+                int total = size();
+                int cols = dimensions->cols;
+                bool caret_dirty =
+                    caret_enabled &&
+                    is_dirty(index(caret_position.x, caret_position.y));
+
+                int idx = 0;
+                while (idx < total) {
+                        // Skip whole clean bytes of the bitset at once.
+                        if (idx % 8 == 0 && dirty[idx / 8] == 0) {
+                                idx += 8;
+                                continue;
+                        }
+                        if (!is_dirty(idx)) {
+                                idx++;
+                                continue;
+                        }
+                        int run_start = idx;
+                        int row_end = (idx / cols + 1) * cols;
+                        while (idx < total && idx < row_end && is_dirty(idx)) {
+                                clear_dirty(idx);
+                                idx++;
+                        }
+                        renderer->draw_run(display,
+                                           dimensions->cell_start(
+                                               run_start % cols,
+                                               run_start / cols),
+                                           cells + run_start, idx - run_start);
+                }
+
+                if (caret_dirty) {
+                        draw_caret();
+                }
+        }
+
+        Point get_caret() { return caret_position; }
+
+        /**
+         * Moves the caret to the given cell and shows it if it was hidden.
+         */
+        void set_caret(Point position)
+        {
+                caret_position = position;
+                caret_enabled = true;
+                draw_caret();
+        }
+
+        void move_caret(Direction dir, bool wrap_around)
+        {
+                if (wrap_around) {
+                        translate_toroidal_array(&caret_position, dir,
+                                                 dimensions->rows,
+                                                 dimensions->cols);
+                } else {
+                        translate_within_bounds(&caret_position, dir,
+                                                dimensions->rows,
+                                                dimensions->cols);
+                }
+                set_caret(caret_position);
+        }
+
+        void hide_caret()
+        {
+                caret.erase();
+                caret_enabled = false;
+        }
+
+      private:
+        bool is_dirty(int idx) { return dirty[idx / 8] & (1 << (idx % 8)); }
+        void clear_dirty(int idx) { dirty[idx / 8] &= ~(1 << (idx % 8)); }
+
+        void draw_caret()
+        {
+                int idx = index(caret_position.x, caret_position.y);
+                CellAppearance appearance = renderer->get_appearance(cells[idx]);
+                caret.draw(dimensions->cell_start(caret_position.x,
+                                                  caret_position.y),
+                           appearance.mask, appearance.background,
+                           appearance.foreground);
+        }
+
+        Display *display;
+        CellGridDimensions *dimensions;
+        Renderer *renderer;
+        CaretOverlay caret;
+        Point caret_position;
+        bool caret_enabled;
+
+        Cell cells[MAX_CELLS] = {};
+        uint8_t dirty[(MAX_CELLS + 7) / 8];
+};
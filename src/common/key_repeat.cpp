@@ -0,0 +1,247 @@
+#include "key_repeat.hpp"
+#include "constants.hpp"
+
+#define BUTTON_EVENT_QUEUE_MASK (BUTTON_EVENT_QUEUE_CAPACITY - 1)
+
+static_assert((BUTTON_EVENT_QUEUE_CAPACITY & BUTTON_EVENT_QUEUE_MASK) == 0,
+              "The button event queue capacity needs to be a power of two.");
+
+ButtonStateMachine::ButtonStateMachine()
+    : raw_down(false), raw_change_time(0), down(false), debounce_until(0),
+      next_repeat_time(0)
+{
+}
+
+void ButtonStateMachine::set_raw_state(bool down, unsigned long timestamp)
+{
+        if (raw_down == down) {
+                return;
+        }
+        raw_down = down;
+        raw_change_time = timestamp;
+}
+
+bool ButtonStateMachine::step(unsigned long now, const KeyRepeatConfig *config,
+                              ButtonEventType *type, unsigned long *timestamp)
+{
+        if (raw_down != down) {
+                // A change that happened during the debounce window takes
+                // effect once the window is over.
+                unsigned long change_time = raw_change_time > debounce_until
+                                                ? raw_change_time
+                                                : debounce_until;
+                if (now < change_time) {
+                        return false;
+                }
+                down = raw_down;
+                debounce_until = change_time + config->debounce_ms;
+                next_repeat_time = change_time + config->initial_delay_ms;
+                *type = down ? Pressed : Released;
+                *timestamp = change_time;
+                return true;
+        }
+
+        if (!down || config->repeat_interval_ms == 0 ||
+            now < next_repeat_time) {
+                return false;
+        }
+        *type = Held;
+        *timestamp = next_repeat_time;
+        next_repeat_time += config->repeat_interval_ms;
+        // If the game didn't poll for a while, the missed repeats are skipped
+        // instead of being delivered all at once.
+        if (next_repeat_time <= now) {
+                next_repeat_time = now + config->repeat_interval_ms;
+        }
+        return true;
+}
+
+KeyRepeatEngine::KeyRepeatEngine(DelayProvider *clock, KeyRepeatConfig config,
+                                 int sources)
+    : clock(clock), config(config), magnitude(DIRECTION_MAGNITUDE_MAX),
+      source_states(sources, 0), events_head(0), events_count(0),
+      dropped_events(0)
+{
+}
+
+void KeyRepeatEngine::feed(int source, InputEvent event)
+{
+        if (event.input >= 4 || source >= (int)source_states.size()) {
+                return;
+        }
+        unsigned long timestamp =
+            event.timestamp ? event.timestamp : clock->get_time_ms();
+
+        // Changes that became due before this event are applied first so
+        // that the events are generated in the order in which they happened.
+        advance(event.input, timestamp);
+
+        uint8_t bit = 1 << event.input;
+        if (event.pressed) {
+                source_states[source] |= bit;
+        } else {
+                source_states[source] &= ~bit;
+        }
+        bool down = false;
+        for (uint8_t state : source_states) {
+                down |= state & bit;
+        }
+        buttons[event.input].set_raw_state(down, timestamp);
+        advance(event.input, timestamp);
+}
+
+void KeyRepeatEngine::update()
+{
+        unsigned long now = clock->get_time_ms();
+        for (int button = 0; button < 4; button++) {
+                advance(button, now);
+        }
+}
+
+bool KeyRepeatEngine::poll_event(ButtonEvent *event)
+{
+        if (events_count == 0) {
+                return false;
+        }
+        *event = events[events_head];
+        events_head = (events_head + 1) & BUTTON_EVENT_QUEUE_MASK;
+        events_count--;
+        return true;
+}
+
+bool KeyRepeatEngine::poll(uint8_t *input)
+{
+        ButtonEvent event;
+        while (poll_event(&event)) {
+                if (event.type != Released) {
+                        *input = event.input;
+                        return true;
+                }
+        }
+        return false;
+}
+
+void KeyRepeatEngine::advance(int button, unsigned long now)
+{
+        KeyRepeatConfig scaled = config;
+        scaled.repeat_interval_ms = config.repeat_interval_ms *
+                                    (2 * DIRECTION_MAGNITUDE_MAX - magnitude) /
+                                    DIRECTION_MAGNITUDE_MAX;
+
+        ButtonEvent event = {
+            .type = Pressed, .input = (uint8_t)button, .timestamp = 0};
+        while (buttons[button].step(now, &scaled, &event.type,
+                                    &event.timestamp)) {
+                if (events_count == BUTTON_EVENT_QUEUE_CAPACITY) {
+                        dropped_events++;
+                        continue;
+                }
+                int tail =
+                    (events_head + events_count) & BUTTON_EVENT_QUEUE_MASK;
+                events[tail] = event;
+                events_count++;
+        }
+}
+
+KeyRepeatDirectionalController::KeyRepeatDirectionalController(
+    std::vector<DirectionalController *> *source, DelayProvider *clock,
+    KeyRepeatConfig config)
+    : source(source), engine(clock, config, source->size()), active_source(0)
+{
+}
+
+bool KeyRepeatDirectionalController::poll_for_input(Direction *input)
+{
+        InputEvent event;
+        for (size_t i = 0; i < source->size(); i++) {
+                while ((*source)[i]->poll_event(&event)) {
+                        if (event.pressed) {
+                                active_source = i;
+                        }
+                        engine.feed(i, event);
+                }
+        }
+        if (active_source < source->size()) {
+                engine.set_magnitude(
+                    (*source)[active_source]->get_magnitude());
+        }
+        engine.update();
+
+        uint8_t button;
+        if (!engine.poll(&button)) {
+                return false;
+        }
+        *input = (Direction)button;
+        return true;
+}
+
+KeyRepeatActionController::KeyRepeatActionController(
+    std::vector<ActionController *> *source, DelayProvider *clock,
+    KeyRepeatConfig config)
+    : source(source), engine(clock, config, source->size())
+{
+}
+
+bool KeyRepeatActionController::poll_for_input(Action *input)
+{
+        InputEvent event;
+        for (size_t i = 0; i < source->size(); i++) {
+                while ((*source)[i]->poll_event(&event)) {
+                        engine.feed(i, event);
+                }
+        }
+        engine.update();
+
+        uint8_t button;
+        if (!engine.poll(&button)) {
+                return false;
+        }
+        *input = (Action)button;
+        return true;
+}
+
+KeyRepeatPlatform::KeyRepeatPlatform(Platform *platform)
+{
+        KeyRepeatConfig directional_config = {
+            .debounce_ms = INPUT_DEBOUNCE_MS,
+            .initial_delay_ms = KEY_REPEAT_INITIAL_DELAY_MS,
+            .repeat_interval_ms = KEY_REPEAT_INTERVAL_MS};
+        KeyRepeatConfig action_config = {
+            .debounce_ms = INPUT_DEBOUNCE_MS,
+            .initial_delay_ms = KEY_REPEAT_INITIAL_DELAY_MS,
+            .repeat_interval_ms = 0};
+
+        directional_controller = new KeyRepeatDirectionalController(
+            platform->directional_controllers, platform->delay_provider,
+            directional_config);
+        action_controller = new KeyRepeatActionController(
+            platform->action_controllers, platform->delay_provider,
+            action_config);
+        directional_controllers = {directional_controller};
+        action_controllers = {action_controller};
+        key_repeat_platform = {
+            .display = platform->display,
+            .directional_controllers = &directional_controllers,
+            .action_controllers = &action_controllers,
+            .delay_provider = platform->delay_provider,
+            .persistent_storage = platform->persistent_storage,
+            .record_store = platform->record_store,
+            .settings_cache = platform->settings_cache,
+            .high_scores = platform->high_scores};
+}
+
+KeyRepeatPlatform::~KeyRepeatPlatform()
+{
+        delete directional_controller;
+        delete action_controller;
+}
+
+void KeyRepeatPlatform::set_directional_config(KeyRepeatConfig config)
+{
+        directional_controller->get_engine()->set_config(config);
+}
+
+void KeyRepeatPlatform::set_action_config(KeyRepeatConfig config)
+{
+        action_controller->get_engine()->set_config(config);
+}
@@ -0,0 +1,217 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "platform/interface/controller.hpp"
+#include "platform/interface/delay.hpp"
+#include "platform/interface/input_event_queue.hpp"
+#include "platform/interface/platform.hpp"
+
+/**
+ * Maximum number of button events that can be waiting to be consumed by the
+ * game, it needs to be a power of two.
+ */
+#define BUTTON_EVENT_QUEUE_CAPACITY 16
+
+typedef struct KeyRepeatConfig {
+        /**
+         * After the state of a button changes, any further changes within
+         * this window are considered to be contact bounce. A change that is
+         * still there once the window is over gets applied then.
+         */
+        unsigned long debounce_ms;
+        /**
+         * How long a button needs to be held before it starts repeating.
+         */
+        unsigned long initial_delay_ms;
+        /**
+         * Interval between the repeats of a held button. Zero disables the
+         * key repeat, the button is then only reported when pressed.
+         */
+        unsigned long repeat_interval_ms;
+} KeyRepeatConfig;
+
+typedef enum ButtonEventType { Pressed, Held, Released } ButtonEventType;
+
+typedef struct ButtonEvent {
+        ButtonEventType type;
+        /**
+         * Value of the `Direction` or `Action` enum.
+         */
+        uint8_t input;
+        /**
+         * Time at which the event has happened, for key repeats this is the
+         * time at which the repeat was due.
+         */
+        unsigned long timestamp;
+} ButtonEvent;
+
+/**
+ * Debounces a single button and generates its key repeats.
+ *
+ * The debouncing is eager: a change of the raw state is accepted right away
+ * unless the previous change happened less than `debounce_ms` ago. This way
+ * debouncing doesn't add any latency to a press while the bouncing contacts
+ * of the buttons still can't produce phantom presses.
+ */
+class ButtonStateMachine
+{
+      public:
+        ButtonStateMachine();
+
+        /**
+         * Records the raw state of the button as reported by the controller.
+         */
+        void set_raw_state(bool down, unsigned long timestamp);
+        /**
+         * Advances the state machine to the time `now`. Returns true if an
+         * event was generated, at most one event is generated per call so
+         * this needs to be called until it returns false.
+         */
+        bool step(unsigned long now, const KeyRepeatConfig *config,
+                  ButtonEventType *type, unsigned long *timestamp);
+
+      private:
+        bool raw_down;
+        unsigned long raw_change_time;
+        bool down;
+        /**
+         * Time until which the changes of the raw state are not accepted.
+         */
+        unsigned long debounce_until;
+        unsigned long next_repeat_time;
+};
+
+/**
+ * Turns the press and release events of a set of controllers into debounced
+ * press, hold and release events of the four buttons they map to.
+ */
+class KeyRepeatEngine
+{
+      public:
+        KeyRepeatEngine(DelayProvider *clock, KeyRepeatConfig config,
+                        int sources);
+
+        /**
+         * Feeds an event coming from the controller with index `source`.
+         * Events without a timestamp are assumed to have happened now.
+         */
+        void feed(int source, InputEvent event);
+        /**
+         * Generates the events that became due since the last call, i.e.
+         * the delayed debounced changes and the key repeats.
+         */
+        void update();
+        /**
+         * Returns the next press, hold or release event.
+         */
+        bool poll_event(ButtonEvent *event);
+        /**
+         * Returns the input of the next press or key repeat, skipping the
+         * releases. This is what the games react to.
+         */
+        bool poll(uint8_t *input);
+
+        void set_config(KeyRepeatConfig config) { this->config = config; }
+        /**
+         * Sets the magnitude of the held input, see
+         * `DirectionalController::get_magnitude`. The repeat interval is
+         * scaled from twice the configured interval for the weakest input
+         * down to the configured interval for the strongest one.
+         */
+        void set_magnitude(uint8_t magnitude) { this->magnitude = magnitude; }
+        unsigned long get_dropped_events() { return dropped_events; }
+
+      private:
+        void advance(int button, unsigned long now);
+
+        DelayProvider *clock;
+        KeyRepeatConfig config;
+        uint8_t magnitude;
+        ButtonStateMachine buttons[4];
+        /**
+         * Raw state of the buttons reported by each of the sources, a button
+         * is held if it is held on any of them.
+         */
+        std::vector<uint8_t> source_states;
+        ButtonEvent events[BUTTON_EVENT_QUEUE_CAPACITY];
+        int events_head;
+        int events_count;
+        unsigned long dropped_events;
+};
+
+/**
+ * Directional controller adding debouncing and key repeat on top of the
+ * controllers of the platform. A held direction is reported once when it is
+ * pressed and then repeatedly at a steady rate, so the games don't need to
+ * sleep after each registered input to throttle the repeats.
+ */
+class KeyRepeatDirectionalController : public DirectionalController
+{
+      public:
+        KeyRepeatDirectionalController(
+            std::vector<DirectionalController *> *source,
+            DelayProvider *clock, KeyRepeatConfig config);
+
+        bool poll_for_input(Direction *input) override;
+        void setup() override {}
+
+        KeyRepeatEngine *get_engine() { return &engine; }
+
+      private:
+        std::vector<DirectionalController *> *source;
+        KeyRepeatEngine engine;
+        /**
+         * Index of the controller that reported the last press, its
+         * magnitude controls the key repeat rate.
+         */
+        size_t active_source;
+};
+
+class KeyRepeatActionController : public ActionController
+{
+      public:
+        KeyRepeatActionController(std::vector<ActionController *> *source,
+                                  DelayProvider *clock,
+                                  KeyRepeatConfig config);
+
+        bool poll_for_input(Action *input) override;
+        void setup() override {}
+
+        KeyRepeatEngine *get_engine() { return &engine; }
+
+      private:
+        std::vector<ActionController *> *source;
+        KeyRepeatEngine engine;
+};
+
+/**
+ * Copy of the platform whose controllers sit on top of the original ones and
+ * apply debouncing and key repeat. It is set up once by the entrypoint and
+ * all games run on top of it.
+ *
+ * The directions repeat while held, e.g. to scroll through the cells of the
+ * Minesweeper grid, and the further the joystick is tilted the faster they
+ * repeat. The actions don't repeat by default as most of them toggle
+ * something (pause, flags) and holding them shouldn't flip it back and forth.
+ */
+class KeyRepeatPlatform
+{
+      public:
+        KeyRepeatPlatform(Platform *platform);
+        ~KeyRepeatPlatform();
+
+        KeyRepeatPlatform(const KeyRepeatPlatform &) = delete;
+        KeyRepeatPlatform &operator=(const KeyRepeatPlatform &) = delete;
+
+        Platform *get_platform() { return &key_repeat_platform; }
+        void set_directional_config(KeyRepeatConfig config);
+        void set_action_config(KeyRepeatConfig config);
+
+      private:
+        Platform key_repeat_platform;
+        KeyRepeatDirectionalController *directional_controller;
+        KeyRepeatActionController *action_controller;
+        std::vector<DirectionalController *> directional_controllers;
+        std::vector<ActionController *> action_controllers;
+};
@@ -0,0 +1,369 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "latency_tracer.hpp"
+#include "logging.hpp"
+
+#define TAG "latency_tracer"
+
+static LatencyTracer *active_tracer = NULL;
+
+/**
+ * Display forwarding all draw calls to the original display and notifying
+ * the tracer once each of them has finished.
+ */
+class TracingDisplay : public Display
+{
+      public:
+        TracingDisplay(Display *display, LatencyTracer *tracer)
+            : display(display), tracer(tracer)
+        {
+        }
+
+        void setup() override { display->setup(); }
+        void initialize() override { display->initialize(); }
+        void clear(Color color) override
+        {
+                display->clear(color);
+                tracer->on_draw(false);
+        }
+        void draw_rounded_border(Color color) override
+        {
+                display->draw_rounded_border(color);
+                tracer->on_draw(false);
+        }
+        void draw_circle(Point center, int radius, Color color,
+                         int border_width, bool filled) override
+        {
+                display->draw_circle(center, radius, color, border_width,
+                                     filled);
+                tracer->on_draw(false);
+        }
+        void draw_rectangle(Point start, int width, int height, Color color,
+                            int border_width, bool filled) override
+        {
+                display->draw_rectangle(start, width, height, color,
+                                        border_width, filled);
+                tracer->on_draw(false);
+        }
+        void draw_rounded_rectangle(Point start, int width, int height,
+                                    int radius, Color color) override
+        {
+                display->draw_rounded_rectangle(start, width, height, radius,
+                                                color);
+                tracer->on_draw(false);
+        }
+        void draw_string(Point start, char *string_buffer, FontSize font_size,
+                         Color bg_color, Color fg_color) override
+        {
+                display->draw_string(start, string_buffer, font_size,
+                                     bg_color, fg_color);
+                tracer->on_draw(false);
+        }
+        void clear_region(Point top_left, Point bottom_right,
+                          Color clear_color) override
+        {
+                display->clear_region(top_left, bottom_right, clear_color);
+                tracer->on_draw(false);
+        }
+        void rasterize_string(char *string_buffer, FontSize font_size,
+                              uint8_t *mask, int width, int height) override
+        {
+                display->rasterize_string(string_buffer, font_size, mask,
+                                          width, height);
+        }
+        void draw_bitmap(Point start, int width, int height,
+                         const uint8_t *mask, Color bg_color,
+                         Color fg_color) override
+        {
+                display->draw_bitmap(start, width, height, mask, bg_color,
+                                     fg_color);
+                tracer->on_draw(false);
+        }
+        int get_height() override { return display->get_height(); }
+        int get_width() override { return display->get_width(); }
+        int get_display_corner_radius() override
+        {
+                return display->get_display_corner_radius();
+        }
+        void refresh() override
+        {
+                display->refresh();
+                tracer->on_draw(true);
+        }
+
+      private:
+        Display *display;
+        LatencyTracer *tracer;
+};
+
+class TracingDirectionalController : public DirectionalController
+{
+      public:
+        TracingDirectionalController(
+            std::vector<DirectionalController *> *source,
+            LatencyTracer *tracer)
+            : source(source), tracer(tracer)
+        {
+        }
+
+        bool poll_for_input(Direction *input) override
+        {
+                tracer->on_poll();
+                if (!directional_input_registered(source, input)) {
+                        return false;
+                }
+                tracer->on_input();
+                return true;
+        }
+
+        void setup() override {}
+
+      private:
+        std::vector<DirectionalController *> *source;
+        LatencyTracer *tracer;
+};
+
+class TracingActionController : public ActionController
+{
+      public:
+        TracingActionController(std::vector<ActionController *> *source,
+                                LatencyTracer *tracer)
+            : source(source), tracer(tracer)
+        {
+        }
+
+        bool poll_for_input(Action *input) override
+        {
+                tracer->on_poll();
+                if (!action_input_registered(source, input)) {
+                        return false;
+                }
+                tracer->on_input();
+                return true;
+        }
+
+        void setup() override {}
+
+      private:
+        std::vector<ActionController *> *source;
+        LatencyTracer *tracer;
+};
+
+LatencyHistogram::LatencyHistogram()
+    : samples(0), unrendered(0), total_ms(0), max_ms(0)
+{
+        memset(buckets, 0, sizeof(buckets));
+}
+
+void LatencyHistogram::record(unsigned long latency_ms)
+{
+        int bucket = 0;
+        while (bucket < LATENCY_HISTOGRAM_BUCKETS - 1 &&
+               latency_ms >= (1UL << bucket)) {
+                bucket++;
+        }
+        buckets[bucket]++;
+        samples++;
+        total_ms += latency_ms;
+        if (latency_ms > max_ms) {
+                max_ms = latency_ms;
+        }
+}
+
+unsigned long LatencyHistogram::percentile_upper_bound(int percentile)
+{
+        if (samples == 0) {
+                return 0;
+        }
+        unsigned long target = ((unsigned long)samples * percentile + 99) / 100;
+        unsigned long cumulative = 0;
+        for (int bucket = 0; bucket < LATENCY_HISTOGRAM_BUCKETS - 1; bucket++) {
+                cumulative += buckets[bucket];
+                // The bucket bound can't be larger than the slowest sample.
+                unsigned long bound = (1UL << bucket) - 1;
+                if (cumulative >= target) {
+                        return bound < max_ms ? bound : max_ms;
+                }
+        }
+        return max_ms;
+}
+
+LatencyTracer::LatencyTracer(Platform *platform)
+    : platform(platform), game("Unknown"), screen(LATENCY_DEFAULT_SCREEN),
+      screens(0), pending(NULL), input_time(0), photon_time(0), drawn(false),
+      unpresented(false)
+{
+        display = new TracingDisplay(platform->display, this);
+        directional_controllers = {new TracingDirectionalController(
+            platform->directional_controllers, this)};
+        action_controllers = {
+            new TracingActionController(platform->action_controllers, this)};
+        tracing_platform = {
+            .display = display,
+            .directional_controllers = &directional_controllers,
+            .action_controllers = &action_controllers,
+            .delay_provider = platform->delay_provider,
+            .persistent_storage = platform->persistent_storage,
+            .record_store = platform->record_store,
+            .settings_cache = platform->settings_cache,
+            .high_scores = platform->high_scores};
+        active_tracer = this;
+}
+
+LatencyTracer::~LatencyTracer()
+{
+        if (active_tracer == this) {
+                active_tracer = NULL;
+        }
+        delete display;
+        delete directional_controllers[0];
+        delete action_controllers[0];
+}
+
+void LatencyTracer::set_game(const char *game)
+{
+        this->game = game;
+        screen = LATENCY_DEFAULT_SCREEN;
+}
+
+const char *LatencyTracer::set_screen(const char *screen)
+{
+        const char *previous = this->screen;
+        this->screen = screen;
+        return previous;
+}
+
+void LatencyTracer::on_poll()
+{
+        if (!pending) {
+                return;
+        }
+        if (drawn) {
+                finish_measurement();
+                return;
+        }
+        unsigned long now = platform->delay_provider->get_time_ms();
+        if (now - input_time > LATENCY_TRACE_TIMEOUT_MS) {
+                pending->histogram.unrendered++;
+                pending = NULL;
+        }
+}
+
+void LatencyTracer::on_input()
+{
+        // Inputs can arrive before the game has polled again, e.g. if it
+        // polls both kinds of controllers in a single iteration.
+        if (pending && drawn) {
+                finish_measurement();
+        } else if (pending) {
+                pending->histogram.unrendered++;
+        }
+        pending = find_stats(game, screen);
+        input_time = platform->delay_provider->get_time_ms();
+        photon_time = input_time;
+        drawn = false;
+        unpresented = false;
+}
+
+void LatencyTracer::on_draw(bool refresh)
+{
+        if (!pending || (refresh && !unpresented)) {
+                return;
+        }
+        unsigned long now = platform->delay_provider->get_time_ms();
+        if (!drawn && now - input_time > LATENCY_TRACE_TIMEOUT_MS) {
+                pending->histogram.unrendered++;
+                pending = NULL;
+                return;
+        }
+        photon_time = now;
+        drawn = true;
+        unpresented = !refresh;
+}
+
+void LatencyTracer::finish_measurement()
+{
+        pending->histogram.record(photon_time - input_time);
+        pending = NULL;
+}
+
+LatencyScreenStats *LatencyTracer::find_stats(const char *game,
+                                              const char *screen)
+{
+        for (int i = 0; i < screens; i++) {
+                if (strcmp(stats[i].game, game) == 0 &&
+                    strcmp(stats[i].screen, screen) == 0) {
+                        return &stats[i];
+                }
+        }
+        if (screens == LATENCY_MAX_SCREENS) {
+                return NULL;
+        }
+        LatencyScreenStats *entry = &stats[screens++];
+        entry->game = game;
+        entry->screen = screen;
+        entry->histogram = LatencyHistogram();
+        return entry;
+}
+
+void LatencyTracer::report()
+{
+        for (int i = 0; i < screens; i++) {
+                LatencyHistogram *h = &stats[i].histogram;
+                if (h->samples == 0 && h->unrendered == 0) {
+                        continue;
+                }
+                LOG_INFO(TAG,
+                         "%s / %s: %u inputs, average %lu ms, p50 <= %lu ms, "
+                         "p95 <= %lu ms, max %lu ms, %u without a redraw",
+                         stats[i].game, stats[i].screen, h->samples,
+                         h->samples ? h->total_ms / h->samples : 0,
+                         h->percentile_upper_bound(50),
+                         h->percentile_upper_bound(95), h->max_ms,
+                         h->unrendered);
+
+                char buffer[200];
+                int length = 0;
+                for (int b = 0; b < LATENCY_HISTOGRAM_BUCKETS; b++) {
+                        if (h->buckets[b] == 0) {
+                                continue;
+                        }
+                        const char *bound =
+                            b == LATENCY_HISTOGRAM_BUCKETS - 1 ? ">=" : "<";
+                        unsigned long limit =
+                            b == LATENCY_HISTOGRAM_BUCKETS - 1 ? 1UL << (b - 1)
+                                                               : 1UL << b;
+                        length += snprintf(buffer + length,
+                                           sizeof(buffer) - length,
+                                           " %s%lums:%u", bound, limit,
+                                           h->buckets[b]);
+                }
+                if (length > 0) {
+                        LOG_INFO(TAG, "%s / %s histogram:%s", stats[i].game,
+                                 stats[i].screen, buffer);
+                }
+        }
+}
+
+void trace_latency_game(const char *game)
+{
+        if (active_tracer) {
+                active_tracer->set_game(game);
+        }
+}
+
+const char *trace_latency_screen(const char *screen)
+{
+        if (!active_tracer) {
+                return screen;
+        }
+        return active_tracer->set_screen(screen);
+}
+
+void report_latency()
+{
+        if (active_tracer) {
+                active_tracer->report();
+        }
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+#include "platform/interface/platform.hpp"
+
+/**
+ * The latencies are grouped into power-of-two buckets: the first one holds
+ * the latencies below 1 ms, bucket `i` holds the latencies in the range
+ * [2^(i-1), 2^i) ms and the last one everything from 1024 ms up.
+ */
+#define LATENCY_HISTOGRAM_BUCKETS 12
+/**
+ * Maximum number of distinct game/screen pairs that are tracked, the inputs
+ * on any further screens are not measured.
+ */
+#define LATENCY_MAX_SCREENS 16
+/**
+ * If nothing was drawn for this long after an input was registered, the input
+ * is considered to have had no visible effect. This prevents e.g. the next
+ * periodic redraw of the Game of Life from being attributed to an input that
+ * was ignored by the game.
+ */
+#define LATENCY_TRACE_TIMEOUT_MS 2000
+
+/**
+ * Screen name used for the inputs of a game until it switches to one of its
+ * other screens, e.g. the configuration menu.
+ */
+#define LATENCY_DEFAULT_SCREEN "Game"
+
+/**
+ * Histogram of the input-to-photon latencies measured on a single screen.
+ */
+class LatencyHistogram
+{
+      public:
+        LatencyHistogram();
+
+        void record(unsigned long latency_ms);
+        /**
+         * Returns the upper bound of the bucket containing the given
+         * percentile of the samples, or 0 if there are no samples.
+         */
+        unsigned long percentile_upper_bound(int percentile);
+
+        uint16_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+        uint16_t samples;
+        /**
+         * Inputs after which nothing was drawn on the screen.
+         */
+        uint16_t unrendered;
+        unsigned long total_ms;
+        unsigned long max_ms;
+};
+
+typedef struct LatencyScreenStats {
+        const char *game;
+        const char *screen;
+        LatencyHistogram histogram;
+} LatencyScreenStats;
+
+/**
+ * Measures the input-to-photon latency: the time from the moment an input
+ * is registered by the game until the last pixel drawn in response to it
+ * reaches the screen.
+ *
+ * Similarly to the `ReplayRecorder`, the tracer provides a copy of the
+ * platform whose controllers and display forward to the original ones. Each
+ * registered input is timestamped and every draw call that follows it is
+ * attributed to it. On the LCD the pixels are written by the time a draw
+ * call returns, the SFML window only presents them on `refresh`, so the
+ * photon time is the end of the last draw call or refresh after the input.
+ * The measurement of an input is finished once the game polls for input
+ * again after having drawn something, which is when it is done reacting.
+ *
+ * The latencies are collected per game and per screen (as set using
+ * `trace_latency_game` and `trace_latency_screen`) so that e.g. the redraws
+ * of the configuration menu can be compared with the moves in 2048.
+ */
+class LatencyTracer
+{
+      public:
+        LatencyTracer(Platform *platform);
+        ~LatencyTracer();
+
+        LatencyTracer(const LatencyTracer &) = delete;
+        LatencyTracer &operator=(const LatencyTracer &) = delete;
+
+        /**
+         * Returns the platform that needs to be passed to the games to trace
+         * their latency.
+         */
+        Platform *get_platform() { return &tracing_platform; }
+
+        void set_game(const char *game);
+        /**
+         * Returns the previous screen so that it can be restored once the
+         * screen is left.
+         */
+        const char *set_screen(const char *screen);
+
+        /**
+         * Called by the tracing controllers before polling the original ones.
+         */
+        void on_poll();
+        void on_input();
+        /**
+         * Called by the tracing display after each draw call (`refresh` set
+         * to false) and after each refresh of the display.
+         */
+        void on_draw(bool refresh);
+
+        /**
+         * Logs the histograms of all screens where any input was registered.
+         */
+        void report();
+
+      private:
+        LatencyScreenStats *find_stats(const char *game, const char *screen);
+        void finish_measurement();
+
+        Platform *platform;
+        Platform tracing_platform;
+        Display *display;
+        std::vector<DirectionalController *> directional_controllers;
+        std::vector<ActionController *> action_controllers;
+
+        const char *game;
+        const char *screen;
+        LatencyScreenStats stats[LATENCY_MAX_SCREENS];
+        int screens;
+
+        /**
+         * Screen on which the input that is currently being measured was
+         * registered, NULL if no measurement is in progress.
+         */
+        LatencyScreenStats *pending;
+        unsigned long input_time;
+        unsigned long photon_time;
+        bool drawn;
+        /**
+         * Set if something was drawn since the last refresh, i.e. the SFML
+         * window is yet to present it.
+         */
+        bool unpresented;
+};
+
+/**
+ * The functions below forward to the tracer that currently exists, if any.
+ * This allows the games and menus to label their screens without having
+ * access to the tracer itself.
+ */
+void trace_latency_game(const char *game);
+const char *trace_latency_screen(const char *screen);
+void report_latency();
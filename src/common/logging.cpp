@@ -11,3 +11,248 @@ const char *log_level_strings[] = {
     [(uint8_t)LogLevel::LOG_LVL_DEBUG] = "DEBUG",
     [(uint8_t)LogLevel::LOG_LVL_TRACE] = "TRACE",
 };
+
+static void log_print(const char *tag, LogLevel level,
+                      const char *function_name, int line, const char *message)
+{
+#ifdef EMULATOR
+        printf("%s: [%s] %s:%d: %s\n", tag, log_level_strings[(int)level],
+               function_name, line, message);
+#else
+        // The metadata is printed piece by piece, so it doesn't need to be
+        // formatted into another buffer first.
+        Serial.print(tag);
+        Serial.print(": [");
+        Serial.print(log_level_strings[(int)level]);
+        Serial.print("] ");
+        Serial.print(function_name);
+        Serial.print(":");
+        Serial.print(line);
+        Serial.print(": ");
+        Serial.println(message);
+#endif
+}
+
+void log_message(const char *tag, LogLevel level, const char *function_name,
+                 int line, const char *fmt, ...)
+{
+        char buffer[LOG_MESSAGE_MAX_LENGTH];
+        va_list args;
+        // Initializes varargs properly. We need to pass in the last named
+        // parameter `fmt` so that the compiler knows where the varargs part
+        // starts in memory.
+        va_start(args, fmt);
+        // This passes the varargs into sprintf so that the format string can be
+        // formatted properly.
+        vsnprintf(buffer, sizeof(buffer), fmt, args);
+        va_end(args);
+        log_print(tag, level, function_name, line, buffer);
+}
+
+#ifdef LOG_BINARY
+typedef struct LogArg {
+        LogArgType type;
+        union {
+                int64_t integer;
+                double number;
+                uintptr_t address;
+        };
+        char string[LOG_STRING_MAX_LENGTH + 1];
+} LogArg;
+
+static uint8_t log_buffer[LOG_BUFFER_SIZE];
+/**
+ * Offset of the oldest buffered byte, the buffered entries wrap around the
+ * end of the buffer.
+ */
+static int log_start = 0;
+static int log_used = 0;
+static unsigned long log_dropped = 0;
+
+bool log_reserve(int length)
+{
+        if (length > LOG_BUFFER_SIZE - log_used) {
+                log_dropped++;
+                return false;
+        }
+        return true;
+}
+
+void log_write(const void *data, int length)
+{
+        const uint8_t *bytes = (const uint8_t *)data;
+        int end = (log_start + log_used) % LOG_BUFFER_SIZE;
+        int first = LOG_BUFFER_SIZE - end < length ? LOG_BUFFER_SIZE - end
+                                                   : length;
+        memcpy(log_buffer + end, bytes, first);
+        memcpy(log_buffer, bytes + first, length - first);
+        log_used += length;
+}
+
+static void log_read(void *data, int length)
+{
+        uint8_t *bytes = (uint8_t *)data;
+        int first = LOG_BUFFER_SIZE - log_start < length
+                        ? LOG_BUFFER_SIZE - log_start
+                        : length;
+        memcpy(bytes, log_buffer + log_start, first);
+        memcpy(bytes + first, log_buffer, length - first);
+        log_start = (log_start + length) % LOG_BUFFER_SIZE;
+        log_used -= length;
+}
+
+static void log_read_arg(LogArg *arg)
+{
+        log_read(&arg->type, 1);
+        switch (arg->type) {
+        case LogArgType::INT32: {
+                int32_t number;
+                log_read(&number, sizeof(number));
+                arg->integer = number;
+        } break;
+        case LogArgType::INT64:
+                log_read(&arg->integer, sizeof(arg->integer));
+                break;
+        case LogArgType::DOUBLE:
+                log_read(&arg->number, sizeof(arg->number));
+                break;
+        case LogArgType::STRING: {
+                uint8_t length;
+                log_read(&length, 1);
+                log_read(arg->string, length);
+                arg->string[length] = '\0';
+        } break;
+        case LogArgType::POINTER:
+                log_read(&arg->address, sizeof(arg->address));
+                break;
+        }
+}
+
+/**
+ * Formats a single conversion specification, e.g. `%-5lu`, with the given
+ * argument. The length modifiers of the specification are replaced with the
+ * ones matching the stored width of the argument.
+ */
+static int log_format_arg(char *buffer, int size, const char *spec,
+                          int spec_length, LogArg *arg)
+{
+        char conversion = spec[spec_length - 1];
+        char format[16];
+        int length = 0;
+        for (int i = 0; i < spec_length - 1 && length < 12; i++) {
+                if (!strchr("hlLqjzt", spec[i])) {
+                        format[length++] = spec[i];
+                }
+        }
+        bool wide = arg->type == LogArgType::INT64;
+        if (wide && strchr("diouxX", conversion)) {
+                format[length++] = 'l';
+                format[length++] = 'l';
+        }
+        format[length++] = conversion;
+        format[length] = '\0';
+
+        bool is_string = arg->type == LogArgType::STRING;
+        bool is_number = arg->type == LogArgType::DOUBLE;
+        switch (conversion) {
+        case 's':
+                return snprintf(buffer, size, format,
+                                is_string ? arg->string : "?");
+        case 'p':
+                return snprintf(buffer, size, format, (void *)arg->address);
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+                return snprintf(buffer, size, format,
+                                is_number ? arg->number : arg->integer);
+        case 'd':
+        case 'i':
+        case 'c':
+                if (is_string || is_number) {
+                        return snprintf(buffer, size, "?");
+                }
+                return wide ? snprintf(buffer, size, format,
+                                       (long long)arg->integer)
+                            : snprintf(buffer, size, format, (int)arg->integer);
+        default:
+                if (is_string || is_number) {
+                        return snprintf(buffer, size, "?");
+                }
+                return wide ? snprintf(buffer, size, format,
+                                       (unsigned long long)arg->integer)
+                            : snprintf(buffer, size, format,
+                                       (unsigned int)arg->integer);
+        }
+}
+
+/**
+ * Formats the message the same way as `vsnprintf`, except that the arguments
+ * come from the log buffer.
+ */
+static void log_format(char *buffer, int size, const char *format,
+                       LogArg *args, int count)
+{
+        int length = 0;
+        int next_arg = 0;
+        for (const char *c = format; *c && length < size - 1; c++) {
+                if (*c != '%') {
+                        buffer[length++] = *c;
+                        continue;
+                }
+                if (c[1] == '%') {
+                        buffer[length++] = '%';
+                        c++;
+                        continue;
+                }
+                int spec_length = 1;
+                while (c[spec_length] && !strchr("diouxXcspfFeEgG",
+                                                 c[spec_length])) {
+                        spec_length++;
+                }
+                if (!c[spec_length]) {
+                        break;
+                }
+                spec_length++;
+                if (next_arg < count) {
+                        int written =
+                            log_format_arg(buffer + length, size - length, c,
+                                           spec_length, &args[next_arg++]);
+                        length += written < 0 ? 0 : written;
+                }
+                c += spec_length - 1;
+        }
+        length = length < size - 1 ? length : size - 1;
+        buffer[length] = '\0';
+}
+
+void log_drain()
+{
+        if (log_dropped > 0) {
+                char message[64];
+                snprintf(message, sizeof(message),
+                         "%lu messages dropped, the log buffer was full.",
+                         log_dropped);
+                log_print("logging", LogLevel::LOG_LVL_ERROR, __func__,
+                          __LINE__, message);
+                log_dropped = 0;
+        }
+
+        LogArg args[LOG_MAX_ARGS];
+        char buffer[LOG_MESSAGE_MAX_LENGTH];
+        while (log_used > 0) {
+                const LogSite *site;
+                uint8_t count;
+                log_read(&site, sizeof(site));
+                log_read(&count, 1);
+                for (int i = 0; i < count; i++) {
+                        log_read_arg(&args[i]);
+                }
+                log_format(buffer, sizeof(buffer), site->format, args, count);
+                log_print(site->tag, site->level, site->function_name,
+                          site->line, buffer);
+        }
+}
+#endif
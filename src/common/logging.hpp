@@ -5,6 +5,8 @@
 #include <cstdint>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <type_traits>
 
 enum class LogLevel : uint8_t {
         LOG_LVL_NONE = 0,
@@ -31,43 +33,171 @@ extern const char *log_level_strings[];
 #include "Arduino.h"
 #endif
 
+/**
+ * The build level is a compile-time constant, so the log calls above it are
+ * removed by the compiler altogether, including the evaluation of their
+ * arguments.
+ */
 #define LEVEL_ENABLED(level)                                                   \
         (level <= (uint8_t)LOG_BUILD_LEVEL && level <= (uint8_t)log_run_level)
 
-inline void log_message(const char *tag, LogLevel level,
-                        const char *function_name, int line, const char *fmt,
-                        ...)
-{
-        if (!LEVEL_ENABLED((uint8_t)level))
-                return;
+/**
+ * Maximum length of a formatted log message, longer ones are truncated.
+ */
+#define LOG_MESSAGE_MAX_LENGTH 256
+
+void log_message(const char *tag, LogLevel level, const char *function_name,
+                 int line, const char *fmt, ...);
 
-        char buffer[400];
-        va_list args;
-        // Initializes varargs properly. We need to pass in the last named
-        // parameter `fmt` so that the compiler knows where the varargs part
-        // starts in memory.
-        va_start(args, fmt);
-        // This passes the varargs into sprintf so that the format string can be
-        // formatted properly.
-        vsnprintf(buffer, sizeof(buffer), fmt, args);
+#ifdef LOG_BINARY
+/*
+ * In the binary mode (enabled by defining `LOG_BINARY`, e.g. using the
+ * `GAME_CONSOLE_BINARY_LOGGING` CMake option) the log calls don't format
+ * anything. Each call site owns a static `LogSite` holding its format string
+ * and metadata, so its address identifies the site and the strings never
+ * leave the flash. A call only pushes the address of its site followed by
+ * its raw arguments into a ring buffer, which takes a few microseconds
+ * instead of formatting the message and sending it over the serial port.
+ * The messages are formatted once the buffer is drained using `log_drain`,
+ * which happens in between the games. If the buffer fills up before that,
+ * the new messages are dropped and their count is reported by the drain.
+ */
+#ifndef LOG_BUFFER_SIZE
 #ifdef EMULATOR
-        printf("%s: [%s] %s:%d: %s\n", tag, log_level_strings[(int)level],
-               function_name, line, buffer);
+#define LOG_BUFFER_SIZE 65536
 #else
-        char log_with_metadata[400];
-        sprintf(log_with_metadata, "%s: [%s] %s:%d: %s", tag,
-                log_level_strings[(int)level], function_name, line, buffer);
-        Serial.println(log_with_metadata);
+#define LOG_BUFFER_SIZE 2048
 #endif
-        va_end(args);
+#endif
+/**
+ * Strings passed as arguments are copied into the buffer as they may not
+ * outlive the call, the longer ones are truncated.
+ */
+#define LOG_STRING_MAX_LENGTH 32
+#define LOG_MAX_ARGS 8
+
+typedef struct LogSite {
+        const char *tag;
+        const char *function_name;
+        const char *format;
+        int line;
+        LogLevel level;
+} LogSite;
+
+/**
+ * Each argument is stored as its type followed by its value. Integers are
+ * stored with their native width, the strings are prefixed with their length.
+ */
+enum class LogArgType : uint8_t {
+        INT32 = 0,
+        INT64 = 1,
+        DOUBLE = 2,
+        STRING = 3,
+        POINTER = 4,
+};
+
+/**
+ * Checks that an entry of `length` bytes fits into the buffer, otherwise the
+ * entry is counted as dropped.
+ */
+bool log_reserve(int length);
+void log_write(const void *data, int length);
+
+template <typename T> inline int log_arg_size(T value)
+{
+        if constexpr (std::is_convertible_v<T, const char *>) {
+                const char *string = value ? value : "";
+                return 2 + strnlen(string, LOG_STRING_MAX_LENGTH);
+        } else if constexpr (std::is_floating_point_v<T>) {
+                return 1 + sizeof(double);
+        } else if constexpr (std::is_pointer_v<T>) {
+                return 1 + sizeof(uintptr_t);
+        } else if constexpr (sizeof(T) <= sizeof(int32_t)) {
+                return 1 + sizeof(int32_t);
+        } else {
+                return 1 + sizeof(int64_t);
+        }
+}
+
+template <typename T> inline void log_write_arg(T value)
+{
+        LogArgType type;
+        if constexpr (std::is_convertible_v<T, const char *>) {
+                const char *string = value ? value : "";
+                uint8_t length = strnlen(string, LOG_STRING_MAX_LENGTH);
+                type = LogArgType::STRING;
+                log_write(&type, 1);
+                log_write(&length, 1);
+                log_write(string, length);
+        } else if constexpr (std::is_floating_point_v<T>) {
+                double number = value;
+                type = LogArgType::DOUBLE;
+                log_write(&type, 1);
+                log_write(&number, sizeof(number));
+        } else if constexpr (std::is_pointer_v<T>) {
+                uintptr_t address = (uintptr_t)value;
+                type = LogArgType::POINTER;
+                log_write(&type, 1);
+                log_write(&address, sizeof(address));
+        } else if constexpr (sizeof(T) <= sizeof(int32_t)) {
+                int32_t number = static_cast<int32_t>(value);
+                type = LogArgType::INT32;
+                log_write(&type, 1);
+                log_write(&number, sizeof(number));
+        } else {
+                int64_t number = static_cast<int64_t>(value);
+                type = LogArgType::INT64;
+                log_write(&type, 1);
+                log_write(&number, sizeof(number));
+        }
+}
+
+template <typename... Args>
+inline void log_binary(const LogSite *site, Args... args)
+{
+        static_assert(sizeof...(args) <= LOG_MAX_ARGS,
+                      "Too many arguments for a binary log entry.");
+        int length = sizeof(site) + 1 + (0 + ... + log_arg_size(args));
+        if (!log_reserve(length)) {
+                return;
+        }
+        uint8_t count = sizeof...(args);
+        log_write(&site, sizeof(site));
+        log_write(&count, 1);
+        (log_write_arg(args), ...);
 }
 
+/**
+ * Formats and prints all buffered log messages.
+ */
+void log_drain();
+
+#define LOG(tag, level, fmt, ...)                                              \
+        do {                                                                   \
+                if (LEVEL_ENABLED((uint8_t)level)) {                           \
+                        static const LogSite log_site = {                      \
+                            tag, __func__, fmt, __LINE__, level};              \
+                        log_binary(&log_site, ##__VA_ARGS__);                  \
+                }                                                              \
+        } while (0)
+#else
+/**
+ * The messages are printed right away, there is nothing to drain.
+ */
+inline void log_drain() {}
+
 // We use the __func__ to extract the name of the function from where the log
 // is used. This is used instead of the __FUNCTION__ that was previously here.
 // That other one is not supported by all compilers and is not a part of the C++
 // standard.
 #define LOG(tag, level, fmt, ...)                                              \
-        log_message(tag, level, __func__, __LINE__, fmt, ##__VA_ARGS__)
+        do {                                                                   \
+                if (LEVEL_ENABLED((uint8_t)level)) {                           \
+                        log_message(tag, level, __func__, __LINE__, fmt,       \
+                                    ##__VA_ARGS__);                            \
+                }                                                              \
+        } while (0)
+#endif
 
 #define LOG_INFO(tag, format, ...)                                             \
         LOG(tag, LogLevel::LOG_LVL_INFO, format, ##__VA_ARGS__)
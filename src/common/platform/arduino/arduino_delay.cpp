@@ -2,14 +2,21 @@
 class ArduinoDelay : public DelayProvider
 {
         void delay_ms(int ms) override { delay(ms); }
+        unsigned long get_time_ms() override { return millis(); }
 
       public:
-        /// The function pointer to the Arduino delay needs to be passed in the
-        /// .ino file. The reason is that those functions cannot be imported
-        /// in C++ sources directly.
-        ArduinoDelay(void (*delay_)(int)) : delay(delay_) {}
+        /// The function pointers to the Arduino delay and millis need to be
+        /// passed in the .ino file. The reason is that those functions cannot
+        /// be imported in C++ sources directly.
+        ArduinoDelay(void (*delay_)(int), unsigned long (*millis_)(void))
+            : delay(delay_), millis(millis_)
+        {
+        }
 
       private:
         /// The function pointer to the actual arduino delay function.
         void (*delay)(int);
+        /// The function pointer to the arduino function returning the number
+        /// of milliseconds since the board was started.
+        unsigned long (*millis)(void);
 };
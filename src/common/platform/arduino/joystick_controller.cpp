@@ -1,28 +1,139 @@
 #include "joystick_controller.hpp"
+#include <math.h>
+#include <stdlib.h>
 
 bool JoystickController::poll_for_input(Direction *input)
 {
+        uint8_t queued_input;
+        if (!queue.poll(&queued_input)) {
+                return false;
+        }
+        *input = (Direction)queued_input;
+        return true;
+}
 
-        int x_val = this->analog_read(STICK_X_PIN);
-        int y_val = this->analog_read(STICK_Y_PIN);
+bool JoystickController::poll_event(InputEvent *event)
+{
+        return queue.pop(event);
+}
 
-        if (x_val < LOW_THRESHOLD) {
-                *input = Direction::RIGHT;
-                return true;
+void JoystickController::setup() { }
+
+void JoystickController::calibrate()
+{
+        long sum_x = 0;
+        long sum_y = 0;
+        for (int i = 0; i < STICK_CALIBRATION_SAMPLES; i++) {
+                sum_x += this->analog_read(STICK_X_PIN);
+                sum_y += this->analog_read(STICK_Y_PIN);
         }
-        if (x_val > HIGH_THRESHOLD) {
-                *input = Direction::LEFT;
-                return true;
+        int rest_x = sum_x / STICK_CALIBRATION_SAMPLES;
+        int rest_y = sum_y / STICK_CALIBRATION_SAMPLES;
+        if (abs(rest_x - STICK_NOMINAL_CENTER) > STICK_CALIBRATION_MAX_OFFSET ||
+            abs(rest_y - STICK_NOMINAL_CENTER) > STICK_CALIBRATION_MAX_OFFSET) {
+                // The stick wasn't resting during calibration, the tracking
+                // of the center fixes the small offsets later on.
+                rest_x = STICK_NOMINAL_CENTER;
+                rest_y = STICK_NOMINAL_CENTER;
         }
-        if (y_val < LOW_THRESHOLD) {
-                *input = Direction::UP;
-                return true;
+        center_x = rest_x * STICK_FIXED_POINT_SCALE;
+        center_y = rest_y * STICK_FIXED_POINT_SCALE;
+        filtered_x = center_x;
+        filtered_y = center_y;
+}
+
+void JoystickController::sample(unsigned long timestamp)
+{
+        // The ADC conversion is the slow part of sampling, so the axes take
+        // turns. At the 200 Hz sampling rate each axis is read at 100 Hz which
+        // is still plenty for a joystick.
+        if (sample_y_axis) {
+                int raw = this->analog_read(STICK_Y_PIN) *
+                          STICK_FIXED_POINT_SCALE;
+                filtered_y += (raw - filtered_y) / STICK_SMOOTHING_FACTOR;
+        } else {
+                int raw = this->analog_read(STICK_X_PIN) *
+                          STICK_FIXED_POINT_SCALE;
+                filtered_x += (raw - filtered_x) / STICK_SMOOTHING_FACTOR;
         }
-        if (y_val > HIGH_THRESHOLD) {
-                *input = Direction::DOWN;
-                return true;
+        sample_y_axis = !sample_y_axis;
+
+        int dx = (filtered_x - center_x) / STICK_FIXED_POINT_SCALE;
+        int dy = (filtered_y - center_y) / STICK_FIXED_POINT_SCALE;
+        long radius_squared = (long)dx * dx + (long)dy * dy;
+
+        held_direction = classify_position(dx, dy, radius_squared);
+        if (held_direction == -1) {
+                magnitude = 0;
+                // Only the positions well within the deadzone are used for
+                // tracking so that a slow tilt doesn't drag the center along.
+                if (4 * radius_squared <
+                    (long)STICK_RELEASE_RADIUS * STICK_RELEASE_RADIUS) {
+                        center_x += (filtered_x - center_x) /
+                                    STICK_CENTER_TRACKING_FACTOR;
+                        center_y += (filtered_y - center_y) /
+                                    STICK_CENTER_TRACKING_FACTOR;
+                }
+        } else {
+                int radius = sqrtf(radius_squared);
+                int beyond = radius - STICK_PRESS_RADIUS;
+                beyond = beyond < 0 ? 0 : beyond;
+                int range = STICK_MAX_DEFLECTION - STICK_PRESS_RADIUS;
+                magnitude = beyond >= range
+                                ? DIRECTION_MAGNITUDE_MAX
+                                : beyond * DIRECTION_MAGNITUDE_MAX / range;
         }
-        return false;
+
+        uint8_t state = held_direction == -1 ? 0 : 1 << held_direction;
+        queue.record_state(state, timestamp);
 }
 
-void JoystickController::setup() { }
+/**
+ * Returns the component of the tilt in the given direction. The X axis is
+ * inverted: low values correspond to the stick tilted to the right.
+ */
+static int component_along(int direction, int dx, int dy)
+{
+        switch (direction) {
+        case Direction::UP:
+                return -dy;
+        case Direction::DOWN:
+                return dy;
+        case Direction::RIGHT:
+                return -dx;
+        case Direction::LEFT:
+                return dx;
+        }
+        return 0;
+}
+
+int JoystickController::classify_position(int dx, int dy, long radius_squared)
+{
+        if (held_direction != -1) {
+                bool horizontal = held_direction == Direction::LEFT ||
+                                  held_direction == Direction::RIGHT;
+                int along = component_along(held_direction, dx, dy);
+                int across = abs(horizontal ? dy : dx);
+                bool released =
+                    radius_squared <
+                        (long)STICK_RELEASE_RADIUS * STICK_RELEASE_RADIUS ||
+                    along * STICK_AXIS_DOMINANCE_NUM <=
+                        across * STICK_AXIS_DOMINANCE_DEN;
+                if (!released) {
+                        return held_direction;
+                }
+        }
+
+        if (radius_squared < (long)STICK_PRESS_RADIUS * STICK_PRESS_RADIUS) {
+                return -1;
+        }
+        if (abs(dx) * STICK_AXIS_DOMINANCE_DEN >=
+            abs(dy) * STICK_AXIS_DOMINANCE_NUM) {
+                return dx < 0 ? Direction::RIGHT : Direction::LEFT;
+        }
+        if (abs(dy) * STICK_AXIS_DOMINANCE_DEN >=
+            abs(dx) * STICK_AXIS_DOMINANCE_NUM) {
+                return dy < 0 ? Direction::UP : Direction::DOWN;
+        }
+        return -1;
+}
@@ -1,12 +1,54 @@
 #include "../interface/controller.hpp"
+#include "../interface/input_event_queue.hpp"
 
 /**
  * The joystick reports the current position using two potentiometers. Those
- * are read using analog pins that return values in range 0-1023. The two
- * constants below control how quickly the joystick registers input.
+ * are read using analog pins that return values in range 0-1023, the resting
+ * position is around the middle of the range.
  */
-#define HIGH_THRESHOLD 900
-#define LOW_THRESHOLD 100
+#define STICK_NOMINAL_CENTER 512
+#define STICK_MAX_DEFLECTION 512
+
+/**
+ * The deadzone is radial: a direction is registered once the stick is tilted
+ * further than the press radius from its calibrated center and released once
+ * it gets back within the release radius. The gap between the two prevents
+ * the noise from toggling the direction at the edge of the deadzone.
+ */
+#define STICK_PRESS_RADIUS 320
+#define STICK_RELEASE_RADIUS 260
+
+/**
+ * A new direction is only registered if the stick is tilted along one of the
+ * axes, i.e. one component is at least 3/2 times the other. Diagonal input is
+ * ambiguous and is ignored instead of picking an arbitrary axis. A direction
+ * that is already held is kept until the other axis gets that much larger.
+ */
+#define STICK_AXIS_DOMINANCE_NUM 3
+#define STICK_AXIS_DOMINANCE_DEN 2
+
+/**
+ * The samples are smoothed using an exponential moving average with weight
+ * 1/STICK_SMOOTHING_FACTOR. The averages are kept in fixed point with
+ * STICK_FIXED_POINT_SCALE fractional steps to avoid losing precision.
+ */
+#define STICK_SMOOTHING_FACTOR 4
+#define STICK_FIXED_POINT_SCALE 16
+
+/**
+ * Number of samples averaged to find the resting position at startup. If the
+ * result is too far from the nominal center (e.g. the stick was held while
+ * the console was booting), the nominal center is used instead.
+ */
+#define STICK_CALIBRATION_SAMPLES 32
+#define STICK_CALIBRATION_MAX_OFFSET 100
+
+/**
+ * While the stick rests deep inside of the deadzone, the center follows the
+ * resting position with weight 1/STICK_CENTER_TRACKING_FACTOR. This corrects
+ * the drift of the potentiometers over time.
+ */
+#define STICK_CENTER_TRACKING_FACTOR 256
 
 /** Pins controlling the joystick */
 #define A0 13 // TODO: verify if this pin number is accurate
@@ -18,21 +60,34 @@ class JoystickController : public DirectionalController
 {
       public:
         /**
-         * For a given controllers, this function will inspect its state to
-         * determine if an input is being entered. Note that for physical
-         * controllers, this function only tests for the state of the controller
-         * right now (it doesn't poll for a period of time). Becuase of this,
-         * this function should be called in a loop if we want the system to
-         * wait for the user to provide input.
+         * Returns the next input from the event queue filled in by `sample`,
+         * see `InputEventQueue::poll`. Presses that happen while the game is
+         * busy (e.g. rendering) are queued and returned once the game polls
+         * for input again, one per call. Because of this, this function
+         * should be called in a loop if we want the system to wait for the
+         * user to provide input.
          *
          * If an input is registered, it will be written into the `Direction
          * *input` parameter and `true` will be returned.
          *
          * If no input is registered, this function returns false and the
-         * direction pointer remains unchanged.
+         * input pointer remains unchanged.
          */
         bool poll_for_input(Direction *input) override;
 
+        /**
+         * Returns the next press or release recorded by `sample`, together
+         * with the time at which it was sampled.
+         */
+        bool poll_event(InputEvent *event) override;
+
+        /**
+         * Returns how far the stick is tilted beyond the deadzone, scaled to
+         * 0-DIRECTION_MAGNITUDE_MAX. This allows e.g. the key repeat to move
+         * the caret faster the further the stick is held.
+         */
+        uint8_t get_magnitude() override { return magnitude; }
+
         /**
          * Setup function used for e.g. initializing pins of the controller.
          * This is to be called only once inside of the `setup` Arduino
@@ -46,8 +101,30 @@ class JoystickController : public DirectionalController
          */
         void setup() override;
 
+        /**
+         * Reads the position of the joystick and queues an event for each
+         * input that was pressed or released since the previous sample.
+         * It is called periodically from the input sampling timer interrupt,
+         * which is the only producer of the event queue.
+         *
+         * Only one of the axes is converted per call to keep the time spent
+         * in the interrupt short, the position is smoothed before it is
+         * mapped onto a direction.
+         */
+        void sample(unsigned long timestamp);
+
+        /**
+         * Finds the resting position of the stick. This needs to be called
+         * once in the `setup` Arduino function before the sampling starts.
+         */
+        void calibrate();
+
         JoystickController(int (*analog_read_)(unsigned char))
-            : analog_read(analog_read_)
+            : analog_read(analog_read_),
+              center_x(STICK_NOMINAL_CENTER * STICK_FIXED_POINT_SCALE),
+              center_y(STICK_NOMINAL_CENTER * STICK_FIXED_POINT_SCALE),
+              filtered_x(center_x), filtered_y(center_y),
+              sample_y_axis(false), held_direction(-1), magnitude(0)
         {
         }
 
@@ -63,4 +140,23 @@ class JoystickController : public DirectionalController
          *
          */
         int (*analog_read)(unsigned char);
+
+        /**
+         * Maps the smoothed position onto the held direction, -1 if the
+         * stick is in the deadzone or tilted diagonally.
+         */
+        int classify_position(int dx, int dy, long radius_squared);
+
+        InputEventQueue queue;
+
+        /* All positions below are in fixed point, multiplied by
+           STICK_FIXED_POINT_SCALE. */
+        int center_x;
+        int center_y;
+        int filtered_x;
+        int filtered_y;
+
+        bool sample_y_axis;
+        int held_direction;
+        volatile uint8_t magnitude;
 };
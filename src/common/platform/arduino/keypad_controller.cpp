@@ -1,29 +1,39 @@
 #include "keypad_controller.hpp"
 
-bool KeypadController::poll_for_input(Action *input) {
-        int leftButton = this->digital_read(LEFT_BUTTON_PIN);
-        int downButton = this->digital_read(DOWN_BUTTON_PIN);
-        int upButton = this->digital_read(UP_BUTTON_PIN);
-        int rightButton = this->digital_read(RIGHT_BUTTON_PIN);
+bool KeypadController::poll_for_input(Action *input)
+{
+        uint8_t queued_input;
+        if (!queue.poll(&queued_input)) {
+                return false;
+        }
+        *input = (Action)queued_input;
+        return true;
+}
+
+bool KeypadController::poll_event(InputEvent *event)
+{
+        return queue.pop(event);
+}
+
+void KeypadController::setup() {
+}
 
-        if (!leftButton) {
-                *input = Action::BLUE;
-                return true;
+void KeypadController::sample(unsigned long timestamp)
+{
+        // The buttons are active low, each pressed button sets the bit
+        // corresponding to its action.
+        uint8_t state = 0;
+        if (!this->digital_read(LEFT_BUTTON_PIN)) {
+                state |= 1 << Action::BLUE;
         }
-        if (!downButton) {
-                *input = Action::GREEN;
-                return true;
+        if (!this->digital_read(DOWN_BUTTON_PIN)) {
+                state |= 1 << Action::GREEN;
         }
-        if (!upButton) {
-                *input = Action::YELLOW;
-                return true;
+        if (!this->digital_read(UP_BUTTON_PIN)) {
+                state |= 1 << Action::YELLOW;
         }
-        if (!rightButton) {
-                *input = Action::RED;
-                return true;
+        if (!this->digital_read(RIGHT_BUTTON_PIN)) {
+                state |= 1 << Action::RED;
         }
-        return false;
-}
-
-void KeypadController::setup() {
+        queue.record_state(state, timestamp);
 }
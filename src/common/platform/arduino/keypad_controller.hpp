@@ -1,4 +1,5 @@
 #include "../interface/controller.hpp"
+#include "../interface/input_event_queue.hpp"
 
 #define LEFT_BUTTON_PIN 9
 #define DOWN_BUTTON_PIN 15
@@ -9,21 +10,27 @@ class KeypadController : public ActionController
 {
       public:
         /**
-         * For a given controller, this function will inspect its state to
-         * determine if an input is being entered. Note that for physical
-         * controllers, this function only tests for the state of the controller
-         * right now (it doesn't poll for a period of time). Becuase of this,
-         * this function should be called in a loop if we want the system to
-         * wait for the user to provide input.
+         * Returns the next input from the event queue filled in by `sample`,
+         * see `InputEventQueue::poll`. Presses that happen while the game is
+         * busy (e.g. rendering) are queued and returned once the game polls
+         * for input again, one per call. Because of this, this function
+         * should be called in a loop if we want the system to wait for the
+         * user to provide input.
          *
-         * If an input is registered, it will be written into the `Direction
+         * If an input is registered, it will be written into the `Action
          * *input` parameter and `true` will be returned.
          *
          * If no input is registered, this function returns false and the
-         * direction pointer remains unchanged.
+         * input pointer remains unchanged.
          */
         bool poll_for_input(Action *input) override;
 
+        /**
+         * Returns the next press or release recorded by `sample`, together
+         * with the time at which it was sampled.
+         */
+        bool poll_event(InputEvent *event) override;
+
         /**
          * Setup function used for e.g. initializing pins of the controller.
          * This is to be called only once inside of the `setup` Arduino
@@ -37,6 +44,14 @@ class KeypadController : public ActionController
          */
         void setup() override;
 
+        /**
+         * Reads the current state of the buttons and queues an event for
+         * each input that was pressed or released since the previous sample.
+         * It is called periodically from the input sampling timer interrupt,
+         * which is the only producer of the event queue.
+         */
+        void sample(unsigned long timestamp);
+
         KeypadController(int (*digital_read_)(unsigned char))
             : digital_read(digital_read_)
         {
@@ -53,4 +68,6 @@ class KeypadController : public ActionController
          *
          */
         int (*digital_read)(unsigned char);
+
+        InputEventQueue queue;
 };
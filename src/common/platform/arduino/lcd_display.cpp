@@ -1,3 +1,5 @@
+#include <string.h>
+
 #include "lcd_display.hpp"
 #include "../../../lib/GUI_Paint.h"
 #include "../../../lib/LCD_Driver.h"
@@ -171,6 +173,74 @@ void LcdDisplay::clear_region(Point top_left, Point bottom_right,
                            bottom_right.y, clear_color);
 };
 
+void LcdDisplay::rasterize_string(char *string_buffer, FontSize font_size,
+                                  uint8_t *mask, int width, int height)
+{
+        sFONT *font = map_font_size(font_size);
+        int mask_stride = (width + 7) / 8;
+        int font_stride = font->Width / 8 + (font->Width % 8 ? 1 : 0);
+        memset(mask, 0, mask_stride * height);
+
+        int x_offset = 0;
+        for (char *c = string_buffer; *c != '\0'; c++) {
+                uint32_t char_offset = (*c - ' ') * font->Height * font_stride;
+                const unsigned char *glyph = &font->table[char_offset];
+                for (int row = 0; row < font->Height && row < height; row++) {
+                        for (int col = 0; col < font->Width; col++) {
+                                int x = x_offset + col;
+                                if (x >= width) {
+                                        break;
+                                }
+                                uint8_t font_byte = pgm_read_byte(
+                                    glyph + row * font_stride + col / 8);
+                                if (font_byte & (0x80 >> (col % 8))) {
+                                        mask[row * mask_stride + x / 8] |=
+                                            0x80 >> (x % 8);
+                                }
+                        }
+                }
+                x_offset += font->Width;
+        }
+}
+
+void LcdDisplay::draw_bitmap(Point start, int width, int height,
+                             const uint8_t *mask, Color bg_color,
+                             Color fg_color)
+{
+        int stride = (width + 7) / 8;
+        auto pixel_color = [&](int x, int y) {
+                return mask[y * stride + x / 8] & (0x80 >> (x % 8)) ? fg_color
+                                                                    : bg_color;
+        };
+
+        // The fast path below relies on the rotation that is set up in
+        // `initialize`, for any other rotation we fall back to drawing the
+        // bitmap pixel by pixel.
+        if (Paint.Rotate != ROTATE_270 || Paint.Mirror != MIRROR_NONE) {
+                for (int y = 0; y < height; y++) {
+                        for (int x = 0; x < width; x++) {
+                                Paint_SetPixel(start.x + x, start.y + y,
+                                               pixel_color(x, y));
+                        }
+                }
+                return;
+        }
+
+        // With the display rotated by 270 degrees, the screen point (x, y)
+        // maps to the memory point (y, HeightMemory - x - 1). The driver
+        // fills the window along the memory x axis first, so we stream the
+        // bitmap column by column starting from its rightmost column.
+        int memory_x = start.y;
+        int memory_y = Paint.HeightMemory - (start.x + width);
+        LCD_SetCursor(memory_x, memory_y, memory_x + height - 1,
+                      memory_y + width - 1);
+        for (int x = width - 1; x >= 0; x--) {
+                for (int y = 0; y < height; y++) {
+                        LCD_WriteData_Word(pixel_color(x, y));
+                }
+        }
+}
+
 sFONT *map_font_size(FontSize font_size)
 {
         switch (font_size) {
@@ -74,6 +74,24 @@ class LcdDisplay : public Display
         virtual void clear_region(Point top_left, Point bottom_right,
                                   Color clear_color) override;
 
+        /**
+         * Rasterizes a string into a 1-bit-per-pixel mask of the given
+         * dimensions. Rows of the mask are padded to full bytes and the most
+         * significant bit comes first. Set bits correspond to the foreground
+         * of the text.
+         */
+        virtual void rasterize_string(char *string_buffer, FontSize font_size,
+                                      uint8_t *mask, int width,
+                                      int height) override;
+
+        /**
+         * Draws a 1-bit-per-pixel mask (in the layout produced by
+         * `rasterize_string`) using the two specified colors.
+         */
+        virtual void draw_bitmap(Point start, int width, int height,
+                                 const uint8_t *mask, Color bg_color,
+                                 Color fg_color) override;
+
         /**
          * Returns the height of the display.
          */
@@ -10,5 +10,18 @@ class EmulatorDelay : public DelayProvider
         {
                 std::this_thread::sleep_for(std::chrono::milliseconds(ms));
         }
+
+        unsigned long get_time_ms() override
+        {
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                return std::chrono::duration_cast<std::chrono::milliseconds>(
+                           elapsed)
+                    .count();
+        }
+
+        /// Point in time when the emulator was started, this mimics the
+        /// Arduino `millis` function that counts from the board startup.
+        std::chrono::steady_clock::time_point start =
+            std::chrono::steady_clock::now();
 };
 #endif
@@ -0,0 +1,22 @@
+#pragma once
+#ifdef EMULATOR
+/**
+ * File holding the EEPROM image of the emulator if no other path is given on
+ * the command line.
+ */
+#define PERSISTENT_STORAGE_FILE "persistent_storage.bin"
+/**
+ * Size of the EEPROM image, it matches the 8 kB data flash of the UNO R4 so
+ * the settings layout that fits on the device also fits here.
+ */
+#define PERSISTENT_STORAGE_SIZE 8192
+/**
+ * The modified pages are written back at most this often while the console
+ * is running, and once more when the storage is destroyed on exit.
+ */
+#define PERSISTENT_STORAGE_FLUSH_INTERVAL_MS 1000
+
+// The constants above are used by the implementation included at the end of
+// the interface header, so they need to be defined first.
+#include "../interface/persistent_storage.hpp"
+#endif
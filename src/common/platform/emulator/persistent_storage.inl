@@ -1,64 +1,140 @@
 #ifdef EMULATOR
-#include <fstream>
+#include "persistent_storage.hpp"
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
 #include <iostream>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-template <typename T> T &PersistentStorage::get(int offset, T &t)
+/*
+ * The emulator keeps the EEPROM image in a file that is mapped into memory
+ * once when the storage is created. The reads and writes are then plain
+ * memory copies, so loading and saving the settings doesn't touch the file
+ * system while the games are running. The mapping is shared, so the written
+ * bytes land in the page cache right away; the periodic and final flushes
+ * only make sure that they reach the disk.
+ */
+
+inline unsigned long persistent_storage_time_ms()
 {
-        std::ifstream ifs("persistent_storage.bin", std::ios::binary);
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+}
 
-        if (!ifs) {
-                std::cerr << "Error opening file for reading." << std::endl;
-                return t; // Return the original object if file opening fails
+inline PersistentStorage::PersistentStorage(const char *path)
+    : image(NULL), fd(-1), dirty_start(0), dirty_end(0),
+      last_flush_ms(persistent_storage_time_ms())
+{
+        fd = open(path, O_RDWR | O_CREAT, 0644);
+        struct stat file_stat;
+        if (fd >= 0 && fstat(fd, &file_stat) == 0 &&
+            file_stat.st_size < PERSISTENT_STORAGE_SIZE) {
+                // The image is allocated upfront so that writing to the
+                // mapping can't fail later on due to a full disk. Not all file
+                // systems support it, extending the file is enough there.
+                if (posix_fallocate(fd, 0, PERSISTENT_STORAGE_SIZE) != 0 &&
+                    ftruncate(fd, PERSISTENT_STORAGE_SIZE) != 0) {
+                        close(fd);
+                        fd = -1;
+                }
         }
-        ifs.seekg(0, std::ios::end);
-        std::streamsize file_size = ifs.tellg();
+        if (fd >= 0) {
+                void *mapping = mmap(NULL, PERSISTENT_STORAGE_SIZE,
+                                     PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (mapping == MAP_FAILED) {
+                        close(fd);
+                        fd = -1;
+                } else {
+                        image = (uint8_t *)mapping;
+                }
+        }
+        if (fd < 0) {
+                // The console still works without the file, the settings
+                // just aren't kept after it exits.
+                std::cerr << "Unable to map " << path << ": " << strerror(errno)
+                          << ", the settings will not be saved." << std::endl;
+                image = (uint8_t *)calloc(PERSISTENT_STORAGE_SIZE, 1);
+        }
+}
 
-        if (file_size < offset) {
-                std::cerr << "File too small: " << file_size
-                          << ", returning default" << std::endl;
-                return t;
+inline PersistentStorage::~PersistentStorage()
+{
+        if (fd < 0) {
+                free(image);
+                return;
         }
+        flush();
+        munmap(image, PERSISTENT_STORAGE_SIZE);
+        close(fd);
+}
 
-        ifs.seekg(offset);
-        ifs.read(reinterpret_cast<char *>(&t), sizeof(T));
-        ifs.close();
+inline void PersistentStorage::flush() { write_back(MS_SYNC); }
 
-        return t;
+inline void PersistentStorage::write_back(int flags)
+{
+        if (dirty_start == dirty_end) {
+                return;
+        }
+        if (fd >= 0) {
+                // The synced range needs to start at a page boundary.
+                long page_size = sysconf(_SC_PAGESIZE);
+                int start = dirty_start - dirty_start % page_size;
+                msync(image + start, dirty_end - start, flags);
+        }
+        dirty_start = 0;
+        dirty_end = 0;
+        last_flush_ms = persistent_storage_time_ms();
 }
 
-template <typename T> const T &PersistentStorage::put(int offset, const T &t)
+inline bool PersistentStorage::in_bounds(int offset, int size)
 {
-        std::fstream ofs;
-        // We need to specify both in and out to avoid having the truncate setting
-        // clear the file before writing to it.
-        ofs = std::fstream("persistent_storage.bin",
-                         std::ios::in | std::ios::out | std::ios::binary);
-
-        if (!ofs) {
-                std::cerr << "Error opening file for writing in append mode. falling back to write only mode" << std::endl;
-                ofs = std::fstream("persistent_storage.bin",
-                         std::ios::out | std::ios::binary);
+        if (offset >= 0 && size <= PERSISTENT_STORAGE_SIZE &&
+            offset <= PERSISTENT_STORAGE_SIZE - size) {
+                return true;
         }
+        std::cerr << "Persistent storage access out of bounds: offset "
+                  << offset << ", size " << size << std::endl;
+        return false;
+}
 
-        if (!ofs) {
-                std::cerr << "Error opening file for writing." << std::endl;
-                return t; // Return the original object if file opening fails
+inline void PersistentStorage::mark_dirty(int offset, int size)
+{
+        if (dirty_start == dirty_end) {
+                dirty_start = offset;
+                dirty_end = offset + size;
+        } else {
+                dirty_start = offset < dirty_start ? offset : dirty_start;
+                dirty_end =
+                    offset + size > dirty_end ? offset + size : dirty_end;
         }
+        // The asynchronous write back only schedules the pages to be written,
+        // so it doesn't stall the game.
+        if (persistent_storage_time_ms() - last_flush_ms >=
+            PERSISTENT_STORAGE_FLUSH_INTERVAL_MS) {
+                write_back(MS_ASYNC);
+        }
+}
 
-        ofs.seekp(0, std::ios::end);
-        std::streamsize file_size_before = ofs.tellp();
-        std::cout << "File size before writing: " << file_size_before
-                  << std::endl;
-
-        std::cout << "Writing to persistent storage at offset: " << offset
-                  << std::endl;
-        ofs.seekp(offset, std::ios::beg);
-        ofs.write(reinterpret_cast<const char *>(&t), sizeof(T));
+template <typename T> T &PersistentStorage::get(int offset, T &t)
+{
+        if (in_bounds(offset, sizeof(T))) {
+                memcpy(reinterpret_cast<void *>(&t), image + offset, sizeof(T));
+        }
+        return t;
+}
 
-        ofs.seekp(0, std::ios::end);
-        std::streamsize file_size = ofs.tellp();
-        std::cout << "File size after writing: " << file_size << std::endl;
-        ofs.close();
+template <typename T> const T &PersistentStorage::put(int offset, const T &t)
+{
+        if (in_bounds(offset, sizeof(T))) {
+                memcpy(image + offset, reinterpret_cast<const void *>(&t),
+                       sizeof(T));
+                mark_dirty(offset, sizeof(T));
+        }
         return t;
 }
 #endif
@@ -3,24 +3,29 @@
 #include "sfml_action_controller.hpp"
 #include <SFML/Graphics.hpp>
 
+/**
+ * The Y, R, G and B keys, indexed by the value of the `Action` enum.
+ */
+static const sf::Keyboard::Key ACTION_KEYS[4] = {
+    sf::Keyboard::Key::Y, sf::Keyboard::Key::R,
+    sf::Keyboard::Key::G, sf::Keyboard::Key::B};
+
+SfmlActionInputController::SfmlActionInputController(SfmlEventPump *event_pump)
+    : source(event_pump, ACTION_KEYS)
+{
+}
+
 bool SfmlActionInputController::poll_for_input(Action *input) {
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::R)) {
-    *input = Action::RED;
-    return true;
-  }
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::G)) {
-    *input = Action::GREEN;
-    return true;
-  }
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::B)) {
-    *input = Action::BLUE;
-    return true;
+  uint8_t key_input;
+  if (!source.poll(&key_input)) {
+    return false;
   }
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Y)) {
-    *input = Action::YELLOW;
-    return true;
-  }
-  return false;
+  *input = (Action)key_input;
+  return true;
+};
+
+bool SfmlActionInputController::poll_event(InputEvent *event) {
+  return source.poll_event(event);
 };
 
 void SfmlActionInputController::setup() {};
@@ -3,24 +3,29 @@
 #include "sfml_awsd_controller.hpp"
 #include <SFML/Graphics.hpp>
 
+/**
+ * The W, A, S and D keys, indexed by the value of the `Direction` enum.
+ */
+static const sf::Keyboard::Key AWSD_KEYS[4] = {
+    sf::Keyboard::Key::W, sf::Keyboard::Key::D,
+    sf::Keyboard::Key::S, sf::Keyboard::Key::A};
+
+SfmlAwsdInputController::SfmlAwsdInputController(SfmlEventPump *event_pump)
+    : source(event_pump, AWSD_KEYS)
+{
+}
+
 bool SfmlAwsdInputController::poll_for_input(Direction *input) {
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) {
-    *input = Direction::LEFT;
-    return true;
-  }
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) {
-    *input = Direction::RIGHT;
-    return true;
-  }
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W)) {
-    *input = Direction::UP;
-    return true;
+  uint8_t key_input;
+  if (!source.poll(&key_input)) {
+    return false;
   }
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::S)) {
-    *input = Direction::DOWN;
-    return true;
-  }
-  return false;
+  *input = (Direction)key_input;
+  return true;
+};
+
+bool SfmlAwsdInputController::poll_event(InputEvent *event) {
+  return source.poll_event(event);
 };
 
 void SfmlAwsdInputController::setup() {};
@@ -1,16 +1,17 @@
 #ifdef EMULATOR
 #include "../interface/controller.hpp"
+#include "sfml_event_pump.hpp"
 
 class SfmlAwsdInputController : public DirectionalController
 {
       public:
         /**
          * For a given controllers, this function will inspect its state to
-         * determine if an input is being entered. Note that for physical
-         * controllers, this function only tests for the state of the controller
-         * right now (it doesn't poll for a period of time). Becuase of this,
-         * this function should be called in a loop if we want the system to
-         * wait for the user to provide input.
+         * determine if an input is being entered. The key events are
+         * queued as they arrive from the window, so the presses that happen
+         * while the game is busy rendering are not lost. This function
+         * returns a single input per call and so it should be called in a
+         * loop if we want the system to wait for the user to provide input.
          *
          * If an input is registered, it will be written into the `Direction
          * *input` parameter and `true` will be returned.
@@ -20,6 +21,12 @@ class SfmlAwsdInputController : public DirectionalController
          */
         bool poll_for_input(Direction *input) override;
 
+        /**
+         * Returns the next key press or release, timestamped when the event
+         * was received from the window.
+         */
+        bool poll_event(InputEvent *event) override;
+
         /**
          * Setup function used for e.g. initializing pins of the controller.
          * This is to be called only once inside of the `setup` Arduino
@@ -32,5 +39,10 @@ class SfmlAwsdInputController : public DirectionalController
          * possible to infer which function to call).
          */
         void setup() override;
+
+        SfmlAwsdInputController(SfmlEventPump *event_pump);
+
+      private:
+        SfmlKeyInputSource source;
 };
 #endif
@@ -3,24 +3,29 @@
 #include "sfml_controller.hpp"
 #include <SFML/Graphics.hpp>
 
+/**
+ * The arrow keys, indexed by the value of the `Direction` enum.
+ */
+static const sf::Keyboard::Key ARROW_KEYS[4] = {
+    sf::Keyboard::Key::Up, sf::Keyboard::Key::Right,
+    sf::Keyboard::Key::Down, sf::Keyboard::Key::Left};
+
+SfmlInputController::SfmlInputController(SfmlEventPump *event_pump)
+    : source(event_pump, ARROW_KEYS)
+{
+}
+
 bool SfmlInputController::poll_for_input(Direction *input) {
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left)) {
-    *input = Direction::LEFT;
-    return true;
-  }
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right)) {
-    *input = Direction::RIGHT;
-    return true;
-  }
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Up)) {
-    *input = Direction::UP;
-    return true;
+  uint8_t key_input;
+  if (!source.poll(&key_input)) {
+    return false;
   }
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Down)) {
-    *input = Direction::DOWN;
-    return true;
-  }
-  return false;
+  *input = (Direction)key_input;
+  return true;
+};
+
+bool SfmlInputController::poll_event(InputEvent *event) {
+  return source.poll_event(event);
 };
 
 void SfmlInputController::setup() {};
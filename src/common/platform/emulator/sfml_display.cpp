@@ -2,6 +2,7 @@
 #ifdef EMULATOR
 #include "sfml_display.hpp"
 #include <SFML/Graphics.hpp>
+#include <cstring>
 #include "../../constants.hpp"
 
 // TODO: move those defines to common constants so that changes to them affect
@@ -221,6 +222,60 @@ void SfmlDisplay::clear_region(Point top_left, Point bottom_right,
                        bottom_right.y - top_left.y, clear_color, 0, true);
 };
 
+void SfmlDisplay::rasterize_string(char *string_buffer, FontSize font_size,
+                                   uint8_t *mask, int width, int height)
+{
+        int stride = (width + 7) / 8;
+        memset(mask, 0, stride * height);
+
+        // We render the text off-screen in the same way as `draw_string`
+        // does and then threshold the resulting pixels to get the mask.
+        sf::RenderTexture canvas({(unsigned int)width, (unsigned int)height});
+        canvas.clear(sf::Color::Black);
+        const sf::Font font = get_emulator_font();
+        sf::Text text(font, string_buffer, font_size);
+        text.setFillColor(sf::Color::White);
+        canvas.draw(text);
+        canvas.display();
+
+        sf::Image image = canvas.getTexture().copyToImage();
+        for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                        sf::Color pixel = image.getPixel(
+                            {(unsigned int)x, (unsigned int)y});
+                        if (pixel.r >= 128) {
+                                mask[y * stride + x / 8] |= 0x80 >> (x % 8);
+                        }
+                }
+        }
+}
+
+void SfmlDisplay::draw_bitmap(Point start, int width, int height,
+                              const uint8_t *mask, Color bg_color,
+                              Color fg_color)
+{
+        int stride = (width + 7) / 8;
+        sf::Color bg = map_to_sf_color(bg_color);
+        sf::Color fg = map_to_sf_color(fg_color);
+
+        sf::Image image({(unsigned int)width, (unsigned int)height}, bg);
+        for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                        if (mask[y * stride + x / 8] & (0x80 >> (x % 8))) {
+                                image.setPixel(
+                                    {(unsigned int)x, (unsigned int)y}, fg);
+                        }
+                }
+        }
+
+        sf::Texture bitmap(image);
+        sf::Sprite sprite(bitmap);
+        sprite.setPosition({(float)start.x, (float)start.y});
+        texture->draw(sprite);
+        texture->display();
+        refresh();
+}
+
 int SfmlDisplay::get_height() { return DISPLAY_HEIGHT; }
 
 int SfmlDisplay::get_width() { return DISPLAY_WIDTH; }
@@ -229,18 +284,10 @@ int SfmlDisplay::get_display_corner_radius() { return 40; };
 
 void SfmlDisplay::refresh()
 {
-        /* We need this polling when refreshign the display. Without it, linux
-        desktop environments (e.g. gnome) think that the game window is not
-        responsive and try to get us to force-close it. */
-        while (const std::optional event = window->pollEvent()) {
-                if (event->is<sf::Event::Closed>()) {
-                        window->close();
-                        // This is the only way we can terminate the game loop
-                        // in the current setup, we need to send an exception
-                        // and catch it in the emulator entrypoint.
-                        throw std::runtime_error("Window closed");
-                }
-        }
+        /* We need to process the window events when refreshing the display.
+        Without it, linux desktop environments (e.g. gnome) think that the game
+        window is not responsive and try to get us to force-close it. */
+        event_pump->pump();
 
         // Now we start rendering to the window, clear it first
         // texture->display();
@@ -1,6 +1,7 @@
 #ifdef EMULATOR
 #pragma once
 #include "../interface/display.hpp"
+#include "sfml_event_pump.hpp"
 #include <SFML/Graphics.hpp>
 
 /**
@@ -74,6 +75,24 @@ class SfmlDisplay : public Display
         virtual void clear_region(Point top_left, Point bottom_right,
                                   Color clear_color) override;
 
+        /**
+         * Rasterizes a string into a 1-bit-per-pixel mask of the given
+         * dimensions. Rows of the mask are padded to full bytes and the most
+         * significant bit comes first. Set bits correspond to the foreground
+         * of the text.
+         */
+        virtual void rasterize_string(char *string_buffer, FontSize font_size,
+                                      uint8_t *mask, int width,
+                                      int height) override;
+
+        /**
+         * Draws a 1-bit-per-pixel mask (in the layout produced by
+         * `rasterize_string`) using the two specified colors.
+         */
+        virtual void draw_bitmap(Point start, int width, int height,
+                                 const uint8_t *mask, Color bg_color,
+                                 Color fg_color) override;
+
         /**
          * Returns the height of the display.
          */
@@ -99,13 +118,15 @@ class SfmlDisplay : public Display
          */
         virtual void refresh() override;
 
-        SfmlDisplay(sf::RenderWindow *window, sf::RenderTexture *texture)
-            : window(window), texture(texture)
+        SfmlDisplay(sf::RenderWindow *window, sf::RenderTexture *texture,
+                    SfmlEventPump *event_pump)
+            : window(window), texture(texture), event_pump(event_pump)
         {
         }
 
       private:
         sf::RenderWindow *window;
         sf::RenderTexture *texture;
+        SfmlEventPump *event_pump;
 };
 #endif
@@ -0,0 +1,96 @@
+// We use SFML only if running under the emulator
+#ifdef EMULATOR
+#include "sfml_event_pump.hpp"
+#include <stdexcept>
+
+SfmlEventPump::SfmlEventPump(sf::RenderWindow *window, DelayProvider *clock)
+    : window(window), clock(clock)
+{
+        // Holding a key must not flood the queues with repeated presses, the
+        // held keys are reported by the queues themselves.
+        window->setKeyRepeatEnabled(false);
+}
+
+void SfmlEventPump::add_listener(SfmlKeyListener *listener)
+{
+        listeners.push_back(listener);
+}
+
+void SfmlEventPump::pump()
+{
+        /* We need this polling even when no input is expected. Without it,
+        linux desktop environments (e.g. gnome) think that the game window is
+        not responsive and try to get us to force-close it. */
+        while (const std::optional event = window->pollEvent()) {
+                if (event->is<sf::Event::Closed>()) {
+                        window->close();
+                        // This is the only way we can terminate the game loop
+                        // in the current setup, we need to send an exception
+                        // and catch it in the emulator entrypoint.
+                        throw std::runtime_error("Window closed");
+                }
+                unsigned long now = clock->get_time_ms();
+                if (event->is<sf::Event::FocusLost>()) {
+                        for (SfmlKeyListener *listener : listeners) {
+                                listener->on_focus_lost(now);
+                        }
+                        continue;
+                }
+                const auto *pressed = event->getIf<sf::Event::KeyPressed>();
+                const auto *released = event->getIf<sf::Event::KeyReleased>();
+                if (!pressed && !released) {
+                        continue;
+                }
+                sf::Keyboard::Key key =
+                    pressed ? pressed->code : released->code;
+                for (SfmlKeyListener *listener : listeners) {
+                        listener->on_key_event(key, pressed != nullptr,
+                                               now);
+                }
+        }
+}
+
+SfmlKeyInputSource::SfmlKeyInputSource(SfmlEventPump *event_pump,
+                                       const sf::Keyboard::Key (&keys)[4])
+    : event_pump(event_pump), key_state(0)
+{
+        for (int i = 0; i < 4; i++) {
+                this->keys[i] = keys[i];
+        }
+        event_pump->add_listener(this);
+}
+
+void SfmlKeyInputSource::on_key_event(sf::Keyboard::Key key, bool pressed,
+                                      unsigned long timestamp)
+{
+        for (int i = 0; i < 4; i++) {
+                if (keys[i] != key) {
+                        continue;
+                }
+                if (pressed) {
+                        key_state |= 1 << i;
+                } else {
+                        key_state &= ~(1 << i);
+                }
+                queue.record_state(key_state, timestamp);
+        }
+}
+
+void SfmlKeyInputSource::on_focus_lost(unsigned long timestamp)
+{
+        key_state = 0;
+        queue.record_state(key_state, timestamp);
+}
+
+bool SfmlKeyInputSource::poll(uint8_t *input)
+{
+        event_pump->pump();
+        return queue.poll(input);
+}
+
+bool SfmlKeyInputSource::poll_event(InputEvent *event)
+{
+        event_pump->pump();
+        return queue.pop(event);
+}
+#endif
@@ -0,0 +1,84 @@
+#ifdef EMULATOR
+#pragma once
+#include "../interface/delay.hpp"
+#include "../interface/input_event_queue.hpp"
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+/**
+ * Receives the keyboard events of the emulator window.
+ */
+class SfmlKeyListener
+{
+      public:
+        virtual ~SfmlKeyListener() = default;
+
+        virtual void on_key_event(sf::Keyboard::Key key, bool pressed,
+                                  unsigned long timestamp) = 0;
+        /**
+         * Called when the window loses focus, after that the key release
+         * events are no longer delivered so all keys need to be released.
+         */
+        virtual void on_focus_lost(unsigned long timestamp) = 0;
+};
+
+/**
+ * Owns the event loop of the emulator window. The events are processed both
+ * when the display is refreshed and when the controllers are polled, so the
+ * key presses are picked up even if the game isn't drawing anything.
+ *
+ * This is the emulator counterpart of the input sampling interrupt on the
+ * Arduino: it is the only producer feeding the input event queues of the
+ * controllers.
+ */
+class SfmlEventPump
+{
+      public:
+        SfmlEventPump(sf::RenderWindow *window, DelayProvider *clock);
+
+        void add_listener(SfmlKeyListener *listener);
+        /**
+         * Processes all pending window events. Throws `std::runtime_error`
+         * if the window was closed as this is the only way to terminate the
+         * game loop in the current setup.
+         */
+        void pump();
+
+      private:
+        sf::RenderWindow *window;
+        DelayProvider *clock;
+        std::vector<SfmlKeyListener *> listeners;
+};
+
+/**
+ * Translates the key events into the input event queue of a controller. The
+ * four keys are indexed by the value of the `Direction` or `Action` enum that
+ * they map to.
+ */
+class SfmlKeyInputSource : public SfmlKeyListener
+{
+      public:
+        SfmlKeyInputSource(SfmlEventPump *event_pump,
+                           const sf::Keyboard::Key (&keys)[4]);
+
+        void on_key_event(sf::Keyboard::Key key, bool pressed,
+                          unsigned long timestamp) override;
+        void on_focus_lost(unsigned long timestamp) override;
+
+        /**
+         * Pumps the window events and returns the next input from the queue,
+         * see `InputEventQueue::poll`.
+         */
+        bool poll(uint8_t *input);
+        /**
+         * Pumps the window events and pops the next event from the queue.
+         */
+        bool poll_event(InputEvent *event);
+
+      private:
+        SfmlEventPump *event_pump;
+        sf::Keyboard::Key keys[4];
+        uint8_t key_state;
+        InputEventQueue queue;
+};
+#endif
@@ -3,24 +3,29 @@
 #include "sfml_hjkl_controller.hpp"
 #include <SFML/Graphics.hpp>
 
+/**
+ * The vim H, J, K and L keys, indexed by the value of the `Direction` enum.
+ */
+static const sf::Keyboard::Key HJKL_KEYS[4] = {
+    sf::Keyboard::Key::K, sf::Keyboard::Key::L,
+    sf::Keyboard::Key::J, sf::Keyboard::Key::H};
+
+SfmlHjklInputController::SfmlHjklInputController(SfmlEventPump *event_pump)
+    : source(event_pump, HJKL_KEYS)
+{
+}
+
 bool SfmlHjklInputController::poll_for_input(Direction *input) {
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::H)) {
-    *input = Direction::LEFT;
-    return true;
-  }
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::L)) {
-    *input = Direction::RIGHT;
-    return true;
-  }
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::K)) {
-    *input = Direction::UP;
-    return true;
+  uint8_t key_input;
+  if (!source.poll(&key_input)) {
+    return false;
   }
-  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::J)) {
-    *input = Direction::DOWN;
-    return true;
-  }
-  return false;
+  *input = (Direction)key_input;
+  return true;
+};
+
+bool SfmlHjklInputController::poll_event(InputEvent *event) {
+  return source.poll_event(event);
 };
 
 void SfmlHjklInputController::setup() {};
@@ -0,0 +1,283 @@
+#ifdef EMULATOR
+#include "headless_display.hpp"
+#include "../../constants.hpp"
+#include <cstring>
+#include <fstream>
+
+#define SCREEN_BORDER_WIDTH 3
+#define SCREEN_BORDER_LINE_WIDTH 3
+
+HeadlessDisplay::HeadlessDisplay(int width, int height, int corner_radius)
+    : width(width), height(height), corner_radius(corner_radius)
+{
+        framebuffer = new uint16_t[width * height];
+        memset(framebuffer, 0, width * height * sizeof(uint16_t));
+        stats = {.primitives = 0, .strings = 0, .bitmaps = 0, .pixels = 0};
+}
+
+HeadlessDisplay::~HeadlessDisplay() { delete[] framebuffer; }
+
+void HeadlessDisplay::setup() {}
+
+void HeadlessDisplay::initialize() {}
+
+void HeadlessDisplay::clear(Color color)
+{
+        stats.primitives++;
+        fill_rectangle(0, 0, width, height, color);
+}
+
+/**
+ * Draws the border as the difference between two rounded rectangles instead
+ * of replicating the sequence of circles and lines that the LCD display uses.
+ * The resulting shape is the same, but it is much simpler to get right when
+ * we have direct access to the pixels.
+ */
+void HeadlessDisplay::draw_rounded_border(Color color)
+{
+        clear(Black);
+        stats.primitives++;
+
+        int margin = SCREEN_BORDER_WIDTH;
+        int line_width = SCREEN_BORDER_LINE_WIDTH;
+        int outer_width = width - 2 * margin;
+        int outer_height = height - 2 * margin;
+        for (int y = margin; y < height - margin; y++) {
+                for (int x = margin; x < width - margin; x++) {
+                        bool outer = is_inside_rounded_rectangle(
+                            x, y, margin, margin, outer_width, outer_height,
+                            corner_radius);
+                        bool inner = is_inside_rounded_rectangle(
+                            x, y, margin + line_width, margin + line_width,
+                            outer_width - 2 * line_width,
+                            outer_height - 2 * line_width,
+                            corner_radius - line_width);
+                        if (outer && !inner) {
+                                fill(x, y, color);
+                        }
+                }
+        }
+}
+
+/**
+ * Follows the semantics of the SFML display: the border is drawn outside of
+ * the circle and the interior of a circle that isn't filled is cleared.
+ */
+void HeadlessDisplay::draw_circle(Point center, int radius, Color color,
+                                  int border_width, bool filled)
+{
+        stats.primitives++;
+        int outer_radius = radius + border_width;
+        for (int dy = -outer_radius; dy <= outer_radius; dy++) {
+                for (int dx = -outer_radius; dx <= outer_radius; dx++) {
+                        int distance = dx * dx + dy * dy;
+                        if (distance > outer_radius * outer_radius) {
+                                continue;
+                        }
+                        bool interior = distance < radius * radius;
+                        fill(center.x + dx, center.y + dy,
+                             interior && !filled ? Black : color);
+                }
+        }
+}
+
+void HeadlessDisplay::draw_rectangle(Point start, int width, int height,
+                                     Color color, int border_width,
+                                     bool filled)
+{
+        stats.primitives++;
+        int x_end = start.x + width;
+        int y_end = start.y + height;
+        if (filled) {
+                fill_rectangle(start.x - border_width, start.y - border_width,
+                               x_end + border_width, y_end + border_width,
+                               color);
+                return;
+        }
+        if (border_width == 0) {
+                return;
+        }
+        // The border is drawn outside of the rectangle, top and bottom edges
+        // span the full width, the side edges fill in the space between them.
+        fill_rectangle(start.x - border_width, start.y - border_width,
+                       x_end + border_width, start.y, color);
+        fill_rectangle(start.x - border_width, y_end, x_end + border_width,
+                       y_end + border_width, color);
+        fill_rectangle(start.x - border_width, start.y, start.x, y_end, color);
+        fill_rectangle(x_end, start.y, x_end + border_width, y_end, color);
+}
+
+void HeadlessDisplay::draw_rounded_rectangle(Point start, int width,
+                                             int height, int radius,
+                                             Color color)
+{
+        stats.primitives++;
+        for (int y = start.y; y <= start.y + height; y++) {
+                for (int x = start.x; x <= start.x + width; x++) {
+                        if (is_inside_rounded_rectangle(x, y, start.x, start.y,
+                                                        width + 1, height + 1,
+                                                        radius)) {
+                                fill(x, y, color);
+                        }
+                }
+        }
+}
+
+/**
+ * Follows the semantics of the SFML display: only the glyphs are drawn, the
+ * space around them keeps its current contents, so the background color is
+ * ignored.
+ */
+void HeadlessDisplay::draw_string(Point start, char *string_buffer,
+                                  FontSize font_size, Color /* bg_color */,
+                                  Color fg_color)
+{
+        stats.strings++;
+        int glyph_width = get_glyph_width(font_size);
+        int x = start.x;
+        int y = start.y;
+        for (char *c = string_buffer; *c; c++) {
+                if (*c == '\n') {
+                        x = start.x;
+                        y += font_size;
+                        continue;
+                }
+                if (*c != ' ') {
+                        fill_rectangle(x + 1, y + font_size / 4,
+                                       x + glyph_width - 1, y + font_size,
+                                       fg_color);
+                }
+                x += glyph_width;
+        }
+}
+
+void HeadlessDisplay::clear_region(Point top_left, Point bottom_right,
+                                   Color clear_color)
+{
+        stats.primitives++;
+        fill_rectangle(top_left.x, top_left.y, bottom_right.x, bottom_right.y,
+                       clear_color);
+}
+
+void HeadlessDisplay::rasterize_string(char *string_buffer,
+                                       FontSize font_size, uint8_t *mask,
+                                       int width, int height)
+{
+        int stride = (width + 7) / 8;
+        memset(mask, 0, stride * height);
+
+        int glyph_width = get_glyph_width(font_size);
+        int y_end = font_size < height ? font_size : height;
+        int position = 0;
+        for (char *c = string_buffer; *c; c++, position++) {
+                if (*c == ' ') {
+                        continue;
+                }
+                int x_start = position * glyph_width + 1;
+                int x_end = x_start + glyph_width - 2;
+                for (int y = font_size / 4; y < y_end; y++) {
+                        for (int x = x_start; x < x_end && x < width; x++) {
+                                mask[y * stride + x / 8] |= 0x80 >> (x % 8);
+                        }
+                }
+        }
+}
+
+void HeadlessDisplay::draw_bitmap(Point start, int width, int height,
+                                  const uint8_t *mask, Color bg_color,
+                                  Color fg_color)
+{
+        stats.bitmaps++;
+        int stride = (width + 7) / 8;
+        for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                        bool set = mask[y * stride + x / 8] & (0x80 >> (x % 8));
+                        fill(start.x + x, start.y + y,
+                             set ? fg_color : bg_color);
+                }
+        }
+}
+
+uint64_t HeadlessDisplay::checksum()
+{
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        const uint8_t *bytes = (const uint8_t *)framebuffer;
+        for (int i = 0; i < width * height * (int)sizeof(uint16_t); i++) {
+                hash ^= bytes[i];
+                hash *= 0x100000001b3ULL;
+        }
+        return hash;
+}
+
+bool HeadlessDisplay::save_ppm(const char *path)
+{
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        if (!ofs) {
+                return false;
+        }
+        ofs << "P6\n" << width << " " << height << "\n255\n";
+        for (int i = 0; i < width * height; i++) {
+                uint16_t pixel = framebuffer[i];
+                // Expand the RGB565 channels to 8 bits each.
+                char rgb[3] = {(char)(((pixel >> 11) & 0x1F) << 3),
+                               (char)(((pixel >> 5) & 0x3F) << 2),
+                               (char)((pixel & 0x1F) << 3)};
+                ofs.write(rgb, 3);
+        }
+        return ofs.good();
+}
+
+void HeadlessDisplay::fill(int x, int y, Color color)
+{
+        if (x < 0 || x >= width || y < 0 || y >= height) {
+                return;
+        }
+        framebuffer[y * width + x] = (uint16_t)color;
+        stats.pixels++;
+}
+
+/**
+ * Fills the rectangle between the two corners, the end coordinates are
+ * exclusive. The rectangle is clipped to the bounds of the display.
+ */
+void HeadlessDisplay::fill_rectangle(int x_start, int y_start, int x_end,
+                                     int y_end, Color color)
+{
+        x_start = x_start < 0 ? 0 : x_start;
+        y_start = y_start < 0 ? 0 : y_start;
+        x_end = x_end > width ? width : x_end;
+        y_end = y_end > height ? height : y_end;
+        for (int y = y_start; y < y_end; y++) {
+                for (int x = x_start; x < x_end; x++) {
+                        framebuffer[y * width + x] = (uint16_t)color;
+                }
+        }
+        if (x_end > x_start && y_end > y_start) {
+                stats.pixels += (x_end - x_start) * (y_end - y_start);
+        }
+}
+
+bool HeadlessDisplay::is_inside_rounded_rectangle(int x, int y, int x_start,
+                                                  int y_start, int width,
+                                                  int height, int radius)
+{
+        if (x < x_start || x >= x_start + width || y < y_start ||
+            y >= y_start + height) {
+                return false;
+        }
+        // Distance from the center of the closest corner circle, points that
+        // aren't next to any of the corners are always inside.
+        int left = x_start + radius;
+        int right = x_start + width - 1 - radius;
+        int top = y_start + radius;
+        int bottom = y_start + height - 1 - radius;
+        int dx = x < left ? left - x : (x > right ? x - right : 0);
+        int dy = y < top ? top - y : (y > bottom ? y - bottom : 0);
+        return dx * dx + dy * dy <= radius * radius;
+}
+
+int HeadlessDisplay::get_glyph_width(FontSize font_size)
+{
+        return font_size == Size24 ? HEADING_FONT_WIDTH : FONT_WIDTH;
+}
+#endif
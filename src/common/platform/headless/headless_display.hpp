@@ -0,0 +1,86 @@
+#pragma once
+#ifdef EMULATOR
+#include "../interface/display.hpp"
+
+/**
+ * Number of primitives drawn on the display and the number of pixels they
+ * have touched, this approximates the cost of rendering on the LCD display
+ * where each written pixel needs to be sent over SPI.
+ */
+typedef struct HeadlessDisplayStats {
+        unsigned long primitives;
+        unsigned long strings;
+        unsigned long bitmaps;
+        unsigned long pixels;
+} HeadlessDisplayStats;
+
+/**
+ * Display rendering into a plain RGB565 framebuffer in memory. It allows for
+ * running the games without a window, e.g. for profiling and fuzzing them at
+ * full CPU speed.
+ *
+ * The text is not rendered using a real font: each glyph is drawn as a filled
+ * box inside of its character cell. This keeps the framebuffer accurate about
+ * where the text was drawn without depending on any font rendering library.
+ */
+class HeadlessDisplay : public Display
+{
+      public:
+        HeadlessDisplay(int width, int height, int corner_radius);
+        ~HeadlessDisplay();
+
+        HeadlessDisplay(const HeadlessDisplay &) = delete;
+        HeadlessDisplay &operator=(const HeadlessDisplay &) = delete;
+
+        void setup() override;
+        void initialize() override;
+        void clear(Color color) override;
+        void draw_rounded_border(Color color) override;
+        void draw_circle(Point center, int radius, Color color,
+                         int border_width, bool filled) override;
+        void draw_rectangle(Point start, int width, int height, Color color,
+                            int border_width, bool filled) override;
+        void draw_rounded_rectangle(Point start, int width, int height,
+                                    int radius, Color color) override;
+        void draw_string(Point start, char *string_buffer, FontSize font_size,
+                         Color bg_color, Color fg_color) override;
+        void clear_region(Point top_left, Point bottom_right,
+                          Color clear_color) override;
+        void rasterize_string(char *string_buffer, FontSize font_size,
+                              uint8_t *mask, int width, int height) override;
+        void draw_bitmap(Point start, int width, int height,
+                         const uint8_t *mask, Color bg_color,
+                         Color fg_color) override;
+        int get_height() override { return height; }
+        int get_width() override { return width; }
+        int get_display_corner_radius() override { return corner_radius; }
+        void refresh() override {}
+
+        const uint16_t *get_framebuffer() { return framebuffer; }
+        HeadlessDisplayStats get_stats() { return stats; }
+        /**
+         * Returns a 64-bit FNV-1a hash of the framebuffer. Comparing it
+         * between runs is a cheap way of detecting rendering regressions.
+         */
+        uint64_t checksum();
+        /**
+         * Writes the framebuffer into a binary PPM image.
+         */
+        bool save_ppm(const char *path);
+
+      private:
+        void fill(int x, int y, Color color);
+        void fill_rectangle(int x_start, int y_start, int x_end, int y_end,
+                            Color color);
+        bool is_inside_rounded_rectangle(int x, int y, int x_start,
+                                         int y_start, int width, int height,
+                                         int radius);
+        int get_glyph_width(FontSize font_size);
+
+        int width;
+        int height;
+        int corner_radius;
+        uint16_t *framebuffer;
+        HeadlessDisplayStats stats;
+};
+#endif
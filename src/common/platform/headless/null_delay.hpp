@@ -0,0 +1,39 @@
+#pragma once
+#ifdef EMULATOR
+#include "../interface/delay.hpp"
+#include <stdexcept>
+
+/**
+ * Delay provider that never sleeps. Its clock only advances when the games
+ * call `delay_ms`, so they run at full CPU speed while still observing the
+ * same passage of time as they would on the real clock (minus the time spent
+ * rendering).
+ */
+class NullDelayProvider : public DelayProvider
+{
+      public:
+        NullDelayProvider() : now(0), time_limit(0) {}
+
+        void delay_ms(int ms) override
+        {
+                now += ms;
+                if (time_limit != 0 && now > time_limit) {
+                        throw std::runtime_error("Time limit reached");
+                }
+        }
+
+        unsigned long get_time_ms() override { return now; }
+
+        /**
+         * Once the clock passes the limit, the next delay throws a
+         * `std::runtime_error`. This is the only way to stop a game that
+         * waits for input which is never going to come. Zero disables the
+         * limit.
+         */
+        void set_time_limit(unsigned long limit) { time_limit = limit; }
+
+      private:
+        unsigned long now;
+        unsigned long time_limit;
+};
+#endif
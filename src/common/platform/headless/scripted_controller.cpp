@@ -0,0 +1,159 @@
+#ifdef EMULATOR
+#include "scripted_controller.hpp"
+#include "../../logging.hpp"
+#include "../interface/input.hpp"
+#include <fstream>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <strings.h>
+
+#define TAG "scripted_controller"
+
+/**
+ * Maps the input name onto the enum value, returns false if the name doesn't
+ * correspond to any directional or action input.
+ */
+static bool parse_input(const char *name, bool *is_action, uint8_t *input)
+{
+        for (int i = 0; i < 4; i++) {
+                if (strcasecmp(name, direction_to_str((Direction)i)) == 0) {
+                        *is_action = false;
+                        *input = i;
+                        return true;
+                }
+                if (strcasecmp(name, action_to_str((Action)i)) == 0) {
+                        *is_action = true;
+                        *input = i;
+                        return true;
+                }
+        }
+        return false;
+}
+
+bool InputScript::load(const char *path)
+{
+        std::ifstream ifs(path);
+        if (!ifs) {
+                LOG_INFO(TAG, "Unable to open %s for reading.", path);
+                return false;
+        }
+
+        std::string line;
+        int line_number = 0;
+        unsigned long previous_time = 0;
+        while (std::getline(ifs, line)) {
+                line_number++;
+                size_t comment = line.find('#');
+                if (comment != std::string::npos) {
+                        line.erase(comment);
+                }
+
+                char time[32];
+                char name[32];
+                char trailing[2];
+                int fields = sscanf(line.c_str(), "%31s %31s %1s", time, name,
+                                    trailing);
+                if (fields <= 0) {
+                        continue;
+                }
+
+                bool relative = time[0] == '+';
+                char *end;
+                unsigned long time_ms =
+                    strtoul(time + (relative ? 1 : 0), &end, 10);
+                bool is_action;
+                uint8_t input;
+                if (fields != 2 || *end != '\0' ||
+                    !parse_input(name, &is_action, &input)) {
+                        LOG_INFO(TAG, "%s:%d: expected '<time_ms> <input>'.",
+                                 path, line_number);
+                        return false;
+                }
+                if (relative) {
+                        time_ms += previous_time;
+                }
+                if (time_ms < previous_time) {
+                        LOG_INFO(TAG, "%s:%d: inputs need to be in order.",
+                                 path, line_number);
+                        return false;
+                }
+                add(time_ms, is_action, input);
+                previous_time = time_ms;
+        }
+        LOG_DEBUG(TAG, "Loaded %d inputs from %s", (int)inputs.size(), path);
+        return true;
+}
+
+void InputScript::generate_random(unsigned int seed, int count,
+                                  int max_interval_ms)
+{
+        // The script uses its own generator so that it doesn't consume the
+        // random sequence that the games rely on.
+        std::mt19937 generator(seed);
+        std::uniform_int_distribution<int> interval(1, max_interval_ms);
+        std::uniform_int_distribution<int> kind(0, 7);
+
+        unsigned long time_ms = get_end_time();
+        for (int i = 0; i < count; i++) {
+                time_ms += interval(generator);
+                int input = kind(generator);
+                add(time_ms, input >= 4, input % 4);
+        }
+}
+
+void InputScript::add(unsigned long time_ms, bool is_action, uint8_t input)
+{
+        inputs.push_back(
+            {.time_ms = time_ms, .is_action = is_action, .input = input});
+}
+
+bool InputScript::poll(bool action, uint8_t *input)
+{
+        if (is_finished()) {
+                return false;
+        }
+        // Same as a button press on the device, an input that the game didn't
+        // poll for is lost once the next one comes in.
+        unsigned long now = clock->get_time_ms();
+        while (next_input + 1 < inputs.size() &&
+               inputs[next_input + 1].time_ms <= now) {
+                next_input++;
+                dropped_inputs++;
+        }
+        ScriptedInput *next = &inputs[next_input];
+        if (now < next->time_ms ||
+            next->is_action != action) {
+                return false;
+        }
+        *input = next->input;
+        next_input++;
+        return true;
+}
+
+unsigned long InputScript::get_end_time()
+{
+        return inputs.empty() ? 0 : inputs.back().time_ms;
+}
+
+bool ScriptedDirectionalController::poll_for_input(Direction *input)
+{
+        uint8_t scripted;
+        if (!script->poll(false, &scripted)) {
+                return false;
+        }
+        *input = (Direction)scripted;
+        return true;
+}
+
+bool ScriptedActionController::poll_for_input(Action *input)
+{
+        uint8_t scripted;
+        if (!script->poll(true, &scripted)) {
+                return false;
+        }
+        *input = (Action)scripted;
+        return true;
+}
+#endif
@@ -0,0 +1,99 @@
+#pragma once
+#ifdef EMULATOR
+#include "../interface/controller.hpp"
+#include "../interface/delay.hpp"
+#include <stdint.h>
+#include <vector>
+
+typedef struct ScriptedInput {
+        /**
+         * Time (as reported by the delay provider) at which the input is
+         * delivered to the game.
+         */
+        unsigned long time_ms;
+        bool is_action;
+        /**
+         * Value of the `Direction` or `Action` enum depending on `is_action`.
+         */
+        uint8_t input;
+} ScriptedInput;
+
+/**
+ * Sequence of timestamped inputs fed to the game by the scripted controllers.
+ *
+ * Script files contain one input per line in the format `<time_ms> <input>`,
+ * where the input is one of the names returned by `direction_to_str` and
+ * `action_to_str` (case insensitive). A time prefixed with `+` is relative to
+ * the previous input. Empty lines and everything after `#` are ignored:
+ *
+ *     # Start the first game in the menu and move right twice.
+ *     500 Green
+ *     +200 Right
+ *     +200 Right
+ *
+ * An input becomes available once the clock reaches its time and it is
+ * returned by the first poll of the matching controller kind. Unlike in
+ * replays, the scripts don't know which inputs the game is waiting for, so an
+ * input that wasn't polled for by the time the next one becomes available is
+ * dropped, just like a button press that the game missed.
+ */
+class InputScript
+{
+      public:
+        InputScript(DelayProvider *clock)
+            : clock(clock), next_input(0), dropped_inputs(0)
+        {
+        }
+
+        /**
+         * Parses the script file, returns false and logs the offending line
+         * if the file can't be read or is malformed.
+         */
+        bool load(const char *path);
+        /**
+         * Fills the script with `count` random inputs spaced up to
+         * `max_interval_ms` apart, this is useful for fuzzing the games.
+         */
+        void generate_random(unsigned int seed, int count,
+                             int max_interval_ms);
+        void add(unsigned long time_ms, bool is_action, uint8_t input);
+
+        bool poll(bool action, uint8_t *input);
+        bool is_finished() { return next_input == inputs.size(); }
+        /**
+         * Returns the time of the last input in the script.
+         */
+        unsigned long get_end_time();
+        int get_dropped_inputs() { return dropped_inputs; }
+
+      private:
+        DelayProvider *clock;
+        std::vector<ScriptedInput> inputs;
+        size_t next_input;
+        int dropped_inputs;
+};
+
+class ScriptedDirectionalController : public DirectionalController
+{
+      public:
+        ScriptedDirectionalController(InputScript *script) : script(script) {}
+
+        bool poll_for_input(Direction *input) override;
+        void setup() override {}
+
+      private:
+        InputScript *script;
+};
+
+class ScriptedActionController : public ActionController
+{
+      public:
+        ScriptedActionController(InputScript *script) : script(script) {}
+
+        bool poll_for_input(Action *input) override;
+        void setup() override {}
+
+      private:
+        InputScript *script;
+};
+#endif
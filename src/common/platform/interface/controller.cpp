@@ -3,25 +3,66 @@
 /**
  * Checks if any of the controllers has recorded user input. If so, the input
  * direction will be written into the `registered_dir` output parameter.
+ *
+ * The controllers queue their inputs, so polling stops at the first one that
+ * returns an input. Otherwise a press consumed from one controller could get
+ * overwritten by the input of the next one and would be lost.
  */
 bool directional_input_registered(
     std::vector<DirectionalController *> *controllers,
     Direction *registered_dir)
 {
-        bool input_registered = false;
         for (DirectionalController *controller : *controllers) {
-                input_registered |= controller->poll_for_input(registered_dir);
+                if (controller->poll_for_input(registered_dir)) {
+                        return true;
+                }
         }
-        return input_registered;
+        return false;
 }
 
 bool action_input_registered(std::vector<ActionController *> *controllers,
                              Action *registered_action)
 {
-        bool input_registered = false;
         for (ActionController *controller : *controllers) {
-                input_registered |=
-                    controller->poll_for_input(registered_action);
+                if (controller->poll_for_input(registered_action)) {
+                        return true;
+                }
         }
-        return input_registered;
+        return false;
+}
+
+/**
+ * Reports the tap produced by `poll_for_input` as a press and a release,
+ * which is shared by the directional and action controllers.
+ */
+static bool tap_event(int *tap_release, bool registered, uint8_t input,
+                      InputEvent *event)
+{
+        if (*tap_release != -1) {
+                *event = {.timestamp = 0,
+                          .input = (uint8_t)*tap_release,
+                          .pressed = false};
+                *tap_release = -1;
+                return true;
+        }
+        if (!registered) {
+                return false;
+        }
+        *event = {.timestamp = 0, .input = input, .pressed = true};
+        *tap_release = input;
+        return true;
+}
+
+bool DirectionalController::poll_event(InputEvent *event)
+{
+        Direction input = UP;
+        bool registered = tap_release == -1 && poll_for_input(&input);
+        return tap_event(&tap_release, registered, input, event);
+}
+
+bool ActionController::poll_event(InputEvent *event)
+{
+        Action input = YELLOW;
+        bool registered = tap_release == -1 && poll_for_input(&input);
+        return tap_event(&tap_release, registered, input, event);
 }
@@ -1,12 +1,21 @@
 #pragma once
 
 #include "input.hpp"
+#include "input_event_queue.hpp"
 #include <stdlib.h>
 #include <vector>
 
+/**
+ * Magnitude reported by the directional controllers when a direction is fully
+ * held, see `DirectionalController::get_magnitude`.
+ */
+#define DIRECTION_MAGNITUDE_MAX 255
+
 class DirectionalController
 {
       public:
+        virtual ~DirectionalController() = default;
+
         /**
          * For a given controller, this function will inspect its state to
          * determine if an input is being entered. Note that for physical
@@ -23,17 +32,47 @@ class DirectionalController
          */
         virtual bool poll_for_input(Direction *input) = 0;
 
+        /**
+         * Returns the next press or release of an input in the order in which
+         * they have happened. This is what the key repeat (see
+         * `KeyRepeatPlatform`) is built on, the games use `poll_for_input`.
+         *
+         * The default implementation is built on top of `poll_for_input` for
+         * controllers that only produce discrete inputs: each registered
+         * input is reported as a press immediately followed by a release.
+         * Those events have no timestamp, i.e. it is 0. Controllers that keep
+         * track of the held inputs need to override it.
+         */
+        virtual bool poll_event(InputEvent *event);
+
+        /**
+         * Returns how strongly the currently held direction is being held,
+         * scaled to 0-DIRECTION_MAGNITUDE_MAX. Analog controllers (e.g. the
+         * joystick) report how far they are tilted, the digital ones are
+         * always either fully held or not at all.
+         */
+        virtual uint8_t get_magnitude() { return DIRECTION_MAGNITUDE_MAX; }
+
         /**
          * Setup function used for e.g. initializing pins of the controller.
          * This is to be called only once inside of the `setup` Arduino
          * function.
          */
         virtual void setup() = 0;
+
+      private:
+        /**
+         * Input that was reported as pressed by the default `poll_event` and
+         * needs to be released on the next call, -1 if there is none.
+         */
+        int tap_release = -1;
 };
 
 class ActionController
 {
       public:
+        virtual ~ActionController() = default;
+
         /**
          * For a given controller, this function will inspect its state to
          * determine if an input is being entered. Note that for physical
@@ -50,12 +89,32 @@ class ActionController
          */
         virtual bool poll_for_input(Action *input) = 0;
 
+        /**
+         * Returns the next press or release of an input in the order in which
+         * they have happened. This is what the key repeat (see
+         * `KeyRepeatPlatform`) is built on, the games use `poll_for_input`.
+         *
+         * The default implementation is built on top of `poll_for_input` for
+         * controllers that only produce discrete inputs: each registered
+         * input is reported as a press immediately followed by a release.
+         * Those events have no timestamp, i.e. it is 0. Controllers that keep
+         * track of the held inputs need to override it.
+         */
+        virtual bool poll_event(InputEvent *event);
+
         /**
          * Setup function used for e.g. initializing pins of the controller.
          * This is to be called only once inside of the `setup` Arduino
          * function.
          */
         virtual void setup() = 0;
+
+      private:
+        /**
+         * Input that was reported as pressed by the default `poll_event` and
+         * needs to be released on the next call, -1 if there is none.
+         */
+        int tap_release = -1;
 };
 
 extern bool
@@ -4,4 +4,11 @@ class DelayProvider
 {
       public:
         virtual void delay_ms(int ms) = 0;
+        /**
+         * Returns the number of milliseconds that have elapsed since the
+         * platform was started. The clock is monotonic and so it can be used
+         * for measuring how long rendering takes and for scheduling animations
+         * without blocking the game loop.
+         */
+        virtual unsigned long get_time_ms() = 0;
 };
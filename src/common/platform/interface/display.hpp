@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 // TODO: think about those dependencies. Should they be a part of the platform definition?
 #include "../../point.hpp"
 #include "../../font_size.hpp"
@@ -12,6 +13,11 @@
 class Display
 {
       public:
+        /**
+         * Wrappers such as the latency tracer own a display forwarding to
+         * the actual one and delete it through this interface.
+         */
+        virtual ~Display() = default;
         /**
          * Performs the setup of the display. This is intended for performing
          * initialization of the modules that are responsible for driving the
@@ -73,6 +79,28 @@ class Display
         virtual void clear_region(Point top_left, Point bottom_right,
                                   Color clear_color) = 0;
 
+        /**
+         * Rasterizes a string into a 1-bit-per-pixel mask of the given
+         * dimensions. Rows of the mask are padded to full bytes and the most
+         * significant bit comes first (the same layout as the LCD font
+         * tables). Set bits correspond to the foreground of the text. This
+         * allows for rendering text once and then blitting it repeatedly using
+         * `draw_bitmap`.
+         */
+        virtual void rasterize_string(char *string_buffer, FontSize font_size,
+                                      uint8_t *mask, int width,
+                                      int height) = 0;
+
+        /**
+         * Draws a 1-bit-per-pixel mask (in the layout produced by
+         * `rasterize_string`) using the two specified colors. On the physical
+         * display this is sent as a single window write, which is much faster
+         * than clearing the region and drawing a string pixel by pixel.
+         */
+        virtual void draw_bitmap(Point start, int width, int height,
+                                 const uint8_t *mask, Color bg_color,
+                                 Color fg_color) = 0;
+
         /**
          * Returns the height of the display.
          */
@@ -0,0 +1,78 @@
+#include "input_event_queue.hpp"
+
+#define INPUT_EVENT_QUEUE_MASK (INPUT_EVENT_QUEUE_CAPACITY - 1)
+
+static_assert((INPUT_EVENT_QUEUE_CAPACITY & INPUT_EVENT_QUEUE_MASK) == 0,
+              "The input event queue capacity needs to be a power of two.");
+
+InputEventQueue::InputEventQueue()
+    : head(0), tail(0), dropped_events(0), sampled_state(0), held_state(0)
+{
+}
+
+void InputEventQueue::record_state(uint8_t state_mask, unsigned long timestamp)
+{
+        uint8_t changed = state_mask ^ sampled_state;
+        for (uint8_t input = 0; changed >> input; input++) {
+                uint8_t bit = 1 << input;
+                if (!(changed & bit)) {
+                        continue;
+                }
+                // If the queue is full the change is not recorded as sampled,
+                // so it is pushed again on the next sample and a release can't
+                // get lost leaving the input stuck in the held state.
+                if (push({.timestamp = timestamp,
+                          .input = input,
+                          .pressed = (state_mask & bit) != 0})) {
+                        sampled_state ^= bit;
+                }
+        }
+}
+
+bool InputEventQueue::push(InputEvent event)
+{
+        uint8_t current_tail = tail.load(std::memory_order_relaxed);
+        uint8_t next_tail = (current_tail + 1) & INPUT_EVENT_QUEUE_MASK;
+        // One slot is always left empty to tell a full queue from an empty one.
+        if (next_tail == head.load(std::memory_order_acquire)) {
+                dropped_events = dropped_events + 1;
+                return false;
+        }
+        events[current_tail] = event;
+        tail.store(next_tail, std::memory_order_release);
+        return true;
+}
+
+bool InputEventQueue::pop(InputEvent *event)
+{
+        uint8_t current_head = head.load(std::memory_order_relaxed);
+        if (current_head == tail.load(std::memory_order_acquire)) {
+                return false;
+        }
+        *event = events[current_head];
+        head.store((current_head + 1) & INPUT_EVENT_QUEUE_MASK,
+                   std::memory_order_release);
+        return true;
+}
+
+bool InputEventQueue::poll(uint8_t *input)
+{
+        InputEvent event;
+        while (pop(&event)) {
+                if (event.pressed) {
+                        held_state |= 1 << event.input;
+                        *input = event.input;
+                        return true;
+                }
+                held_state &= ~(1 << event.input);
+        }
+        if (!held_state) {
+                return false;
+        }
+        uint8_t held_input = 0;
+        while (!(held_state & (1 << held_input))) {
+                held_input++;
+        }
+        *input = held_input;
+        return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <stdint.h>
+
+/**
+ * Maximum number of events that can be waiting in the queue. It needs to be a
+ * power of two so that the indices can wrap around using a bit mask.
+ */
+#define INPUT_EVENT_QUEUE_CAPACITY 16
+
+/**
+ * A single change of the state of an input. The `input` is the value of the
+ * `Direction` or `Action` enum, depending on the controller that produced the
+ * event.
+ */
+typedef struct InputEvent {
+        /**
+         * Value of the platform clock (see `DelayProvider::get_time_ms`) at
+         * the moment when the change was sampled.
+         */
+        unsigned long timestamp;
+        uint8_t input;
+        bool pressed;
+} InputEvent;
+
+/**
+ * Lock-free single-producer single-consumer ring buffer of input events.
+ *
+ * The producer is whatever samples the physical inputs: a timer interrupt on
+ * the Arduino or the SFML event loop on the emulator. The consumer is the
+ * controller when the game polls it. Because each index is written by only
+ * one side, the producer can run inside of an interrupt handler without ever
+ * having to disable interrupts in the game loop.
+ *
+ * This allows presses that happen while the game is busy (e.g. rendering the
+ * whole screen over SPI) to be delivered once the game polls for input again
+ * instead of being lost.
+ */
+class InputEventQueue
+{
+      public:
+        InputEventQueue();
+
+        /**
+         * Producer side: compares the sampled state of the inputs against the
+         * previous sample and pushes a press or release event for each input
+         * that has changed. Bit `i` of the mask is set if input `i` is
+         * currently held down.
+         */
+        void record_state(uint8_t state_mask, unsigned long timestamp);
+        /**
+         * Producer side: appends the event to the queue. If the queue is full
+         * the event is dropped and false is returned.
+         */
+        bool push(InputEvent event);
+
+        /**
+         * Consumer side: removes the oldest event from the queue. Returns
+         * false if the queue is empty.
+         */
+        bool pop(InputEvent *event);
+        /**
+         * Consumer side: returns the input that the game should react to now,
+         * which is compatible with the semantics of `poll_for_input`.
+         *
+         * Queued presses are returned first, one per call, in the order in
+         * which they have happened, so quick taps aren't lost even if they
+         * were released before the game polled. Once there are no queued
+         * presses, the input that is still held down (if any) is returned so
+         * that holding a button keeps registering it.
+         */
+        bool poll(uint8_t *input);
+
+        /**
+         * Number of events that were dropped because the queue was full.
+         */
+        unsigned long get_dropped_events() { return dropped_events; }
+
+      private:
+        InputEvent events[INPUT_EVENT_QUEUE_CAPACITY];
+        /**
+         * Index of the next event to be read, only written by the consumer.
+         */
+        std::atomic<uint8_t> head;
+        /**
+         * Index of the next free slot, only written by the producer.
+         */
+        std::atomic<uint8_t> tail;
+        volatile unsigned long dropped_events;
+
+        /**
+         * State of the inputs as of the last `record_state` call, owned by
+         * the producer.
+         */
+        uint8_t sampled_state;
+        /**
+         * State of the inputs as of the last event consumed by `poll`, owned
+         * by the consumer.
+         */
+        uint8_t held_state;
+};
@@ -1,9 +1,53 @@
 #pragma once
+#ifdef EMULATOR
+#include <stdint.h>
+#endif
+
 class PersistentStorage
 {
       public:
+#ifdef EMULATOR
+        /**
+         * Maps the EEPROM image stored in the file at `path`, the file is
+         * created and extended to `PERSISTENT_STORAGE_SIZE` if needed. All
+         * reads and writes are then served from memory, see
+         * `persistent_storage.inl` in the emulator platform.
+         */
+        PersistentStorage(const char *path);
+        ~PersistentStorage();
+
+        PersistentStorage(const PersistentStorage &) = delete;
+        PersistentStorage &operator=(const PersistentStorage &) = delete;
+
+        /**
+         * Writes the modified pages of the image back to the file and waits
+         * until they are stored.
+         */
+        void flush();
+#endif
         template <typename T> T &get(int offset, T &t);
         template <typename T> const T &put(int offset, const T &t);
+
+#ifdef EMULATOR
+      private:
+        bool in_bounds(int offset, int size);
+        void mark_dirty(int offset, int size);
+        /**
+         * Syncs the modified range of the image with the file, `flags` are
+         * passed to `msync`.
+         */
+        void write_back(int flags);
+
+        uint8_t *image;
+        int fd;
+        /**
+         * Range of bytes modified since the last flush, empty if
+         * `dirty_start == dirty_end`.
+         */
+        int dirty_start;
+        int dirty_end;
+        unsigned long last_flush_ms;
+#endif
 };
 
 /*
@@ -5,6 +5,10 @@
 #include "persistent_storage.hpp"
 #include <vector>
 
+class RecordStore;
+class SettingsCache;
+class HighScores;
+
 /**
  * Structure encapsulating all interfaces that a given implementation of the
  * game console platform needs to provide so that we can run our games on it.
@@ -15,4 +19,18 @@ struct Platform {
         std::vector<ActionController*> *action_controllers;
         DelayProvider *delay_provider;
         PersistentStorage *persistent_storage;
+        /**
+         * Store of the settings, high scores and replays kept in the
+         * persistent storage, see `record_store.hpp`.
+         */
+        RecordStore *record_store;
+        /**
+         * Default configurations of the games, cached in RAM on top of the
+         * record store, see `settings_cache.hpp`.
+         */
+        SettingsCache *settings_cache;
+        /**
+         * Best scores of the games, see `high_scores.hpp`.
+         */
+        HighScores *high_scores;
 };
@@ -0,0 +1,280 @@
+#include <stddef.h>
+
+#include "logging.hpp"
+#include "record_store.hpp"
+
+#define TAG "record_store"
+
+#define RECORD_HEADER_SIZE ((int)sizeof(RecordHeader))
+/**
+ * Number of header bytes covered by the CRC, i.e. all fields in front of it.
+ */
+#define RECORD_HEADER_CRC_SIZE ((int)offsetof(RecordHeader, crc))
+
+static_assert(sizeof(RecordHeader) == 12,
+              "The record header layout must not depend on the platform.");
+static_assert(RECORD_STORE_SIZE <= 0x10000,
+              "The record offsets need to fit into the index entries.");
+
+/**
+ * CRC-16/CCITT, it is cheap to compute byte by byte while the records are
+ * streamed from the storage.
+ */
+static uint16_t crc16_update(uint16_t crc, uint8_t byte)
+{
+        crc ^= (uint16_t)byte << 8;
+        for (int bit = 0; bit < 8; bit++) {
+                crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+        return crc;
+}
+
+static uint16_t header_crc(RecordHeader *header)
+{
+        uint16_t crc = 0xFFFF;
+        const uint8_t *bytes = (const uint8_t *)header;
+        for (int i = 0; i < RECORD_HEADER_CRC_SIZE; i++) {
+                crc = crc16_update(crc, bytes[i]);
+        }
+        return crc;
+}
+
+RecordStore::RecordStore(PersistentStorage *storage)
+    : storage(storage), entries_count(0), active_half(0), head(0),
+      next_sequence(1), compactions(0)
+{
+}
+
+void RecordStore::mount()
+{
+        entries_count = 0;
+        uint32_t last_sequence[2] = {0, 0};
+        int chain_end[2];
+        for (int half = 0; half < 2; half++) {
+                chain_end[half] = scan_half(half, &last_sequence[half]);
+        }
+
+        active_half = last_sequence[1] > last_sequence[0] ? 1 : 0;
+        head = chain_end[active_half];
+        uint32_t max_sequence = last_sequence[active_half];
+        next_sequence = max_sequence + 1;
+
+        // Records that are only in the inactive half are left over from an
+        // interrupted compaction. They are copied into the active half as
+        // the inactive one gets overwritten by the next compaction.
+        for (int i = 0; i < entries_count; i++) {
+                RecordIndexEntry *entry = &entries[i];
+                if (half_of(entry->offset) == active_half) {
+                        continue;
+                }
+                LOG_INFO(TAG, "Recovering record %d from the inactive half.",
+                         entry->key);
+                if (head + RECORD_HEADER_SIZE + entry->length >
+                    half_end(active_half)) {
+                        LOG_ERROR(TAG, "No space left to recover record %d.",
+                                  entry->key);
+                        break;
+                }
+                append(entry->key, entry->version, NULL, entry->length, entry);
+        }
+
+        LOG_DEBUG(TAG, "Mounted %d records, active half %d, head at %d.",
+                  entries_count, active_half, head);
+}
+
+int RecordStore::scan_half(int half, uint32_t *last_sequence)
+{
+        int offset = half_start(half);
+        *last_sequence = 0;
+        while (offset + RECORD_HEADER_SIZE <= half_end(half)) {
+                RecordHeader header;
+                storage->get(RECORD_STORE_OFFSET + offset, header);
+                if (header.magic != RECORD_MAGIC ||
+                    offset + RECORD_HEADER_SIZE + header.length >
+                        half_end(half)) {
+                        break;
+                }
+                // The records of a half are written in order, anything with
+                // a lower sequence number is left over from before the half
+                // was last compacted into.
+                if (header.sequence <= *last_sequence) {
+                        break;
+                }
+                uint16_t crc = header_crc(&header);
+                int payload = offset + RECORD_HEADER_SIZE;
+                for (int i = 0; i < header.length; i++) {
+                        crc = crc16_update(crc, read_byte(payload + i));
+                }
+                // A write torn by a power loss ends the chain, the next record
+                // gets written over it.
+                if (crc != header.crc) {
+                        LOG_DEBUG(TAG, "Invalid record at offset %d.", offset);
+                        break;
+                }
+                index(&header, offset);
+                *last_sequence = header.sequence;
+                offset = payload + header.length;
+        }
+        return offset;
+}
+
+void RecordStore::index(RecordHeader *header, int offset)
+{
+        if (header->key == RECORD_KEY_MARKER) {
+                return;
+        }
+        RecordIndexEntry *entry = find(header->key);
+        if (entry && entry->sequence > header->sequence) {
+                return;
+        }
+        if (!entry) {
+                if (entries_count == RECORD_STORE_MAX_KEYS) {
+                        LOG_ERROR(TAG, "Index is full, record %d ignored.",
+                                  header->key);
+                        return;
+                }
+                entry = &entries[entries_count++];
+        }
+        *entry = {.key = header->key,
+                  .version = header->version,
+                  .length = header->length,
+                  .offset = (uint16_t)offset,
+                  .sequence = header->sequence};
+}
+
+RecordIndexEntry *RecordStore::find(uint8_t key)
+{
+        for (int i = 0; i < entries_count; i++) {
+                if (entries[i].key == key) {
+                        return &entries[i];
+                }
+        }
+        return NULL;
+}
+
+int RecordStore::read(uint8_t key, void *data, int max_length, uint8_t version)
+{
+        RecordIndexEntry *entry = find(key);
+        if (!entry || entry->version != version || entry->length > max_length) {
+                return -1;
+        }
+        uint8_t *bytes = (uint8_t *)data;
+        int payload = entry->offset + RECORD_HEADER_SIZE;
+        for (int i = 0; i < entry->length; i++) {
+                bytes[i] = read_byte(payload + i);
+        }
+        return entry->length;
+}
+
+bool RecordStore::write(uint8_t key, const void *data, int length,
+                        uint8_t version)
+{
+        if (key == RECORD_KEY_MARKER || length < 0 || length > 0xFFFF) {
+                return false;
+        }
+        const uint8_t *bytes = (const uint8_t *)data;
+        RecordIndexEntry *entry = find(key);
+        // Saving unchanged settings is common (e.g. confirming the defaults
+        // before each game), it must not wear out the storage.
+        if (entry && entry->version == version && entry->length == length &&
+            payload_equals(entry, bytes)) {
+                return true;
+        }
+        if (!entry && entries_count == RECORD_STORE_MAX_KEYS) {
+                LOG_ERROR(TAG, "Index is full, record %d not written.", key);
+                return false;
+        }
+
+        int needed = RECORD_HEADER_SIZE + length;
+        if (head + needed > half_end(active_half) && !compact(needed)) {
+                return false;
+        }
+        append(key, version, bytes, length, NULL);
+        return true;
+}
+
+bool RecordStore::payload_equals(RecordIndexEntry *entry, const uint8_t *data)
+{
+        int payload = entry->offset + RECORD_HEADER_SIZE;
+        for (int i = 0; i < entry->length; i++) {
+                if (read_byte(payload + i) != data[i]) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+bool RecordStore::compact(int length)
+{
+        int target = 1 - active_half;
+        int required = RECORD_HEADER_SIZE + length;
+        for (int i = 0; i < entries_count; i++) {
+                // The records are copied from the active half, anything still
+                // in the target half would be overwritten before it's copied.
+                if (half_of(entries[i].offset) == target) {
+                        LOG_ERROR(TAG, "Record %d is in the half being "
+                                       "compacted into.",
+                                  entries[i].key);
+                        return false;
+                }
+                required += RECORD_HEADER_SIZE + entries[i].length;
+        }
+        if (required > RECORD_STORE_SIZE / 2) {
+                LOG_ERROR(TAG, "Not enough space for a record of %d bytes.",
+                          length);
+                return false;
+        }
+
+        LOG_DEBUG(TAG, "Compacting %d records into half %d.", entries_count,
+                  target);
+        active_half = target;
+        head = half_start(target);
+        // The marker makes the target half the most recent one even if the
+        // compaction is interrupted before any record is copied.
+        append(RECORD_KEY_MARKER, 0, NULL, 0, NULL);
+        for (int i = 0; i < entries_count; i++) {
+                append(entries[i].key, entries[i].version, NULL,
+                       entries[i].length, &entries[i]);
+        }
+        compactions++;
+        return true;
+}
+
+void RecordStore::append(uint8_t key, uint8_t version, const uint8_t *data,
+                         int length, RecordIndexEntry *source)
+{
+        RecordHeader header = {.magic = RECORD_MAGIC,
+                               .key = key,
+                               .version = version,
+                               .reserved = 0,
+                               .sequence = next_sequence++,
+                               .length = (uint16_t)length,
+                               .crc = 0};
+        uint16_t crc = header_crc(&header);
+        int payload = head + RECORD_HEADER_SIZE;
+        int source_payload = source ? source->offset + RECORD_HEADER_SIZE : 0;
+        for (int i = 0; i < length; i++) {
+                uint8_t byte = source ? read_byte(source_payload + i) : data[i];
+                crc = crc16_update(crc, byte);
+                write_byte(payload + i, byte);
+        }
+        header.crc = crc;
+        // The header goes last, so the record can't be mistaken for a valid
+        // one until the whole payload is written.
+        storage->put(RECORD_STORE_OFFSET + head, header);
+
+        index(&header, head);
+        head = payload + length;
+}
+
+uint8_t RecordStore::read_byte(int offset)
+{
+        uint8_t value = 0;
+        storage->get(RECORD_STORE_OFFSET + offset, value);
+        return value;
+}
+
+void RecordStore::write_byte(int offset, uint8_t value)
+{
+        storage->put(RECORD_STORE_OFFSET + offset, value);
+}
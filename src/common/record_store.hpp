@@ -0,0 +1,163 @@
+#pragma once
+#include <stdint.h>
+
+#include "platform/interface/persistent_storage.hpp"
+
+/**
+ * Part of the persistent storage managed by the record store. It spans the
+ * whole 8 kB EEPROM of the UNO R4 (and the EEPROM image of the emulator).
+ */
+#define RECORD_STORE_OFFSET 0
+#define RECORD_STORE_SIZE 8192
+/**
+ * Maximum number of distinct keys, this bounds the RAM used by the index.
+ */
+#define RECORD_STORE_MAX_KEYS 32
+
+/**
+ * The keys are grouped by the kind of the record, the settings and the high
+ * scores are further keyed by the value of the `Game` enum.
+ */
+#define RECORD_KEY_SETTINGS_BASE 0x00
+#define RECORD_KEY_HIGH_SCORES_BASE 0x20
+#define RECORD_KEY_REPLAY 0x40
+/**
+ * Key of the empty record written at the start of a half when the records are
+ * compacted into it, it marks the half as the most recent one.
+ */
+#define RECORD_KEY_MARKER 0xFF
+
+#define RECORD_MAGIC 0x5A
+
+/**
+ * Header stored in front of the payload of each record. The CRC covers the
+ * header fields in front of it and the payload.
+ */
+typedef struct RecordHeader {
+        uint8_t magic;
+        uint8_t key;
+        /**
+         * Version of the payload layout, a record is only returned if its
+         * version matches the one the caller expects.
+         */
+        uint8_t version;
+        uint8_t reserved;
+        /**
+         * Incremented with each written record, the record with the highest
+         * sequence number is the current one for its key.
+         */
+        uint32_t sequence;
+        uint16_t length;
+        uint16_t crc;
+} RecordHeader;
+
+typedef struct RecordIndexEntry {
+        uint8_t key;
+        uint8_t version;
+        uint16_t length;
+        /**
+         * Offset of the record header relative to the start of the store.
+         */
+        uint16_t offset;
+        uint32_t sequence;
+} RecordIndexEntry;
+
+/**
+ * Log-structured store of small records (settings, high scores, replays) on
+ * top of the persistent storage.
+ *
+ * The store is split into two halves. New records are appended one after
+ * another to the active half, so repeatedly saving the same settings moves
+ * the writes across the whole half instead of wearing out a single spot.
+ * Once the active half is full, the current records are copied into the
+ * other half, which then becomes the active one.
+ *
+ * A record is never written over the current version of any key, so a write
+ * interrupted by a power loss leaves a record with an invalid CRC behind and
+ * the previous version of the record is used instead. The only state kept in
+ * RAM is the index of the current records, which is rebuilt by scanning both
+ * halves in `mount`.
+ */
+class RecordStore
+{
+      public:
+        RecordStore(PersistentStorage *storage);
+
+        RecordStore(const RecordStore &) = delete;
+        RecordStore &operator=(const RecordStore &) = delete;
+
+        /**
+         * Scans the storage and builds the index of the current records. It
+         * needs to be called once before the store is used, on the Arduino
+         * this is done in the `setup` function.
+         */
+        void mount();
+
+        /**
+         * Reads the current record stored under `key` into `data`. Returns
+         * the length of the record or -1 if there is no such record, it has a
+         * different version or it doesn't fit into `max_length` bytes.
+         */
+        int read(uint8_t key, void *data, int max_length, uint8_t version);
+        /**
+         * Stores a new version of the record. Nothing is written if the
+         * record is identical to the current one. Returns false if the record
+         * doesn't fit into the store.
+         */
+        bool write(uint8_t key, const void *data, int length, uint8_t version);
+
+        /**
+         * Reads a record holding a single struct, it is only valid if it has
+         * exactly the size of the struct.
+         */
+        template <typename T> bool read(uint8_t key, T *t, uint8_t version)
+        {
+                return read(key, t, sizeof(T), version) == (int)sizeof(T);
+        }
+        template <typename T>
+        bool write(uint8_t key, const T *t, uint8_t version)
+        {
+                return write(key, t, sizeof(T), version);
+        }
+
+        /**
+         * Number of times the records were compacted into the other half
+         * since the store was mounted.
+         */
+        unsigned long get_compactions() { return compactions; }
+
+      private:
+        int half_start(int half) { return half * (RECORD_STORE_SIZE / 2); }
+        int half_end(int half) { return half_start(half + 1); }
+        int half_of(int offset) { return offset / (RECORD_STORE_SIZE / 2); }
+
+        int scan_half(int half, uint32_t *last_sequence);
+        RecordIndexEntry *find(uint8_t key);
+        bool payload_equals(RecordIndexEntry *entry, const uint8_t *data);
+        /**
+         * Copies the current records into the other half, leaving at least
+         * `length` bytes for the record that is about to be written.
+         */
+        bool compact(int length);
+        /**
+         * Appends a record at the head of the active half, the payload comes
+         * either from `data` or from the existing record `source`.
+         */
+        void append(uint8_t key, uint8_t version, const uint8_t *data,
+                    int length, RecordIndexEntry *source);
+        void index(RecordHeader *header, int offset);
+
+        uint8_t read_byte(int offset);
+        void write_byte(int offset, uint8_t value);
+
+        PersistentStorage *storage;
+        RecordIndexEntry entries[RECORD_STORE_MAX_KEYS];
+        int entries_count;
+        int active_half;
+        /**
+         * Offset at which the next record is written.
+         */
+        int head;
+        uint32_t next_sequence;
+        unsigned long compactions;
+};
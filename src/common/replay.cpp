@@ -0,0 +1,334 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "logging.hpp"
+#include "replay.hpp"
+
+#ifdef EMULATOR
+#include <fstream>
+#endif
+
+#define TAG "replay"
+
+/**
+ * Controllers forwarding the input of the original platform controllers to
+ * the game while recording it.
+ */
+class RecordingDirectionalController : public DirectionalController
+{
+      public:
+        RecordingDirectionalController(
+            std::vector<DirectionalController *> *source,
+            ReplayRecorder *recorder)
+            : source(source), recorder(recorder)
+        {
+        }
+
+        bool poll_for_input(Direction *input) override
+        {
+                if (!directional_input_registered(source, input)) {
+                        return false;
+                }
+                recorder->record(*input);
+                return true;
+        }
+
+        void setup() override {}
+
+      private:
+        std::vector<DirectionalController *> *source;
+        ReplayRecorder *recorder;
+};
+
+class RecordingActionController : public ActionController
+{
+      public:
+        RecordingActionController(std::vector<ActionController *> *source,
+                                  ReplayRecorder *recorder)
+            : source(source), recorder(recorder)
+        {
+        }
+
+        bool poll_for_input(Action *input) override
+        {
+                if (!action_input_registered(source, input)) {
+                        return false;
+                }
+                recorder->record(*input | REPLAY_INPUT_ACTION_BIT);
+                return true;
+        }
+
+        void setup() override {}
+
+      private:
+        std::vector<ActionController *> *source;
+        ReplayRecorder *recorder;
+};
+
+ReplayRecorder::ReplayRecorder(Platform *platform)
+    : platform(platform), start_time(0), last_event_time(0)
+{
+        log = new ReplayLog();
+        directional_controllers = {new RecordingDirectionalController(
+            platform->directional_controllers, this)};
+        action_controllers = {
+            new RecordingActionController(platform->action_controllers, this)};
+        recording_platform = {
+            .display = platform->display,
+            .directional_controllers = &directional_controllers,
+            .action_controllers = &action_controllers,
+            .delay_provider = platform->delay_provider,
+            .persistent_storage = platform->persistent_storage,
+            .record_store = platform->record_store,
+            .settings_cache = platform->settings_cache,
+            .high_scores = platform->high_scores};
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+        delete directional_controllers[0];
+        delete action_controllers[0];
+        delete log;
+}
+
+Platform *ReplayRecorder::start(int game,
+                                UserInterfaceCustomization *customization)
+{
+        start_time = platform->delay_provider->get_time_ms();
+        last_event_time = start_time;
+
+        /* The seed is drawn from the current random sequence, mixing in the
+           time it took the user to go through the menus ensures that we don't
+           replay the same games every time we start the game console. */
+        uint32_t seed = rand() ^ start_time;
+        srand(seed);
+
+        log->header = {.magic = REPLAY_MAGIC,
+                       .version = REPLAY_VERSION,
+                       .game = (uint8_t)game,
+                       .seed = seed,
+                       .duration_ms = 0,
+                       .accent_color = (uint16_t)customization->accent_color,
+                       .rendering_mode =
+                           (uint8_t)customization->rendering_mode,
+                       .truncated = false,
+                       .events = 0,
+                       .reserved = 0};
+
+        LOG_DEBUG(TAG, "Recording game %d with seed %lu", game,
+                  (unsigned long)seed);
+        return &recording_platform;
+}
+
+void ReplayRecorder::record(uint8_t input)
+{
+        ReplayHeader *header = &log->header;
+        unsigned long now = platform->delay_provider->get_time_ms();
+        unsigned long delta = now - last_event_time;
+
+        while (!header->truncated) {
+                // Gaps that don't fit into the time delta are split using
+                // placeholder events.
+                uint16_t event_delta = delta > 0xFFFF ? 0xFFFF : delta;
+                uint8_t event_input =
+                    delta > 0xFFFF ? REPLAY_INPUT_NONE : input;
+
+                if (header->events == REPLAY_MAX_EVENTS) {
+                        LOG_INFO(TAG, "Replay log is full, recording stopped.");
+                        header->truncated = true;
+                        break;
+                }
+                uint8_t *event =
+                    log->events + header->events * REPLAY_EVENT_SIZE;
+                event[0] = event_delta & 0xFF;
+                event[1] = event_delta >> 8;
+                event[2] = event_input;
+                header->events++;
+
+                delta -= event_delta;
+                if (event_input != REPLAY_INPUT_NONE) {
+                        break;
+                }
+        }
+        last_event_time = now;
+}
+
+void ReplayRecorder::finish()
+{
+        log->header.duration_ms =
+            platform->delay_provider->get_time_ms() - start_time;
+        LOG_INFO(TAG, "Recorded %d inputs over %lu ms.", log->header.events,
+                 (unsigned long)log->header.duration_ms);
+        save_replay(log, platform->record_store);
+}
+
+void save_replay(ReplayLog *log, RecordStore *store)
+{
+#ifdef EMULATOR
+        save_replay_file(log, REPLAY_FILE);
+#endif
+        // Longer logs are truncated the same way as the device truncates
+        // them while recording, the header is restored once stored.
+        ReplayHeader header = log->header;
+        if (log->header.events > REPLAY_STORED_MAX_EVENTS) {
+                log->header.events = REPLAY_STORED_MAX_EVENTS;
+                log->header.truncated = true;
+        }
+        // Only the recorded events are stored, so short games take up only
+        // a small part of the record store.
+        int length =
+            sizeof(ReplayHeader) + log->header.events * REPLAY_EVENT_SIZE;
+        if (!store->write(RECORD_KEY_REPLAY, log, length, REPLAY_VERSION)) {
+                LOG_INFO(TAG, "Unable to save the replay.");
+        }
+        log->header = header;
+}
+
+bool load_replay(ReplayLog *log, RecordStore *store)
+{
+        int length = store->read(RECORD_KEY_REPLAY, log,
+                                 sizeof(ReplayHeader) +
+                                     REPLAY_STORED_MAX_EVENTS *
+                                         REPLAY_EVENT_SIZE,
+                                 REPLAY_VERSION);
+        return length >= (int)sizeof(ReplayHeader) &&
+               log->header.magic == REPLAY_MAGIC &&
+               log->header.version == REPLAY_VERSION &&
+               log->header.events <= REPLAY_STORED_MAX_EVENTS &&
+               length == (int)sizeof(ReplayHeader) +
+                             log->header.events * REPLAY_EVENT_SIZE;
+}
+
+#ifdef EMULATOR
+bool save_replay_file(ReplayLog *log, const char *path)
+{
+        std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+        if (!ofs) {
+                LOG_INFO(TAG, "Unable to open %s for writing.", path);
+                return false;
+        }
+        ofs.write(reinterpret_cast<const char *>(&log->header),
+                  sizeof(ReplayHeader));
+        ofs.write(reinterpret_cast<const char *>(log->events),
+                  log->header.events * REPLAY_EVENT_SIZE);
+        return ofs.good();
+}
+
+bool load_replay_file(ReplayLog *log, const char *path)
+{
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) {
+                LOG_INFO(TAG, "Unable to open %s for reading.", path);
+                return false;
+        }
+        ifs.read(reinterpret_cast<char *>(&log->header), sizeof(ReplayHeader));
+        if (!ifs || log->header.magic != REPLAY_MAGIC ||
+            log->header.version != REPLAY_VERSION ||
+            log->header.events > REPLAY_MAX_EVENTS) {
+                LOG_INFO(TAG, "%s is not a valid replay file.", path);
+                return false;
+        }
+        ifs.read(reinterpret_cast<char *>(log->events),
+                 log->header.events * REPLAY_EVENT_SIZE);
+        return ifs.good();
+}
+
+class ReplayDirectionalController : public DirectionalController
+{
+      public:
+        ReplayDirectionalController(ReplayPlayer *player) : player(player) {}
+
+        bool poll_for_input(Direction *input) override
+        {
+                uint8_t recorded;
+                if (!player->poll(false, &recorded)) {
+                        return false;
+                }
+                *input = (Direction)recorded;
+                return true;
+        }
+
+        void setup() override {}
+
+      private:
+        ReplayPlayer *player;
+};
+
+class ReplayActionController : public ActionController
+{
+      public:
+        ReplayActionController(ReplayPlayer *player) : player(player) {}
+
+        bool poll_for_input(Action *input) override
+        {
+                uint8_t recorded;
+                if (!player->poll(true, &recorded)) {
+                        return false;
+                }
+                *input = (Action)recorded;
+                return true;
+        }
+
+        void setup() override {}
+
+      private:
+        ReplayPlayer *player;
+};
+
+ReplayPlayer::ReplayPlayer(ReplayLog *log)
+    : log(log), next_event(0), next_event_time(0)
+{
+        directional_controllers = {new ReplayDirectionalController(this)};
+        action_controllers = {new ReplayActionController(this)};
+        // The replay clock doesn't include the time spent rendering, so it
+        // lags behind the recorded time and a replay that runs past the
+        // recorded duration means that the game is stuck waiting for input.
+        clock.set_time_limit(log->header.duration_ms + REPLAY_IDLE_TIMEOUT_MS);
+}
+
+ReplayPlayer::~ReplayPlayer()
+{
+        delete directional_controllers[0];
+        delete action_controllers[0];
+}
+
+Platform *ReplayPlayer::start(Platform *platform)
+{
+        srand(log->header.seed);
+        replay_platform = {.display = platform->display,
+                           .directional_controllers = &directional_controllers,
+                           .action_controllers = &action_controllers,
+                           .delay_provider = &clock,
+                           .persistent_storage = platform->persistent_storage,
+                           .record_store = platform->record_store,
+                           .settings_cache = platform->settings_cache,
+                           .high_scores = platform->high_scores};
+        return &replay_platform;
+}
+
+bool ReplayPlayer::poll(bool action, uint8_t *input)
+{
+        while (next_event < log->header.events) {
+                uint8_t *event = log->events + next_event * REPLAY_EVENT_SIZE;
+                unsigned long event_time =
+                    next_event_time + (event[0] | (event[1] << 8));
+                if (clock.get_time_ms() < event_time) {
+                        return false;
+                }
+                if (event[2] == REPLAY_INPUT_NONE) {
+                        next_event_time = event_time;
+                        next_event++;
+                        continue;
+                }
+                bool is_action = event[2] & REPLAY_INPUT_ACTION_BIT;
+                if (is_action != action) {
+                        return false;
+                }
+                *input = event[2] & ~REPLAY_INPUT_ACTION_BIT;
+                next_event_time = event_time;
+                next_event++;
+                return true;
+        }
+        return false;
+}
+#endif
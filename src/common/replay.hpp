@@ -0,0 +1,171 @@
+#pragma once
+#include <stdint.h>
+
+#include "platform/headless/null_delay.hpp"
+#include "platform/interface/controller.hpp"
+#include "platform/interface/delay.hpp"
+#include "platform/interface/persistent_storage.hpp"
+#include "record_store.hpp"
+#include "platform/interface/platform.hpp"
+#include "user_interface_customization.hpp"
+
+#define REPLAY_MAGIC 0x5052
+#define REPLAY_VERSION 1
+
+/**
+ * Each event takes three bytes: the number of milliseconds since the previous
+ * event (little endian) followed by the encoded input.
+ */
+#define REPLAY_EVENT_SIZE 3
+#define REPLAY_INPUT_ACTION_BIT 0x80
+/**
+ * Placeholder input used to encode gaps between events that don't fit into
+ * the 16-bit time delta.
+ */
+#define REPLAY_INPUT_NONE 0x7F
+
+/**
+ * The replay of the last game is kept in the record store, it is written once
+ * the game is over. The store only has room for this many events, which is
+ * also the capacity of the log on the device.
+ */
+#define REPLAY_STORED_MAX_EVENTS 256
+
+#ifdef EMULATOR
+#define REPLAY_MAX_EVENTS 4096
+#define REPLAY_FILE "last_game.replay"
+#else
+#define REPLAY_MAX_EVENTS REPLAY_STORED_MAX_EVENTS
+#endif
+
+/**
+ * If the game keeps running for this long after the last recorded input, the
+ * replay is considered to be finished. This happens if the recording was
+ * truncated or the game was interrupted before the user exited it.
+ */
+#define REPLAY_IDLE_TIMEOUT_MS 60000
+
+typedef struct ReplayHeader {
+        uint16_t magic;
+        uint8_t version;
+        /**
+         * Value of the `Game` enum identifying the game executor.
+         */
+        uint8_t game;
+        /**
+         * Seed passed to `srand` right before the game was started.
+         */
+        uint32_t seed;
+        uint32_t duration_ms;
+        uint16_t accent_color;
+        uint8_t rendering_mode;
+        /**
+         * Set if the game produced more inputs than the log can hold, in
+         * which case only the beginning of the game can be replayed.
+         */
+        uint8_t truncated;
+        uint16_t events;
+        uint16_t reserved;
+} ReplayHeader;
+
+typedef struct ReplayLog {
+        ReplayHeader header;
+        uint8_t events[REPLAY_MAX_EVENTS * REPLAY_EVENT_SIZE];
+} ReplayLog;
+
+/**
+ * Records the inputs of a single game together with the random seed it was
+ * started with, which is enough to reproduce the game.
+ *
+ * The inputs are recorded exactly as they come out of
+ * `directional_input_registered` and `action_input_registered`: the recorder
+ * provides a copy of the platform whose controllers forward to the original
+ * ones and log each registered input with its timestamp.
+ */
+class ReplayRecorder
+{
+      public:
+        ReplayRecorder(Platform *platform);
+        ~ReplayRecorder();
+
+        ReplayRecorder(const ReplayRecorder &) = delete;
+        ReplayRecorder &operator=(const ReplayRecorder &) = delete;
+
+        /**
+         * Seeds the random number generator and returns the platform that
+         * needs to be passed to the game to record its inputs.
+         */
+        Platform *start(int game, UserInterfaceCustomization *customization);
+        /**
+         * Finalizes the log and saves it using `save_replay`.
+         */
+        void finish();
+
+        void record(uint8_t input);
+        ReplayLog *get_log() { return log; }
+
+      private:
+        Platform *platform;
+        Platform recording_platform;
+        std::vector<DirectionalController *> directional_controllers;
+        std::vector<ActionController *> action_controllers;
+        ReplayLog *log;
+        unsigned long start_time;
+        unsigned long last_event_time;
+};
+
+/**
+ * Saves the replay log in the record store, trimmed to the recorded events.
+ * Logs longer than `REPLAY_STORED_MAX_EVENTS` are stored truncated, the
+ * emulator also writes the whole log into `REPLAY_FILE`.
+ */
+void save_replay(ReplayLog *log, RecordStore *store);
+/**
+ * Loads the replay of the last game from the record store. The layout is the
+ * same on all platforms, so an EEPROM image of the device can be replayed by
+ * the emulator. Returns false if no valid replay was found.
+ */
+bool load_replay(ReplayLog *log, RecordStore *store);
+
+#ifdef EMULATOR
+bool save_replay_file(ReplayLog *log, const char *path);
+bool load_replay_file(ReplayLog *log, const char *path);
+
+/**
+ * Feeds the recorded inputs back to the game. The replay runs on a clock
+ * that skips all delays, so it is as fast as the game logic and the display
+ * allow. An input is delivered on the first poll of its kind once the replay
+ * clock reaches the time at which it was recorded.
+ *
+ * The game logic driven by the inputs and the seed is reproduced exactly.
+ * The replay clock doesn't include the time spent rendering though, so the
+ * logic paced by the clock (animation frames, snake ticks) can differ slightly
+ * from the recording.
+ */
+class ReplayPlayer
+{
+      public:
+        ReplayPlayer(ReplayLog *log);
+        ~ReplayPlayer();
+
+        ReplayPlayer(const ReplayPlayer &) = delete;
+        ReplayPlayer &operator=(const ReplayPlayer &) = delete;
+
+        /**
+         * Returns the platform that needs to be passed to the game to replay
+         * the inputs. It uses the display and storage of `platform`.
+         */
+        Platform *start(Platform *platform);
+        bool poll(bool action, uint8_t *input);
+        bool is_finished() { return next_event == log->header.events; }
+
+      private:
+        ReplayLog *log;
+        NullDelayProvider clock;
+        Platform replay_platform;
+        std::vector<DirectionalController *> directional_controllers;
+        std::vector<ActionController *> action_controllers;
+        int next_event;
+        unsigned long next_event_time;
+};
+#endif
@@ -4,6 +4,7 @@
 #include "platform/interface/display.hpp"
 #include "../common/logging.hpp"
 #include "constants.hpp"
+#include "fixed_timestep.hpp"
 #include <cassert>
 #include <cstdio>
 #include <cstring>
@@ -456,7 +457,8 @@ void render_config_menu(Display *display, Configuration *config,
 
         for (int i = 0; i < config->options_len; i++) {
                 int bar_y = bar_positions[i];
-                char option_value[max_option_value_length];
+                // One extra byte for the null terminator written by sprintf.
+                char option_value[max_option_value_length + 1];
 
                 ConfigurationOption value = *config->options[i];
                 const char *option_text = value.name;
@@ -601,9 +603,10 @@ void render_wrapped_help_text(Platform *p,
         bool first_word = true;
 
         // We allocate dynamically a copy of the constant string as strtok
-        // needs a mutable reference.
-        char *help_text_copy = (char *)calloc(strlen(help_text), sizeof(char));
-        strncpy(help_text_copy, help_text, strlen(help_text));
+        // needs a mutable reference. The extra byte is the null terminator.
+        char *help_text_copy =
+            (char *)calloc(strlen(help_text) + 1, sizeof(char));
+        strcpy(help_text_copy, help_text);
 
         char *word = strtok((char *)help_text_copy, " ");
         while (word != nullptr) {
@@ -662,19 +665,44 @@ void render_wrapped_help_text(Platform *p,
             Green, 0, true);
 }
 
-void wait_until_green_pressed(Platform *p)
+/**
+ * Waits for the green button to be pressed. The screen doesn't change in the
+ * meantime, so it only needs to be shown once.
+ */
+class GreenButtonWait : public FixedTimestepLoop
 {
-        while (true) {
+      public:
+        GreenButtonWait(Platform *p) : p(p), refresh_pending(true) {}
+
+        bool update() override
+        {
                 Action act;
-                if (action_input_registered(p->action_controllers, &act)) {
-                        if (act == Action::GREEN) {
-                                LOG_DEBUG(TAG, "User confirmed 'OK'");
-                                p->delay_provider->delay_ms(
-                                    MOVE_REGISTERED_DELAY);
-                                return;
-                        }
+                if (action_input_registered(p->action_controllers, &act) &&
+                    act == Action::GREEN) {
+                        LOG_DEBUG(TAG, "User confirmed 'OK'");
+                        return false;
+                }
+                return true;
+        }
+
+        void render() override
+        {
+                if (refresh_pending) {
+                        p->display->refresh();
+                        refresh_pending = false;
                 }
-                p->delay_provider->delay_ms(INPUT_POLLING_DELAY);
-                p->display->refresh();
         }
+
+      private:
+        Platform *p;
+        bool refresh_pending;
+};
+
+void wait_until_green_pressed(Platform *p)
+{
+        GreenButtonWait wait(p);
+        FixedTimestepScheduler scheduler(p->delay_provider,
+                                         INPUT_POLLING_DELAY,
+                                         INPUT_LOOP_MAX_UPDATES_PER_FRAME);
+        scheduler.run(&wait);
 }
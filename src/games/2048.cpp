@@ -4,15 +4,18 @@
 #include <cstring>
 #include <string>
 #include "2048.hpp"
+#include "2048_animation.hpp"
 
 #include "../common/logging.hpp"
 #include "../common/constants.hpp"
+#include "../common/fixed_timestep.hpp"
 #include "../common/platform/interface/display.hpp"
 #include "../common/platform/interface/platform.hpp"
 #include "../common/configuration.hpp"
 
 #include "game_menu.hpp"
 #include "common_transitions.hpp"
+#include "high_scores.hpp"
 #include "settings.hpp"
 
 #define TAG "2048"
@@ -96,6 +99,93 @@ void Clean2048::game_loop(Platform *p,
 }
 
 
+/**
+ * A single 2048 game driven by the `FixedTimestepScheduler`. Each update
+ * handles a single move, the key repeat paces the moves of a held joystick.
+ * The tile slide animation started by a move advances by one frame on each
+ * `render`, so it keeps running in between the moves.
+ */
+class Game2048Session : public FixedTimestepLoop
+{
+      public:
+        Game2048Session(Platform *p, GameState *state, TileLabels *labels,
+                        TileSlideAnimation *animation,
+                        UserInterfaceCustomization *customization)
+            : p(p), state(state), labels(labels), animation(animation),
+              customization(customization), exit_requested(false),
+              changed(false)
+        {
+                moves.reserve(state->grid_size * state->grid_size);
+        }
+
+        bool update() override;
+        void render() override;
+
+        bool is_exit_requested() { return exit_requested; }
+
+      private:
+        void handle_move(Direction dir);
+
+        Platform *p;
+        GameState *state;
+        TileLabels *labels;
+        TileSlideAnimation *animation;
+        UserInterfaceCustomization *customization;
+        std::vector<TileMove> moves;
+        bool exit_requested;
+        /**
+         * Set if the grid was redrawn since the last frame.
+         */
+        bool changed;
+};
+
+bool Game2048Session::update()
+{
+        Direction dir;
+        Action act;
+        if (directional_input_registered(p->directional_controllers, &dir)) {
+                LOG_DEBUG(TAG, "Input received: %s", direction_to_str(dir));
+                handle_move(dir);
+        } else if (action_input_registered(p->action_controllers, &act)) {
+                if (act == Action::BLUE) {
+                        exit_requested = true;
+                        return false;
+                }
+        }
+        return !(is_game_over(state) || is_game_finished(state));
+}
+
+void Game2048Session::handle_move(Direction dir)
+{
+        // A new move interrupts the previous animation, the grid needs to be
+        // brought up to date before the tiles can start sliding again.
+        if (animation->in_progress()) {
+                animation->finish();
+                update_game_grid(p->display, state, labels, customization);
+        }
+        take_turn(state, (int)dir, &moves);
+        animation->start(state, &moves);
+        if (!animation->in_progress()) {
+                update_game_grid(p->display, state, labels, customization);
+        }
+        changed = true;
+}
+
+void Game2048Session::render()
+{
+        if (animation->in_progress()) {
+                if (!animation->step()) {
+                        update_game_grid(p->display, state, labels,
+                                         customization);
+                }
+                changed = true;
+        }
+        if (changed) {
+                p->display->refresh();
+                changed = false;
+        }
+}
+
 UserAction enter_2048_loop(Platform *p,
                            UserInterfaceCustomization *customization)
 {
@@ -109,33 +199,41 @@ UserAction enter_2048_loop(Platform *p,
         GameState *state =
             initialize_game_state(config.grid_size, config.target_max_tile);
 
+        TileLabels labels(p->display);
+
         draw_game_canvas(p->display, state, customization);
-        update_game_grid(p->display, state, customization);
+        update_game_grid(p->display, state, &labels, customization);
         p->display->refresh();
 
-        while (!(is_game_over(state) || is_game_finished(state))) {
-                Direction dir;
-                Action act;
-                if (directional_input_registered(p->directional_controllers,
-                                                 &dir)) {
-                        LOG_DEBUG(TAG, "Input received: %s",
-                                  direction_to_str(dir));
-                        take_turn(state, (int)dir);
-                        update_game_grid(p->display, state, customization);
-                        p->delay_provider->delay_ms(MOVE_REGISTERED_DELAY);
-                } else if (action_input_registered(p->action_controllers,
-                                                   &act)) {
-                        if (act == Action::BLUE) {
-                                LOG_DEBUG(TAG, "User requested to exit game.");
-                                free_game_state(state);
-                                p->delay_provider->delay_ms(
-                                    MOVE_REGISTERED_DELAY);
-                                return UserAction::Exit;
-                        }
-                }
-                p->delay_provider->delay_ms(INPUT_POLLING_DELAY);
-                p->display->refresh();
-        }
+        TileSlideAnimation animation(p->display, p->delay_provider,
+                                     config.grid_size, customization);
+        Game2048Session session(p, state, &labels, &animation,
+                                customization);
+        // The animation frames are drawn by `render`, so the timestep is the
+        // frame interval of the animation. The animation is time-based and
+        // drops the frames it can't fit, there is nothing to catch up on.
+        FixedTimestepScheduler scheduler(p->delay_provider,
+                                         TILE_SLIDE_FRAME_INTERVAL_MS,
+                                         INPUT_LOOP_MAX_UPDATES_PER_FRAME);
+        scheduler.run(&session);
+        if (session.is_exit_requested()) {
+                LOG_DEBUG(TAG, "User requested to exit game.");
+                free_game_state(state);
+                return UserAction::Exit;
+        }
+
+        // The final move could still be animating when the game ends.
+        if (animation.in_progress()) {
+                animation.finish();
+                update_game_grid(p->display, state, &labels, customization);
+        }
+
+        // The score counts whether or not the target tile was reached. The
+        // targets are powers of two, so they are stored by their exponent.
+        uint8_t variant =
+            config.grid_size << 4 | __builtin_ctz(config.target_max_tile);
+        bool new_high_score = p->high_scores->submit(
+            Clean2048, variant, state->score, HigherIsBetter);
 
         if (is_game_over(state)) {
                 display_game_over(p->display, customization);
@@ -143,36 +241,38 @@ UserAction enter_2048_loop(Platform *p,
         if (is_game_finished(state)) {
                 display_game_won(p->display, customization);
         }
+        uint32_t best_score;
+        if (p->high_scores->get_best(Clean2048, variant, &best_score)) {
+                char text[32];
+                snprintf(text, sizeof(text), "Best: %lu",
+                         (unsigned long)best_score);
+                display_high_score(p->display, text, new_high_score);
+        }
 
         pause_until_any_directional_input(p->directional_controllers,
                                           p->delay_provider, p->display);
         return UserAction::PlayAgain;
 }
 
-Game2048Configuration *load_initial_config(PersistentStorage *storage)
+Game2048Configuration *load_initial_config(SettingsCache *settings)
 {
-        int storage_offset = get_settings_storage_offsets()[Clean2048];
-
         Game2048Configuration config = {
             .grid_size = 0,
             .target_max_tile = 0,
         };
 
-        LOG_DEBUG(TAG,
-                  "Trying to load initial settings from the persistent storage "
-                  "at offset %d",
-                  storage_offset);
-        storage->get(storage_offset, config);
+        LOG_DEBUG(TAG, "Trying to load initial settings from the cache.");
+        bool loaded = settings->get(Clean2048, &config);
 
         Game2048Configuration *output = new Game2048Configuration();
 
-        if (config.target_max_tile == 0) {
+        if (!loaded) {
                 LOG_DEBUG(TAG,
                           "The storage does not contain a valid "
                           "2048 game configuration, using default values.");
                 memcpy(output, &DEFAULT_2048_GAME_CONFIG,
                        sizeof(Game2048Configuration));
-                storage->put(storage_offset, DEFAULT_2048_GAME_CONFIG);
+                settings->put(Clean2048, &DEFAULT_2048_GAME_CONFIG);
 
         } else {
                 LOG_DEBUG(TAG, "Using configuration from persistent storage.");
@@ -199,10 +299,10 @@ Game2048Configuration *load_initial_config(PersistentStorage *storage)
  * function below to ensure that the specific game config can be successfully
  * extracted from the generic config struct.
  */
-Configuration *assemble_2048_configuration(PersistentStorage *storage)
+Configuration *assemble_2048_configuration(SettingsCache *settings)
 {
 
-        Game2048Configuration *initial_config = load_initial_config(storage);
+        Game2048Configuration *initial_config = load_initial_config(settings);
 
         // Initialize the first config option: game gridsize
         auto *grid_size = ConfigurationOption::of_integers(
@@ -241,7 +341,7 @@ collect_2048_config(Platform *p, Game2048Configuration *game_config,
                     UserInterfaceCustomization *customization)
 {
         Configuration *config =
-            assemble_2048_configuration(p->persistent_storage);
+            assemble_2048_configuration(p->settings_cache);
 
         auto maybe_interrupt_action =
             collect_configuration(p, config, customization);
@@ -326,8 +426,14 @@ static void spawn_tile(GameState *gs)
 
 /* Helper functions for tile merging */
 
-// Merges the i-th row of tiles in the given direction (left/right).
-static void merge_row(GameState *gs, int i, int direction);
+// Merges the i-th row of tiles in the given direction (left/right). If
+// `moves` is not null, the tile movements are recorded there.
+static void merge_row(GameState *gs, int i, int direction,
+                      std::vector<TileMove> *moves);
+// Maps a tile movement inside of the i-th (possibly reversed or transposed)
+// row back to the actual grid coordinates.
+static TileMove map_row_move(int size, int i, int from, int to, int direction,
+                             bool merged);
 // Reverses a given row of `row_size` elements in place.
 static void reverse(int *row, int row_size);
 // Transposes the game trid in place to allow for merging vertically.
@@ -340,14 +446,14 @@ static int get_successor_index(GameState *gs, int i, int current_index);
  * the tiles in a vertical direction we first transpose the grid, merge and then
  * transpose back.
  */
-static void merge(GameState *gs, int direction)
+static void merge(GameState *gs, int direction, std::vector<TileMove> *moves)
 {
         if (direction == UP || direction == DOWN) {
                 transpose(gs);
         }
 
         for (int i = 0; i < gs->grid_size; i++) {
-                merge_row(gs, i, direction);
+                merge_row(gs, i, direction, moves);
         }
 
         if (direction == UP || direction == DOWN) {
@@ -355,7 +461,8 @@ static void merge(GameState *gs, int direction)
         }
 }
 
-static void merge_row(GameState *gs, int i, int direction)
+static void merge_row(GameState *gs, int i, int direction,
+                      std::vector<TileMove> *moves)
 {
         int curr = 0;
         int *merged_row = (int *)malloc(gs->grid_size * sizeof(int));
@@ -390,9 +497,24 @@ static void merge_row(GameState *gs, int i, int direction)
                         gs->score += sum;
                         gs->occupied_tiles--;
                         merged_row[merged_num] = sum;
+                        if (moves && curr != merged_num) {
+                                moves->push_back(map_row_move(
+                                    size, i, curr, merged_num, direction,
+                                    false));
+                        }
+                        if (moves) {
+                                moves->push_back(map_row_move(
+                                    size, i, succ, merged_num, direction,
+                                    true));
+                        }
                         curr = get_successor_index(gs, i, succ);
                 } else {
                         merged_row[merged_num] = curr_val;
+                        if (moves && curr != merged_num) {
+                                moves->push_back(map_row_move(
+                                    size, i, curr, merged_num, direction,
+                                    false));
+                        }
                         curr = succ;
                 }
                 merged_num++;
@@ -408,6 +530,32 @@ static void merge_row(GameState *gs, int i, int direction)
         free(merged_row);
 }
 
+static TileMove map_row_move(int size, int i, int from, int to, int direction,
+                             bool merged)
+{
+        // Rows that are merged to the right (or down) are reversed before
+        // merging, so we need to map the indices back.
+        if (direction == DOWN || direction == RIGHT) {
+                from = size - 1 - from;
+                to = size - 1 - to;
+        }
+
+        // For vertical merges the grid is transposed, which means that the
+        // i-th row is actually the i-th column of the grid.
+        if (direction == UP || direction == DOWN) {
+                return {.from_row = from,
+                        .from_col = i,
+                        .to_row = to,
+                        .to_col = i,
+                        .merged = merged};
+        }
+        return {.from_row = i,
+                .from_col = from,
+                .to_row = i,
+                .to_col = to,
+                .merged = merged};
+}
+
 // Reverses a given row of four elements in place
 static void reverse(int *row, int row_size)
 {
@@ -467,11 +615,14 @@ static bool is_board_full(GameState *gs)
         return gs->occupied_tiles >= gs->grid_size * gs->grid_size;
 }
 
-void take_turn(GameState *gs, int direction)
+void take_turn(GameState *gs, int direction, std::vector<TileMove> *moves)
 {
+        if (moves) {
+                moves->clear();
+        }
         int **oldGrid = create_game_grid(gs->grid_size);
         copy_grid(gs->grid, oldGrid, gs->grid_size);
-        merge(gs, direction);
+        merge(gs, direction, moves);
 
         if (grid_changed_from(gs, oldGrid)) {
                 spawn_tile(gs);
@@ -548,45 +699,6 @@ void draw_game_canvas(Display *display, GameState *state,
         draw_game_grid(display, state->grid_size, customization);
 }
 
-/**
- * Class storing all dimensional information required to properly render
- * and space out the grid slots that are used to display the game tiles.
- */
-class GridDimensions
-{
-      public:
-        int cell_height;
-        int cell_width;
-        int cell_x_spacing;
-        int cell_y_spacing;
-        /* Padding added to the left of the grid if the available
-        space isn't evenly divided into grid_size */
-        int padding;
-        int grid_start_x;
-        int grid_start_y;
-        int score_cell_height;
-        int score_cell_width;
-        int score_start_x;
-        int score_start_y;
-        int score_title_x;
-        int score_title_y;
-
-        GridDimensions(int cell_height, int cell_width, int cell_x_spacing,
-                       int cell_y_spacing, int padding, int grid_start_x,
-                       int grid_start_y, int score_cell_height,
-                       int score_cell_width, int score_start_x,
-                       int score_start_y, int score_title_x, int score_title_y)
-            : cell_height(cell_height), cell_width(cell_width),
-              cell_x_spacing(cell_x_spacing), cell_y_spacing(cell_y_spacing),
-              padding(padding), grid_start_x(grid_start_x),
-              grid_start_y(grid_start_y), score_cell_height(score_cell_height),
-              score_cell_width(score_cell_width), score_start_x(score_start_x),
-              score_start_y(score_start_y), score_title_x(score_title_x),
-              score_title_y(score_title_y)
-        {
-        }
-};
-
 GridDimensions *calculate_grid_dimensions(Display *display, int grid_size)
 {
         int height = display->get_height();
@@ -687,118 +799,105 @@ static void draw_game_grid(Display *display, int grid_size,
         }
 }
 
-static void str_replace(char *str, const char *oldWord, const char *newWord);
-static int number_string_length(int number);
-
-void update_game_grid(Display *display, GameState *gs,
+void update_game_grid(Display *display, GameState *gs, TileLabels *labels,
                       UserInterfaceCustomization *customization)
 {
         int grid_size = gs->grid_size;
         GridDimensions *gd = calculate_grid_dimensions(display, grid_size);
 
         int score_title_length = 6 * FONT_WIDTH;
-        char score_buffer[20];
-        sprintf(score_buffer, "%d", gs->score);
-
         int score_rounding_radius = gd->score_cell_height / 2;
 
-        Point clear_start = {.x = gd->score_title_x + score_title_length +
-                                  FONT_WIDTH,
-                             .y = gd->score_title_y};
-        Point clear_end = {.x = gd->score_start_x + gd->score_cell_width -
-                                score_rounding_radius,
-                           .y = gd->score_title_y + FONT_SIZE};
-
-        display->clear_region(clear_start, clear_end, GRID_BG_COLOR);
-
         Point score_start = {.x = gd->score_title_x + score_title_length +
                                   FONT_WIDTH,
                              .y = gd->score_title_y};
+        int score_end_x =
+            gd->score_start_x + gd->score_cell_width - score_rounding_radius;
 
-        display->draw_string(score_start, score_buffer, Size16, GRID_BG_COLOR,
-                             TEXT_COLOR);
+        // The score label is padded with blank space up to the end of the
+        // score slot, so blitting it overwrites the previous score entirely.
+        int score_length = (score_end_x - score_start.x) / FONT_WIDTH;
+        if (score_length > SCORE_LABEL_MAX_LENGTH) {
+                score_length = SCORE_LABEL_MAX_LENGTH;
+        }
+        display->draw_bitmap(score_start, score_length * FONT_WIDTH, FONT_SIZE,
+                             labels->get_score_label(gs->score, score_length),
+                             GRID_BG_COLOR, TEXT_COLOR);
 
-        // The maximum tile number in this version of 2048 is 4096, because of
-        // this the maximum width of the cell text area is given below.
-        int max_cell_text_width = 4 * FONT_WIDTH;
+        int label_width = labels->get_label_width();
+        int label_height = labels->get_label_height();
 
         for (int i = 0; i < grid_size; i++) {
                 for (int j = 0; j < grid_size; j++) {
+                        if (gs->grid[i][j] == gs->old_grid[i][j]) {
+                                continue;
+                        }
                         Point start = {
                             .x = gd->grid_start_x +
                                  j * (gd->cell_width + gd->cell_x_spacing),
                             .y = gd->grid_start_y +
                                  i * (gd->cell_height + gd->cell_y_spacing)};
 
-                        if (gs->grid[i][j] != gs->old_grid[i][j]) {
-
-                                char buffer[5];
-                                sprintf(buffer, "%4d", gs->grid[i][j]);
-                                str_replace(buffer, "   0", "    ");
-
-                                // We need to center the four characters of text
-                                // inside the cell.
-                                int x_margin =
-                                    (gd->cell_width - max_cell_text_width) / 2;
-                                int y_margin =
-                                    (gd->cell_height - FONT_SIZE) / 2;
-                                int old_digit_len =
-                                    number_string_length(gs->old_grid[i][j]);
-                                int old_digit_text_width =
-                                    old_digit_len * FONT_WIDTH;
-
-                                // We clear the region where the old number was
-                                // drawn, note that we need to be efficient, so
-                                // instead of clearing all 4 possible
-                                // characters, we only clear the characters of
-                                // the actual number. So if the number is
-                                // composed of two digits, we clear a region
-                                // that spans two digits.
-                                Point clear_start = {.x = start.x + x_margin +
-                                                          max_cell_text_width -
-                                                          old_digit_text_width,
-                                                     .y = start.y + y_margin};
-                                Point clear_end = {.x = start.x + x_margin +
-                                                        max_cell_text_width,
-                                                   .y = start.y + y_margin +
-                                                        FONT_SIZE};
-                                display->clear_region(clear_start, clear_end,
-                                                      GRID_BG_COLOR);
-
-                                Point start_with_margin = {
-                                    .x = start.x + x_margin,
-                                    .y = start.y + y_margin};
-                                display->draw_string(start_with_margin, buffer,
-                                                     Size16, GRID_BG_COLOR,
-                                                     TEXT_COLOR);
-                                gs->old_grid[i][j] = gs->grid[i][j];
-                        }
+                        // We need to center the label inside the cell. Labels
+                        // span all four characters so the blit fully
+                        // overwrites the previous number.
+                        Point label_start = {
+                            .x = start.x + (gd->cell_width - label_width) / 2,
+                            .y = start.y + (gd->cell_height - label_height) / 2};
+                        display->draw_bitmap(label_start, label_width,
+                                             label_height,
+                                             labels->get_tile_label(
+                                                 gs->grid[i][j]),
+                                             GRID_BG_COLOR, TEXT_COLOR);
+                        gs->old_grid[i][j] = gs->grid[i][j];
                 }
         }
         free(gd);
 }
 
-static int number_string_length(int number)
+TileLabels::TileLabels(Display *display)
 {
-        if (number >= 1000) {
-                return 4;
-        } else if (number >= 100) {
-                return 3;
-        } else if (number >= 10) {
-                return 2;
+        digits = new GlyphCache(display, Size16, "0123456789");
+        label_size = digits->mask_size(TILE_LABEL_LENGTH);
+        tile_labels = new uint8_t[TILE_VALUES_NUM * label_size];
+        score_label = new uint8_t[digits->mask_size(SCORE_LABEL_MAX_LENGTH)];
+
+        // Label at index 0 is the empty tile, the i-th label is 2^i.
+        char buffer[TILE_LABEL_LENGTH + 1];
+        for (int i = 0; i < TILE_VALUES_NUM; i++) {
+                if (i == 0) {
+                        sprintf(buffer, "%*s", TILE_LABEL_LENGTH, "");
+                } else {
+                        sprintf(buffer, "%*d", TILE_LABEL_LENGTH, 1 << i);
+                }
+                digits->compose(buffer, TILE_LABEL_LENGTH,
+                                tile_labels + i * label_size);
         }
-        return 1;
+        LOG_DEBUG(TAG, "Pre-rendered %d tile labels using %d bytes",
+                  TILE_VALUES_NUM, TILE_VALUES_NUM * label_size);
 }
 
-static void str_replace(char *str, const char *oldWord, const char *newWord)
+TileLabels::~TileLabels()
 {
-        std::string wrapped_str(str);
-        std::string to_replace(oldWord);
-        std::string replacement(newWord);
+        delete digits;
+        delete[] tile_labels;
+        delete[] score_label;
+}
 
-        size_t pos = wrapped_str.find(to_replace);
-        if (pos != std::string::npos) {
-                wrapped_str.replace(pos, to_replace.length(), replacement);
+const uint8_t *TileLabels::get_tile_label(int value)
+{
+        int idx = 0;
+        while (value > 1 && idx < TILE_VALUES_NUM - 1) {
+                value >>= 1;
+                idx++;
         }
-        std::strcpy(str, wrapped_str.c_str());
+        return tile_labels + idx * label_size;
+}
+
+const uint8_t *TileLabels::get_score_label(int score, int length)
+{
+        char buffer[SCORE_LABEL_MAX_LENGTH + 1];
+        snprintf(buffer, sizeof(buffer), "%d", score);
+        digits->compose(buffer, length, score_label);
+        return score_label;
 }
@@ -3,6 +3,8 @@
 #include "../common/platform/interface/display.hpp"
 #include "../common/platform/interface/platform.hpp"
 #include "../common/configuration.hpp"
+#include "../common/constants.hpp"
+#include "../common/glyph_cache.hpp"
 
 #include "common_transitions.hpp"
 #include "game_executor.hpp"
@@ -31,6 +33,123 @@ class GameState
         }
 };
 
+/**
+ * Describes how a single tile travelled across the grid when a turn was taken.
+ * Rows and columns follow the `grid[row][col]` indexing of the `GameState`.
+ * This is used for animating the tiles sliding into their new positions.
+ */
+typedef struct TileMove {
+        int from_row;
+        int from_col;
+        int to_row;
+        int to_col;
+        /**
+         * Set if the tile merged with the tile that was already present at
+         * the destination.
+         */
+        bool merged;
+} TileMove;
+
+/**
+ * Tiles in `old_grid` that are set to this value are considered to have
+ * unknown contents on the display and are fully redrawn by the next call to
+ * `update_game_grid`. This is used after tile animations draw over the tiles.
+ */
+#define INVALIDATED_TILE -1
+
+/**
+ * Class storing all dimensional information required to properly render
+ * and space out the grid slots that are used to display the game tiles.
+ */
+class GridDimensions
+{
+      public:
+        int cell_height;
+        int cell_width;
+        int cell_x_spacing;
+        int cell_y_spacing;
+        /* Padding added to the left of the grid if the available
+        space isn't evenly divided into grid_size */
+        int padding;
+        int grid_start_x;
+        int grid_start_y;
+        int score_cell_height;
+        int score_cell_width;
+        int score_start_x;
+        int score_start_y;
+        int score_title_x;
+        int score_title_y;
+
+        GridDimensions(int cell_height, int cell_width, int cell_x_spacing,
+                       int cell_y_spacing, int padding, int grid_start_x,
+                       int grid_start_y, int score_cell_height,
+                       int score_cell_width, int score_start_x,
+                       int score_start_y, int score_title_x, int score_title_y)
+            : cell_height(cell_height), cell_width(cell_width),
+              cell_x_spacing(cell_x_spacing), cell_y_spacing(cell_y_spacing),
+              padding(padding), grid_start_x(grid_start_x),
+              grid_start_y(grid_start_y), score_cell_height(score_cell_height),
+              score_cell_width(score_cell_width), score_start_x(score_start_x),
+              score_start_y(score_start_y), score_title_x(score_title_x),
+              score_title_y(score_title_y)
+        {
+        }
+};
+
+GridDimensions *calculate_grid_dimensions(Display *display, int grid_size);
+
+/**
+ * The maximum tile number in this version of 2048 is 4096, so tile labels are
+ * at most four characters long.
+ */
+#define TILE_LABEL_LENGTH 4
+/**
+ * Number of distinct tile values: the empty tile and powers of two up to 4096.
+ */
+#define TILE_VALUES_NUM 13
+/**
+ * Upper bound on the number of digits of the score that we ever render.
+ */
+#define SCORE_LABEL_MAX_LENGTH 10
+
+/**
+ * Cache of pre-rendered tile labels. The set of possible tile values is tiny,
+ * so we compose the masks of all of them once at the start of the game and
+ * then updating a tile is a single bitmap blit instead of clearing the old
+ * number and drawing the new one glyph by glyph. The score is assembled from
+ * the cached digit glyphs in the same way.
+ *
+ * We store 1-bit-per-pixel masks instead of RGB565 bitmaps and expand them
+ * while blitting, as RGB565 labels for all values wouldn't fit into the RAM
+ * of the Arduino.
+ */
+class TileLabels
+{
+      public:
+        TileLabels(Display *display);
+        ~TileLabels();
+
+        /**
+         * Returns the mask of the label of a tile with the given value. Empty
+         * tiles have a blank label.
+         */
+        const uint8_t *get_tile_label(int value);
+        /**
+         * Composes the mask of the score label that is `length` characters
+         * long (left-aligned and padded with blank space).
+         */
+        const uint8_t *get_score_label(int score, int length);
+
+        int get_label_width() { return TILE_LABEL_LENGTH * FONT_WIDTH; }
+        int get_label_height() { return FONT_SIZE; }
+
+      private:
+        GlyphCache *digits;
+        int label_size;
+        uint8_t *tile_labels;
+        uint8_t *score_label;
+};
+
 /**
  * Similar to `collect_configuration` from `configuration.hpp`, it returns true
  * if the configuration was successfully collected. Otherwise, if the user
@@ -44,13 +163,19 @@ collect_2048_config(Platform *p, Game2048Configuration *game_config,
 GameState *initialize_game_state(int gridSize, int target_max_tile);
 
 void draw(Display *display, GameState *state);
-void update_game_grid(Display *display, GameState *gs,
+void update_game_grid(Display *display, GameState *gs, TileLabels *labels,
                       UserInterfaceCustomization *customization);
 
 void initialize_randomness_seed(int seed);
 bool is_game_over(GameState *gs);
 bool is_game_finished(GameState *gs);
-void take_turn(GameState *gs, int direction);
+/**
+ * Shifts the tiles in the given direction and spawns a new tile if anything
+ * moved. If `moves` is provided, it is cleared and populated with the list of
+ * tiles that changed their position so that the movement can be animated.
+ */
+void take_turn(GameState *gs, int direction,
+               std::vector<TileMove> *moves = nullptr);
 
 class Clean2048 : public GameExecutor
 {
@@ -0,0 +1,353 @@
+#include <climits>
+#include <cstdlib>
+
+#include "2048_animation.hpp"
+
+#include "../common/logging.hpp"
+
+#define TAG "2048_animation"
+
+/**
+ * Marks moves whose strip is not currently drawn on the screen. Offsets can be
+ * negative for tiles moving left or up, hence we can't use -1 here.
+ */
+#define NOT_DRAWN INT_MIN
+
+/**
+ * Weight of the most recent throughput measurement in the moving average.
+ */
+#define THROUGHPUT_SMOOTHING 0.3f
+
+// Those need to be kept in sync with the colors used to render the grid in
+// 2048.cpp, as the animation restores the grid background behind the strips.
+static const Color SLOT_BG_COLOR = White;
+static const Color GAP_BG_COLOR = Black;
+
+TileSlideAnimation::TileSlideAnimation(
+    Display *display, DelayProvider *clock, int grid_size,
+    UserInterfaceCustomization *customization)
+    : display(display), clock(clock),
+      gd(calculate_grid_dimensions(display, grid_size)),
+      customization(customization), gs(nullptr), moves(nullptr),
+      start_time(0), active(false), frames_rendered(0), frames_dropped(0),
+      pixels_per_ms(0)
+{
+        // At most every tile on the grid can move in a single turn, we
+        // reserve the space upfront to avoid reallocations mid-game.
+        drawn_offsets.reserve(grid_size * grid_size);
+}
+
+TileSlideAnimation::~TileSlideAnimation() { delete gd; }
+
+void TileSlideAnimation::start(GameState *gs, std::vector<TileMove> *moves)
+{
+        if (active) {
+                finish();
+        }
+        this->gs = gs;
+        this->moves = moves;
+        frames_rendered = 0;
+        frames_dropped = 0;
+
+        if (moves->empty()) {
+                return;
+        }
+
+        // If we already know that the display cannot render even a single
+        // frame of the animation within the time budget, we skip it entirely
+        // and let the grid update render the final state right away.
+        if (pixels_per_ms > 0) {
+                int min_frame_pixels = 0;
+                for (TileMove &move : *moves) {
+                        min_frame_pixels +=
+                            strip_length(&move) * TILE_SLIDE_STRIP_THICKNESS;
+                }
+                if (min_frame_pixels / pixels_per_ms > TILE_SLIDE_DURATION_MS) {
+                        LOG_DEBUG(TAG,
+                                  "Skipping animation, estimated frame time "
+                                  "exceeds the animation duration.");
+                        return;
+                }
+        }
+
+        drawn_offsets.assign(moves->size(), NOT_DRAWN);
+        start_time = clock->get_time_ms();
+        active = true;
+}
+
+bool TileSlideAnimation::step()
+{
+        if (!active) {
+                return false;
+        }
+
+        unsigned long frame_start = clock->get_time_ms();
+        unsigned long elapsed = frame_start - start_time;
+        if (elapsed >= TILE_SLIDE_DURATION_MS) {
+                finish();
+                return false;
+        }
+
+        float progress = (float)elapsed / TILE_SLIDE_DURATION_MS;
+
+        // Before rendering, we estimate how many pixels need to be sent to
+        // the display. If this frame would not be complete before the
+        // animation is over, we drop it and jump straight to the end.
+        if (pixels_per_ms > 0) {
+                int estimated_pixels = 0;
+                for (size_t i = 0; i < moves->size(); i++) {
+                        TileMove *move = &(*moves)[i];
+                        int offset = (int)(move_distance(move) * progress);
+                        int travelled = strip_length(move);
+                        if (drawn_offsets[i] != NOT_DRAWN &&
+                            abs(offset - drawn_offsets[i]) < travelled) {
+                                travelled = abs(offset - drawn_offsets[i]);
+                        }
+                        estimated_pixels +=
+                            2 * travelled * TILE_SLIDE_STRIP_THICKNESS;
+                }
+                unsigned long remaining = TILE_SLIDE_DURATION_MS - elapsed;
+                if (estimated_pixels / pixels_per_ms > remaining) {
+                        frames_dropped++;
+                        finish();
+                        return false;
+                }
+        }
+
+        int pixels = render_frame(progress);
+        display->refresh();
+        frames_rendered++;
+
+        unsigned long frame_time = clock->get_time_ms() - frame_start;
+        if (frame_time > 0 && pixels > 0) {
+                float sample = (float)pixels / frame_time;
+                pixels_per_ms =
+                    pixels_per_ms == 0
+                        ? sample
+                        : (1 - THROUGHPUT_SMOOTHING) * pixels_per_ms +
+                              THROUGHPUT_SMOOTHING * sample;
+        }
+#ifdef EMULATOR
+        LOG_DEBUG(TAG, "Frame %d rendered in %lu ms (%d pixels)",
+                  frames_rendered, frame_time, pixels);
+#endif
+        return true;
+}
+
+void TileSlideAnimation::finish()
+{
+        if (!active) {
+                return;
+        }
+
+        for (size_t i = 0; i < moves->size(); i++) {
+                int offset = drawn_offsets[i];
+                if (offset != NOT_DRAWN) {
+                        TileMove *move = &(*moves)[i];
+                        draw_strip(move, offset, offset + strip_length(move),
+                                   true);
+                        drawn_offsets[i] = NOT_DRAWN;
+                }
+        }
+
+        if (frames_rendered > 0) {
+                invalidate_touched_tiles();
+        }
+        active = false;
+
+        LOG_DEBUG(TAG, "Animation finished: %d frames rendered, %d dropped",
+                  frames_rendered, frames_dropped);
+}
+
+int TileSlideAnimation::render_frame(float progress)
+{
+        int pixels = 0;
+        for (size_t i = 0; i < moves->size(); i++) {
+                int offset = (int)(move_distance(&(*moves)[i]) * progress);
+                pixels += render_move(i, offset);
+        }
+        return pixels;
+}
+
+/**
+ * Moves the strip of the given move to the new offset, only the pixels that
+ * differ between the old and the new position of the strip are rendered.
+ * Returns the number of pixels written to the display.
+ */
+int TileSlideAnimation::render_move(int move_idx, int new_offset)
+{
+        TileMove *move = &(*moves)[move_idx];
+        int length = strip_length(move);
+        int old_offset = drawn_offsets[move_idx];
+        drawn_offsets[move_idx] = new_offset;
+
+        if (old_offset == new_offset) {
+                return 0;
+        }
+
+        // Strips that moved further than their own length don't overlap
+        // with their previous position, we need to redraw them in full.
+        if (old_offset == NOT_DRAWN || abs(new_offset - old_offset) >= length) {
+                if (old_offset != NOT_DRAWN) {
+                        draw_strip(move, old_offset, old_offset + length, true);
+                }
+                draw_strip(move, new_offset, new_offset + length, false);
+                int erased = old_offset == NOT_DRAWN ? 0 : length;
+                return (length + erased) * TILE_SLIDE_STRIP_THICKNESS;
+        }
+
+        int travelled = abs(new_offset - old_offset);
+        if (new_offset > old_offset) {
+                draw_strip(move, old_offset, new_offset, true);
+                draw_strip(move, old_offset + length, new_offset + length,
+                           false);
+        } else {
+                draw_strip(move, new_offset + length, old_offset + length,
+                           true);
+                draw_strip(move, new_offset, old_offset, false);
+        }
+        return 2 * travelled * TILE_SLIDE_STRIP_THICKNESS;
+}
+
+/**
+ * Draws (or erases) the part of the strip of the given move that spans
+ * between the two offsets measured from the origin of the source tile.
+ */
+void TileSlideAnimation::draw_strip(TileMove *move, int from, int to,
+                                    bool erase)
+{
+        if (from >= to) {
+                return;
+        }
+        if (erase) {
+                restore_background_run(move, from, to);
+                return;
+        }
+
+        bool horizontal = move->from_row == move->to_row;
+        Point origin = tile_origin(move->from_row, move->from_col);
+        int thickness = TILE_SLIDE_STRIP_THICKNESS;
+        Point top_left;
+        Point bottom_right;
+        if (horizontal) {
+                int y = origin.y + (gd->cell_height - thickness) / 2;
+                top_left = {.x = origin.x + from, .y = y};
+                bottom_right = {.x = origin.x + to, .y = y + thickness};
+        } else {
+                int x = origin.x + (gd->cell_width - thickness) / 2;
+                top_left = {.x = x, .y = origin.y + from};
+                bottom_right = {.x = x + thickness, .y = origin.y + to};
+        }
+        display->clear_region(top_left, bottom_right,
+                              customization->accent_color);
+}
+
+/**
+ * Restores the grid background behind the given part of the strip. The strip
+ * can span over the grid slots as well as the gaps between them, so we split
+ * it into runs of uniform background color and clear each of them separately.
+ */
+void TileSlideAnimation::restore_background_run(TileMove *move, int from,
+                                                int to)
+{
+        bool horizontal = move->from_row == move->to_row;
+        Point origin = tile_origin(move->from_row, move->from_col);
+        int thickness = TILE_SLIDE_STRIP_THICKNESS;
+
+        int grid_start = horizontal ? gd->grid_start_x : gd->grid_start_y;
+        int cell_span = horizontal ? gd->cell_width : gd->cell_height;
+        int pitch = cell_span +
+                    (horizontal ? gd->cell_x_spacing : gd->cell_y_spacing);
+        int axis_origin = horizontal ? origin.x : origin.y;
+
+        int position = axis_origin + from;
+        int end = axis_origin + to;
+        while (position < end) {
+                int relative = position - grid_start;
+                int within_pitch = relative % pitch;
+                bool inside_slot = within_pitch < cell_span;
+                int run_end = position + (inside_slot
+                                              ? cell_span - within_pitch
+                                              : pitch - within_pitch);
+                if (run_end > end) {
+                        run_end = end;
+                }
+
+                Point top_left;
+                Point bottom_right;
+                if (horizontal) {
+                        int y = origin.y + (gd->cell_height - thickness) / 2;
+                        top_left = {.x = position, .y = y};
+                        bottom_right = {.x = run_end, .y = y + thickness};
+                } else {
+                        int x = origin.x + (gd->cell_width - thickness) / 2;
+                        top_left = {.x = x, .y = position};
+                        bottom_right = {.x = x + thickness, .y = run_end};
+                }
+                display->clear_region(top_left, bottom_right,
+                                      inside_slot ? SLOT_BG_COLOR
+                                                  : GAP_BG_COLOR);
+                position = run_end;
+        }
+}
+
+/**
+ * The strips are drawn on top of the tile numbers (and the slot borders in the
+ * minimalistic rendering mode), so once the animation is over, all tiles that
+ * the strips travelled over need to be fully redrawn.
+ */
+void TileSlideAnimation::invalidate_touched_tiles()
+{
+        for (TileMove &move : *moves) {
+                int row_step = move.to_row > move.from_row   ? 1
+                               : move.to_row < move.from_row ? -1
+                                                             : 0;
+                int col_step = move.to_col > move.from_col   ? 1
+                               : move.to_col < move.from_col ? -1
+                                                             : 0;
+                int row = move.from_row;
+                int col = move.from_col;
+                while (true) {
+                        gs->old_grid[row][col] = INVALIDATED_TILE;
+                        if (customization->rendering_mode == Minimalistic) {
+                                display->draw_rectangle(
+                                    tile_origin(row, col), gd->cell_width,
+                                    gd->cell_height,
+                                    customization->accent_color, 2, false);
+                        }
+                        if (row == move.to_row && col == move.to_col) {
+                                break;
+                        }
+                        row += row_step;
+                        col += col_step;
+                }
+        }
+}
+
+Point TileSlideAnimation::tile_origin(int row, int col)
+{
+        return {.x = gd->grid_start_x +
+                     col * (gd->cell_width + gd->cell_x_spacing),
+                .y = gd->grid_start_y +
+                     row * (gd->cell_height + gd->cell_y_spacing)};
+}
+
+/**
+ * Returns the signed distance in pixels between the source and destination
+ * tile along the axis of the movement.
+ */
+int TileSlideAnimation::move_distance(TileMove *move)
+{
+        Point from = tile_origin(move->from_row, move->from_col);
+        Point to = tile_origin(move->to_row, move->to_col);
+        if (move->from_row == move->to_row) {
+                return to.x - from.x;
+        }
+        return to.y - from.y;
+}
+
+int TileSlideAnimation::strip_length(TileMove *move)
+{
+        return move->from_row == move->to_row ? gd->cell_width
+                                              : gd->cell_height;
+}
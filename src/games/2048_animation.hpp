@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+
+#include "../common/platform/interface/delay.hpp"
+#include "../common/platform/interface/display.hpp"
+#include "../common/user_interface_customization.hpp"
+#include "2048.hpp"
+
+/**
+ * Total duration of a single tile slide animation. The animation is
+ * time-based, if the display is not able to keep up, intermediate frames are
+ * dropped instead of making the animation longer.
+ */
+#define TILE_SLIDE_DURATION_MS 120
+/**
+ * Interval between consecutive animation frames. It is also the timestep of
+ * the 2048 game loop, which polls for input at this rate.
+ */
+#define TILE_SLIDE_FRAME_INTERVAL_MS 16
+/**
+ * Thickness of the strip that represents a tile sliding across the grid. We
+ * only ever draw a thin strip along the middle of the tile because redrawing
+ * entire tiles on each frame would exceed the SPI bandwidth of the LCD.
+ */
+#define TILE_SLIDE_STRIP_THICKNESS 4
+
+/**
+ * Schedules and renders the tile slide animations of 2048.
+ *
+ * Each moving tile is represented by a strip travelling from the source slot
+ * to the destination slot. On every frame only the leading edge of the strip
+ * is drawn and its trailing edge is restored to the background, so the number
+ * of pixels written is proportional to the distance travelled since the last
+ * frame and not to the size of the tiles.
+ *
+ * The animation never blocks: the game loop calls `step` between polling for
+ * input and is free to `finish` the animation early if the user makes another
+ * move. The throughput of the display is measured on each frame and frames
+ * that would not fit into the animation budget are dropped.
+ */
+class TileSlideAnimation
+{
+      public:
+        TileSlideAnimation(Display *display, DelayProvider *clock,
+                           int grid_size,
+                           UserInterfaceCustomization *customization);
+        ~TileSlideAnimation();
+
+        /**
+         * Starts animating the tile `moves` recorded by `take_turn`. The
+         * moves vector needs to stay unmodified until the animation finishes.
+         */
+        void start(GameState *gs, std::vector<TileMove> *moves);
+
+        /**
+         * Renders the next frame of the animation. Returns false once the
+         * animation is complete, at which point all tiles touched by the
+         * animation are invalidated and need to be redrawn by
+         * `update_game_grid`.
+         */
+        bool step();
+
+        /**
+         * Finishes the animation immediately, erasing all strips that are
+         * still on the screen.
+         */
+        void finish();
+
+        bool in_progress() { return active; }
+
+      private:
+        int render_frame(float progress);
+        int render_move(int move_idx, int new_offset);
+        void draw_strip(TileMove *move, int from, int to, bool erase);
+        void restore_background_run(TileMove *move, int from, int to);
+        void invalidate_touched_tiles();
+        Point tile_origin(int row, int col);
+        int move_distance(TileMove *move);
+        int strip_length(TileMove *move);
+
+        Display *display;
+        DelayProvider *clock;
+        GridDimensions *gd;
+        UserInterfaceCustomization *customization;
+
+        GameState *gs;
+        std::vector<TileMove> *moves;
+        /**
+         * For each move, the offset (in pixels from the source tile) at
+         * which its strip is currently drawn on the screen.
+         */
+        std::vector<int> drawn_offsets;
+        unsigned long start_time;
+        bool active;
+        int frames_rendered;
+        int frames_dropped;
+        /**
+         * Exponential moving average of the measured display throughput. It is
+         * kept across animations so that we learn how fast the display is.
+         */
+        float pixels_per_ms;
+};
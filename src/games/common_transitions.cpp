@@ -1,5 +1,6 @@
 #include "common_transitions.hpp"
 #include "../common/constants.hpp"
+#include "../common/fixed_timestep.hpp"
 
 void display_input_clafification(Display *display)
 {
@@ -77,19 +78,86 @@ void display_game_won(Display *display,
         display_input_clafification(display);
 }
 
+void display_high_score(Display *display, const char *best_score,
+                        bool new_high_score)
+{
+        int height = display->get_height();
+        int width = display->get_width();
+
+        if (new_high_score) {
+                const char *msg = "New high score!";
+                int x_pos = (width - strlen(msg) * FONT_WIDTH) / 2;
+                int y_pos = (height - FONT_SIZE) / 2 - 3 * FONT_SIZE;
+                Point text_position = {.x = x_pos, .y = y_pos};
+
+                display->draw_string(text_position, (char *)msg, Size16,
+                                     Black, Yellow);
+        }
+
+        int x_pos = (width - strlen(best_score) * FONT_WIDTH) / 2;
+        int y_pos = (height - FONT_SIZE) / 2 - 2 * FONT_SIZE;
+        Point text_position = {.x = x_pos, .y = y_pos};
+
+        display->draw_string(text_position, (char *)best_score, Size16, Black,
+                             White);
+}
+
+/**
+ * Waits for any input of the given controllers. The screen doesn't change in
+ * the meantime, so it is only refreshed once. On the emulator the window
+ * events are still processed while waiting, the controllers pump them on
+ * each poll.
+ */
+class InputWait : public FixedTimestepLoop
+{
+      public:
+        InputWait(std::vector<DirectionalController *> *controllers,
+                  std::vector<ActionController *> *action_controllers,
+                  Direction *direction, Action *action, Display *display)
+            : controllers(controllers), action_controllers(action_controllers),
+              direction(direction), action(action), display(display),
+              refresh_pending(true)
+        {
+        }
+
+        bool update() override
+        {
+                if (directional_input_registered(controllers, direction)) {
+                        return false;
+                }
+                return !(action_controllers &&
+                         action_input_registered(action_controllers, action));
+        }
+
+        void render() override
+        {
+                if (refresh_pending) {
+                        display->refresh();
+                        refresh_pending = false;
+                }
+        }
+
+      private:
+        std::vector<DirectionalController *> *controllers;
+        /**
+         * Null if only the directional input ends the wait.
+         */
+        std::vector<ActionController *> *action_controllers;
+        Direction *direction;
+        Action *action;
+        Display *display;
+        bool refresh_pending;
+};
+
 void pause_until_any_directional_input(
     std::vector<DirectionalController *> *controllers,
     DelayProvider *delay_provider, Display *display)
 {
         Direction dir;
-        while (!directional_input_registered(controllers, &dir)) {
-                delay_provider->delay_ms(INPUT_POLLING_DELAY);
-                // On the target device this is a no-op, but on the SFML display
-                // this ensures that we poll for events while waiting for input
-                // and so if the user tries to close the window, it will get
-                // closed properly.
-                display->refresh();
-        };
+        InputWait wait(controllers, nullptr, &dir, nullptr, display);
+        FixedTimestepScheduler scheduler(delay_provider, INPUT_POLLING_DELAY,
+                                         INPUT_LOOP_MAX_UPDATES_PER_FRAME);
+        scheduler.run(&wait);
 }
 
 void pause_until_input(std::vector<DirectionalController *> *controllers,
@@ -97,13 +165,9 @@ void pause_until_input(std::vector<DirectionalController *> *controllers,
                        Direction *direction, Action *action,
                        DelayProvider *delay_provider, Display *display)
 {
-        while (!directional_input_registered(controllers, direction) &&
-               !action_input_registered(action_controllers, action)) {
-                delay_provider->delay_ms(INPUT_POLLING_DELAY);
-                // On the target device this is a no-op, but on the SFML display
-                // this ensures that we poll for events while waiting for input
-                // and so if the user tries to close the window, it will get
-                // closed properly.
-                display->refresh();
-        };
+        InputWait wait(controllers, action_controllers, direction, action,
+                       display);
+        FixedTimestepScheduler scheduler(delay_provider, INPUT_POLLING_DELAY,
+                                         INPUT_LOOP_MAX_UPDATES_PER_FRAME);
+        scheduler.run(&wait);
 }
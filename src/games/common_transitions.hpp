@@ -7,10 +7,22 @@ void display_game_over(Display *display,
                        UserInterfaceCustomization *customization);
 void display_game_won(Display *display,
                       UserInterfaceCustomization *customization);
+/**
+ * Shows the best score of the played configuration above the game over or
+ * game won message, `best_score` is formatted by the game. If the score of
+ * the game that has just finished is the new best one, a notice is shown
+ * above it.
+ */
+void display_high_score(Display *display, const char *best_score,
+                        bool new_high_score);
 
 void pause_until_any_directional_input(
     std::vector<DirectionalController *> *controllers,
     DelayProvider *delay_provider, Display *display);
+/**
+ * Blocks until any input is registered. Only the output parameter of the kind
+ * of input that was registered is written, the other one is left unchanged.
+ */
 void pause_until_input(std::vector<DirectionalController *> *controllers,
                        std::vector<ActionController *> *action_controllers,
                        Direction *direction, Action *action,
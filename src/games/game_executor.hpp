@@ -7,4 +7,5 @@ class GameExecutor
       public:
         virtual void game_loop(Platform *p,
                                UserInterfaceCustomization *customization) = 0;
+        virtual ~GameExecutor() {}
 };
@@ -1,14 +1,21 @@
 #include <optional>
 #include <stdlib.h>
+#ifdef EMULATOR
+#include <stdexcept>
+#endif
 #include "game_menu.hpp"
 #include "../common/configuration.hpp"
+#include "../common/latency_tracer.hpp"
 #include "../common/logging.hpp"
 #include "../common/platform/interface/color.hpp"
 #include "2048.hpp"
 #include "game_executor.hpp"
+#include "high_scores.hpp"
 #include "minesweeper.hpp"
 #include "settings.hpp"
 #include "game_of_life.hpp"
+#include "snake.hpp"
+#include "sudoku.hpp"
 
 #define TAG "game_menu"
 
@@ -16,31 +23,27 @@ GameMenuConfiguration DEFAULT_MENU_CONFIGURATION = {.game = GameOfLife,
                                                     .accent_color = DarkBlue};
 
 const char *game_to_string(Game game);
+GameExecutor *create_game_executor(Game game);
 
 GameMenuConfiguration *
-load_initial_menu_configuration(PersistentStorage *storage)
+load_initial_menu_configuration(SettingsCache *settings)
 {
 
-        int storage_offset = get_settings_storage_offsets()[MainMenu];
-
         GameMenuConfiguration configuration = {.game = Unknown,
                                                .accent_color = DarkBlue};
 
-        LOG_DEBUG(TAG,
-                  "Trying to load initial settings from the persistent storage "
-                  "at offset %d",
-                  storage_offset);
-        storage->get(storage_offset, configuration);
+        LOG_DEBUG(TAG, "Trying to load initial settings from the cache.");
+        bool loaded = settings->get(MainMenu, &configuration);
 
         GameMenuConfiguration *output = new GameMenuConfiguration();
 
-        if (configuration.game == Unknown) {
+        if (!loaded) {
                 LOG_DEBUG(TAG,
                           "The storage does not contain a valid "
                           "game menu configuration, using default values.");
                 memcpy(output, &DEFAULT_MENU_CONFIGURATION,
                        sizeof(GameMenuConfiguration));
-                storage->put(storage_offset, DEFAULT_MENU_CONFIGURATION);
+                settings->put(MainMenu, &DEFAULT_MENU_CONFIGURATION);
 
         } else {
                 LOG_DEBUG(TAG, "Using configuration from persistent storage.");
@@ -62,7 +65,8 @@ assemble_menu_selection_configuration(GameMenuConfiguration *initial_config)
         auto *game = ConfigurationOption::of_strings(
             "Game",
             {game_to_string(Game::Minesweeper), game_to_string(Game::Clean2048),
-             game_to_string(Game::GameOfLife), game_to_string(Game::Settings)},
+             game_to_string(Game::GameOfLife), game_to_string(Game::Snake),
+             game_to_string(Game::Sudoku), game_to_string(Game::Settings)},
             game_to_string(initial_config->game));
 
         auto available_colors = {
@@ -114,12 +118,13 @@ void extract_game_config(GameMenuConfiguration *menu_configuration,
 
 void select_game(Platform *p)
 {
-        GameMenuConfiguration config;
+        GameMenuConfiguration config = {};
 
+        trace_latency_game(game_to_string(MainMenu));
         auto maybe_interrupt = collect_game_menu_config(p, &config);
 
-        // this customization might not be initialized properly if the user
-        // requests help message. The current version of the help text rendering
+        // this customization is left zero-initialized if the user requests
+        // help message. The current version of the help text rendering
         // does not depend on it but this might become problematic in the
         // future.
         UserInterfaceCustomization customization = {
@@ -143,21 +148,7 @@ void select_game(Platform *p)
 
         LOG_INFO(TAG, "User selected game: %s.", game_to_string(config.game));
 
-        GameExecutor *executor = [&]() -> GameExecutor * {
-                switch (config.game) {
-                case Unknown:
-                case Clean2048:
-                        return new class Clean2048();
-                case Minesweeper:
-                        return new class Minesweeper();
-                case GameOfLife:
-                        return new class GameOfLife();
-                case Settings:
-                        return new class Settings();
-                default:
-                        return NULL;
-                }
-        }();
+        GameExecutor *executor = create_game_executor(config.game);
 
         if (!executor) {
                 LOG_DEBUG(TAG, "Selected game: %d. Game not implemented yet.",
@@ -165,7 +156,86 @@ void select_game(Platform *p)
                 return;
         }
 
-        executor->game_loop(p, &customization);
+        trace_latency_game(game_to_string(config.game));
+        // Replaying the settings screen would overwrite the saved defaults,
+        // so only the actual games are recorded.
+        if (config.game == Settings) {
+                executor->game_loop(p, &customization);
+        } else {
+                ReplayRecorder recorder(p);
+                Platform *recording_platform =
+                    recorder.start(config.game, &customization);
+                executor->game_loop(recording_platform, &customization);
+                recorder.finish();
+        }
+        // Both the settings menu and the games put their configurations
+        // into the cache, they are written into the storage only once the
+        // user leaves them. The same goes for the high scores.
+        p->settings_cache->flush();
+        p->high_scores->flush();
+        delete executor;
+        report_latency();
+        log_drain();
+}
+
+#ifdef EMULATOR
+unsigned long replay_game(Platform *p, ReplayLog *log)
+{
+        ReplayHeader *header = &log->header;
+        GameExecutor *executor = create_game_executor((Game)header->game);
+        if (!executor) {
+                LOG_INFO(TAG, "Replay of unknown game: %d.", header->game);
+                return 0;
+        }
+        UserInterfaceCustomization customization = {
+            .accent_color = (Color)header->accent_color,
+            .rendering_mode =
+                (UserInterfaceRenderingMode)header->rendering_mode};
+
+        LOG_INFO(TAG, "Replaying %s: %d inputs over %lu ms%s.",
+                 game_to_string((Game)header->game), header->events,
+                 (unsigned long)header->duration_ms,
+                 header->truncated ? " (truncated)" : "");
+
+        ReplayPlayer player(log);
+        Platform *replay_platform = player.start(p);
+        // The game only advances the clock of the player, the clock of the
+        // outer platform stands still for the whole replay.
+        DelayProvider *clock = replay_platform->delay_provider;
+        unsigned long start_time = clock->get_time_ms();
+        try {
+                executor->game_loop(replay_platform, &customization);
+        } catch (std::runtime_error &e) {
+                LOG_INFO(TAG, "Replayed game did not exit: %s", e.what());
+        }
+        unsigned long duration = clock->get_time_ms() - start_time;
+        LOG_INFO(TAG, "Replay finished in %lu ms, %s.", duration,
+                 player.is_finished() ? "all inputs were consumed"
+                                      : "some inputs were not consumed");
+        delete executor;
+        return duration;
+}
+#endif
+
+GameExecutor *create_game_executor(Game game)
+{
+        switch (game) {
+        case Unknown:
+        case Clean2048:
+                return new class Clean2048();
+        case Minesweeper:
+                return new class Minesweeper();
+        case GameOfLife:
+                return new class GameOfLife();
+        case Snake:
+                return new class Snake();
+        case Sudoku:
+                return new class Sudoku();
+        case Settings:
+                return new class Settings();
+        default:
+                return NULL;
+        }
 }
 
 std::optional<UserAction>
@@ -173,7 +243,7 @@ collect_game_menu_config(Platform *p, GameMenuConfiguration *configuration)
 {
 
         GameMenuConfiguration *initial_config =
-            load_initial_menu_configuration(p->persistent_storage);
+            load_initial_menu_configuration(p->settings_cache);
 
         Configuration *config =
             assemble_menu_selection_configuration(initial_config);
@@ -203,6 +273,10 @@ Game game_from_string(const char *name)
                 return Game::Minesweeper;
         } else if (strcmp(name, game_to_string(GameOfLife)) == 0) {
                 return Game::GameOfLife;
+        } else if (strcmp(name, game_to_string(Snake)) == 0) {
+                return Game::Snake;
+        } else if (strcmp(name, game_to_string(Sudoku)) == 0) {
+                return Game::Sudoku;
         } else if (strcmp(name, game_to_string(MainMenu)) == 0) {
                 return Game::MainMenu;
         } else if (strcmp(name, game_to_string(Settings)) == 0) {
@@ -222,6 +296,10 @@ const char *game_to_string(Game game)
                 return "Minesweeper";
         case GameOfLife:
                 return "Game Of Life";
+        case Snake:
+                return "Snake";
+        case Sudoku:
+                return "Sudoku";
         case Settings:
                 return "Settings";
         default:
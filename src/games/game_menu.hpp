@@ -1,4 +1,6 @@
+#pragma once
 #include "../common/platform/interface/platform.hpp"
+#include "../common/replay.hpp"
 #include "../common/user_interface.hpp"
 #include <optional>
 
@@ -10,6 +12,8 @@ typedef enum Game
             GameOfLife = 4,
             Settings = 5,
             RandomSeedPicker = 6,
+            Snake = 7,
+            Sudoku = 8,
     } Game;
 
 typedef struct GameMenuConfiguration {
@@ -24,6 +28,20 @@ extern const char *game_to_string(Game game);
 
 void select_game(Platform *p);
 
+#ifdef EMULATOR
+/**
+ * Replays a recorded game using the display and storage of the platform. The
+ * recorded inputs are fed to the game on a virtual clock that skips all
+ * delays, so the replay runs faster than real time.
+ *
+ * Note that the games load their configuration defaults from the persistent
+ * storage, the replay only matches the recording if these haven't changed.
+ *
+ * Returns the time that passed on the virtual clock of the replay.
+ */
+unsigned long replay_game(Platform *p, ReplayLog *log);
+#endif
+
 /**
  * Similar to `collect_configuration` from `configuration.hpp`, it returns true
  * if the configuration was successfully collected. Otherwise, if the user
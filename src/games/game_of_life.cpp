@@ -1,18 +1,32 @@
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 
+#include "../common/caret_overlay.hpp"
+#include "../common/fixed_timestep.hpp"
+#include "../common/grid_game.hpp"
 #include "../common/logging.hpp"
 #include "../common/constants.hpp"
 #include "../common/maths_utils.hpp"
 #include "game_executor.hpp"
 #include "game_of_life.hpp"
+#include "high_scores.hpp"
 #include "settings.hpp"
 #include "game_menu.hpp"
 
 #define TAG "game_of_life"
 #define GAME_CELL_WIDTH 8
 
-#define GAME_LOOP_DELAY 100
+/**
+ * Duration of a single update of the game loop. The input is polled once per
+ * update and the simulation speed is converted to a whole number of updates
+ * per generation.
+ */
+#define GAME_LOOP_TIMESTEP 50
+/**
+ * Maximum number of updates run back to back when drawing falls behind.
+ */
+#define GAME_LOOP_MAX_CATCH_UP 4
 
 #ifdef EMULATOR
 #define EXPLANATION_ABOVE_GRID_OFFEST 4
@@ -26,29 +40,22 @@
 #define EMPTY false
 
 /**
- * Stores all information required for rendering the finite grid for game of
- * life simulation. Note that this is similar to the struct that we are using
- * for Minesweeper so we might want to abstract away this commonality in the
- * future.
+ * Uncovered cells of the puzzle target are drawn using this color.
  */
-typedef struct GameOfLifeGridDimensions {
-        int rows;
-        int cols;
-        int top_vertical_margin;
-        int left_horizontal_margin;
-        int actual_width;
-        int actual_height;
-
-        GameOfLifeGridDimensions(int r, int c, int tvm, int lhm, int aw, int ah)
-            : rows(r), cols(c), top_vertical_margin(tvm),
-              left_horizontal_margin(lhm), actual_width(aw), actual_height(ah)
-        {
-        }
-} GameOfLifeGridDimensions;
+#define PUZZLE_TARGET_COLOR Gray
+/**
+ * The target of a puzzle is painted by letting a seed pattern evolve for a
+ * random number of generations from this range.
+ */
+#define PUZZLE_MIN_GENERATIONS 6
+#define PUZZLE_MAX_GENERATIONS 14
+#define PUZZLE_PATTERN_SIZE 7
+#define PUZZLE_PATTERN_MAX_CELLS 7
 
 GameOfLifeConfiguration DEFAULT_GAME_OF_LIFE_CONFIG = {
     .prepopulate_grid = false,
     .use_toroidal_array = true,
+    .puzzle_mode = false,
     .simulation_speed = 2,
     .rewind_buffer_size = REWIND_BUF_SIZE,
 };
@@ -59,6 +66,46 @@ inline bool get_cell(int x, int y, int cols, Grid grid);
 inline void set_cell(int x, int y, int cols, Grid grid, bool alive);
 inline Grid allocate_grid(int cells);
 
+/**
+ * State of the puzzle mode. The target pattern is stored as a bitset with the
+ * same layout as the simulation grid, this allows for updating the coverage
+ * with a single bitwise pass over the grid bytes.
+ */
+typedef struct GameOfLifePuzzle {
+        /**
+         * Target cells that haven't been visited by a live cell yet.
+         */
+        Grid uncovered_target;
+        int uncovered_cells;
+        /**
+         * Number of seeds the puzzle started with, the fewer of them are
+         * used to solve it, the better the score.
+         */
+        int seeds_total;
+        int seeds_left;
+        int generations;
+} GameOfLifePuzzle;
+
+/**
+ * Seed patterns used for painting the puzzle targets. Each cell is stored as
+ * its (x, y) offset inside of a PUZZLE_PATTERN_SIZE square.
+ */
+typedef struct PuzzlePattern {
+        int cells;
+        uint8_t offsets[PUZZLE_PATTERN_MAX_CELLS][2];
+} PuzzlePattern;
+
+const PuzzlePattern PUZZLE_PATTERNS[] = {
+    // Glider
+    {5, {{1, 0}, {2, 1}, {0, 2}, {1, 2}, {2, 2}}},
+    // R-pentomino
+    {5, {{1, 0}, {2, 0}, {0, 1}, {1, 1}, {1, 2}}},
+    // Pi-heptomino
+    {7, {{0, 0}, {1, 0}, {2, 0}, {0, 1}, {2, 1}, {0, 2}, {2, 2}}},
+    // Acorn
+    {7, {{1, 0}, {3, 1}, {0, 2}, {1, 2}, {4, 2}, {5, 2}, {6, 2}}},
+};
+
 /**
  * Models a change of the Game of Life state from one frame to another. This
  * is needed to render changes when a single iteration of the simulation loop
@@ -78,7 +125,7 @@ typedef enum SimulationMode {
  * Assembles the generic configuration struct that can be used to collect user
  * input specifying the game of life configuration.
  */
-Configuration *assemble_game_of_life_configuration(PersistentStorage *storage);
+Configuration *assemble_game_of_life_configuration(SettingsCache *settings);
 
 /**
  * Extracts the specific game of life config struct after the generic config
@@ -87,70 +134,95 @@ Configuration *assemble_game_of_life_configuration(PersistentStorage *storage);
 void extract_game_config(GameOfLifeConfiguration *game_config,
                          Configuration *config);
 
-GameOfLifeGridDimensions *
-calculate_grid_dimensions(int display_width, int display_height,
-                          int display_rounded_corner_radius);
-
-void draw_game_canvas(Platform *p, GameOfLifeGridDimensions *dimensions,
-                      UserInterfaceCustomization *customization);
-void draw_rewind_mode_indicator(Platform *p,
-                                GameOfLifeGridDimensions *dimensions,
+void draw_game_canvas(Platform *p, CellGridDimensions *dimensions,
+                      UserInterfaceCustomization *customization,
+                      bool puzzle_mode);
+void draw_rewind_mode_indicator(Platform *p, CellGridDimensions *dimensions,
                                 UserInterfaceCustomization *customization);
-void clear_rewind_mode_indicator(Platform *p,
-                                 GameOfLifeGridDimensions *dimensions,
+void clear_rewind_mode_indicator(Platform *p, CellGridDimensions *dimensions,
                                  UserInterfaceCustomization *customization);
-void draw_caret(Display *display, Point *grid_position,
-                GameOfLifeGridDimensions *dimensions, Color caret_color);
-void erase_caret(Display *display, Point *grid_position,
-                 GameOfLifeGridDimensions *dimensions,
-                 Color grid_background_color);
+/**
+ * Draws the caret over the cell, erasing it from its previous position. This
+ * needs to be called again whenever the cell under the caret is redrawn.
+ */
+void draw_caret(CaretOverlay *caret, Point *grid_position,
+                CellGridDimensions *dimensions, Grid grid,
+                GameOfLifePuzzle *puzzle = nullptr);
 void draw_game_cell(Display *display, Point *grid_position,
-                    GameOfLifeGridDimensions *dimensions, Color color);
+                    CellGridDimensions *dimensions, Color color);
+/**
+ * Dead cells are drawn black, unless they belong to the uncovered part of the
+ * puzzle target.
+ */
+Color get_cell_color(int x, int y, int cols, Grid grid,
+                     GameOfLifePuzzle *puzzle);
 
-StateEvolution take_simulation_step(Grid grid,
-                                    GameOfLifeGridDimensions *dimensions,
+StateEvolution take_simulation_step(Grid grid, CellGridDimensions *dimensions,
                                     bool use_toroidal_array);
 
-void render_state_change(Display *display, StateEvolution evolution,
-                         GameOfLifeGridDimensions *dimensions);
+/**
+ * Generates a puzzle by planting one of the seed patterns at a random
+ * position and letting it evolve. The target is the set of cells visited by
+ * the pattern, so the puzzle can always be solved using as many seeds as the
+ * pattern has cells.
+ */
+GameOfLifePuzzle *generate_puzzle(CellGridDimensions *dimensions,
+                                  bool use_toroidal_array);
+void free_puzzle(GameOfLifePuzzle *puzzle);
+/**
+ * Clears the target cells that are covered by live cells of the grid. It is
+ * a single pass over the bytes of both bitsets, so it costs the same small
+ * constant in every generation regardless of what happens on the grid.
+ *
+ * Returns true if at least one cell of the grid is alive.
+ */
+bool update_target_coverage(GameOfLifePuzzle *puzzle, Grid grid,
+                            int total_cells);
+void draw_puzzle_target(Display *display, CellGridDimensions *dimensions,
+                        GameOfLifePuzzle *puzzle);
+/**
+ * Redraws the seeds and generations counters above the grid. The text has
+ * a fixed width, so it overwrites the previous values without clearing.
+ */
+void draw_puzzle_counters(Display *display, CellGridDimensions *dimensions,
+                          GameOfLifePuzzle *puzzle);
 
 void spawn_cells_randomly(Display *display, Grid grid,
-                          GameOfLifeGridDimensions *dimensions);
+                          CellGridDimensions *dimensions);
 
 void save_grid_state_in_rewind_buffer(std::vector<Grid> *rewind_buffer,
                                       int *rewind_buf_idx, Grid grid);
 
+/**
+ * Moves through the rewind buffer and returns the state that needs to be
+ * displayed, either one of the buffer entries or the current `grid`.
+ */
 Grid handle_rewind(Direction dir, std::vector<Grid> *rewind_buffer,
-                   int latest_state_idx, int *rewind_buf_idx, Grid grid,
-                   GameOfLifeGridDimensions *gd, Display *display);
+                   int latest_state_idx, int *rewind_buf_idx, Grid grid);
 
 const char *map_boolean_to_yes_or_no(bool value);
 
 GameOfLifeConfiguration *
-load_initial_game_of_life_config(PersistentStorage *storage)
+load_initial_game_of_life_config(SettingsCache *settings)
 {
-        int storage_offset = get_settings_storage_offsets()[GameOfLife];
-
         GameOfLifeConfiguration config = {.prepopulate_grid = false,
                                           .use_toroidal_array = false,
+                                          .puzzle_mode = false,
                                           .simulation_speed = 0,
                                           .rewind_buffer_size = 0};
 
-        LOG_DEBUG(TAG,
-                  "Trying to load initial settings from the persistent storage "
-                  "at offset %d",
-                  storage_offset);
-        storage->get(storage_offset, config);
+        LOG_DEBUG(TAG, "Trying to load initial settings from the cache.");
+        bool loaded = settings->get(GameOfLife, &config);
 
         GameOfLifeConfiguration *output = new GameOfLifeConfiguration();
 
-        if (config.rewind_buffer_size == 0) {
+        if (!loaded) {
                 LOG_DEBUG(TAG,
                           "The storage does not contain a valid "
                           "game of life configuration, using default values.");
                 memcpy(output, &DEFAULT_GAME_OF_LIFE_CONFIG,
                        sizeof(GameOfLifeConfiguration));
-                storage->put(storage_offset, DEFAULT_GAME_OF_LIFE_CONFIG);
+                settings->put(GameOfLife, &DEFAULT_GAME_OF_LIFE_CONFIG);
 
         } else {
                 LOG_DEBUG(TAG, "Using configuration from persistent storage.");
@@ -159,10 +231,11 @@ load_initial_game_of_life_config(PersistentStorage *storage)
 
         LOG_DEBUG(TAG,
                   "Loaded game of life configuration: prepopulate_grid=%d, "
-                  "use_toroidal_array=%d, simulation_speed=%d, "
-                  "rewind_buffer_size=%d",
+                  "use_toroidal_array=%d, puzzle_mode=%d, "
+                  "simulation_speed=%d, rewind_buffer_size=%d",
                   output->prepopulate_grid, output->use_toroidal_array,
-                  output->simulation_speed, output->rewind_buffer_size);
+                  output->puzzle_mode, output->simulation_speed,
+                  output->rewind_buffer_size);
 
         return output;
 }
@@ -180,8 +253,8 @@ void GameOfLife::game_loop(Platform *p,
         const char *help_text =
             "Use the joystick to move the caret around the grid. Press green "
             "to toggle the cell between alive/dead, yellow to pause, blue to "
-            "rewind back in time, red to exit. There is no aim, you stare at "
-            "the simulation";
+            "rewind back in time, red to exit. Puzzle mode: cover the gray "
+            "cells with few seeds.";
 
         bool exit_requested = false;
         while (!exit_requested) {
@@ -202,6 +275,80 @@ void GameOfLife::game_loop(Platform *p,
         }
 }
 
+/**
+ * State of a single Game of Life round driven by the fixed timestep
+ * scheduler. The updates only modify the grid and record which cells have
+ * changed, the cells are drawn once per frame in `render`. This way the
+ * simulation advances at exactly the configured speed even if a frame takes
+ * longer to draw than a single timestep.
+ */
+class GameOfLifeSession : public FixedTimestepLoop
+{
+      public:
+        GameOfLifeSession(Platform *p,
+                          UserInterfaceCustomization *customization,
+                          GameOfLifeConfiguration *config,
+                          CellGridDimensions *gd, GameOfLifePuzzle *puzzle);
+        ~GameOfLifeSession();
+
+        GameOfLifeSession(const GameOfLifeSession &) = delete;
+        GameOfLifeSession &operator=(const GameOfLifeSession &) = delete;
+
+        bool update() override;
+        void render() override;
+
+        bool is_puzzle_solved() { return puzzle_solved; }
+        bool is_puzzle_failed() { return puzzle_failed; }
+
+      private:
+        void take_step();
+        void handle_directional_input(Direction dir);
+        void handle_action_input(Action act);
+        /**
+         * Replaces the grid with `new_grid` and marks the cells that differ
+         * between the two as changed. The old grid is moved into the rewind
+         * buffer.
+         */
+        void replace_grid(Grid new_grid);
+
+        Platform *p;
+        UserInterfaceCustomization *customization;
+        GameOfLifeConfiguration *config;
+        CellGridDimensions *gd;
+        GameOfLifePuzzle *puzzle;
+        int total_cells;
+        int grid_bytes;
+
+        Grid grid;
+        /**
+         * Cells that have changed since the last frame was rendered, in the
+         * same bitset layout as the grid.
+         */
+        Grid changed_cells;
+
+        /* A ring buffer storing previous simulation states that are used to
+           allow for going back in time. Note that each user input also counts
+           as a simulation step so will be included in the rewind buffer. The
+           buffer owns its grids, the current grid is never one of them. */
+        std::vector<Grid> rewind_buffer;
+        int rewind_buf_idx;
+        // Keeps track of the latest diff in the rewind buffer. Prevents us
+        // from wrapping back to it.
+        int rewind_initial_idx;
+
+        CaretOverlay caret;
+        Point caret_pos;
+        bool caret_moved;
+        bool counters_changed;
+
+        SimulationMode mode;
+        int updates_per_generation;
+        int updates_since_generation;
+        bool exit_requested;
+        bool puzzle_solved;
+        bool puzzle_failed;
+};
+
 UserAction game_of_life_loop(Platform *p,
                              UserInterfaceCustomization *customization)
 {
@@ -215,175 +362,300 @@ UserAction game_of_life_loop(Platform *p,
                 return maybe_interrupt.value();
         }
 
-        GameOfLifeGridDimensions *gd = calculate_grid_dimensions(
+        CellGridDimensions *gd = calculate_cell_grid_dimensions(
             p->display->get_width(), p->display->get_height(),
-            p->display->get_display_corner_radius());
-        int rows = gd->rows;
-        int cols = gd->cols;
-        int total_cells = rows * cols;
+            p->display->get_display_corner_radius(), GAME_CELL_WIDTH,
+            GAME_CELL_WIDTH);
 
-        draw_game_canvas(p, gd, customization);
+        draw_game_canvas(p, gd, customization, config.puzzle_mode);
         LOG_DEBUG(TAG, "Game of Life canvas drawn.");
 
-        Point caret_pos = {.x = 0, .y = 0};
-        draw_caret(p->display, &caret_pos, gd, customization->accent_color);
+        GameOfLifePuzzle *puzzle = nullptr;
+        if (config.puzzle_mode) {
+                puzzle = generate_puzzle(gd, config.use_toroidal_array);
+                draw_puzzle_target(p->display, gd, puzzle);
+                draw_puzzle_counters(p->display, gd, puzzle);
+        }
+
+        GameOfLifeSession *session =
+            new GameOfLifeSession(p, customization, &config, gd, puzzle);
+        FixedTimestepScheduler scheduler(p->delay_provider, GAME_LOOP_TIMESTEP,
+                                         GAME_LOOP_MAX_CATCH_UP);
+        scheduler.run(session);
+
+        bool puzzle_solved = session->is_puzzle_solved();
+        bool puzzle_failed = session->is_puzzle_failed();
+        delete session;
+
+        bool new_high_score = false;
+        if (puzzle) {
+                LOG_INFO(TAG,
+                         "Puzzle %s after %d generations with %d seeds left, "
+                         "%d target cells uncovered.",
+                         puzzle_solved ? "solved" : "finished",
+                         puzzle->generations, puzzle->seeds_left,
+                         puzzle->uncovered_cells);
+                if (puzzle_solved) {
+                        new_high_score = p->high_scores->submit(
+                            GameOfLife, config.use_toroidal_array,
+                            puzzle->seeds_total - puzzle->seeds_left,
+                            LowerIsBetter);
+                }
+                free_puzzle(puzzle);
+        }
+        if (puzzle_solved || puzzle_failed) {
+                pause_until_any_directional_input(
+                    p->directional_controllers, p->delay_provider, p->display);
+                if (puzzle_solved) {
+                        display_game_won(p->display, customization);
+                } else {
+                        display_game_over(p->display, customization);
+                }
+                uint32_t best_seeds;
+                if (p->high_scores->get_best(GameOfLife,
+                                             config.use_toroidal_array,
+                                             &best_seeds)) {
+                        char text[32];
+                        snprintf(text, sizeof(text), "Fewest seeds: %lu",
+                                 (unsigned long)best_seeds);
+                        display_high_score(p->display, text, new_high_score);
+                }
+                p->display->refresh();
+                // The game loop goes straight back to the configuration
+                // screen, so we wait for the user to see the result first.
+                pause_until_any_directional_input(
+                    p->directional_controllers, p->delay_provider, p->display);
+        }
+        return UserAction::PlayAgain;
+}
+
+GameOfLifeSession::GameOfLifeSession(Platform *p,
+                                     UserInterfaceCustomization *customization,
+                                     GameOfLifeConfiguration *config,
+                                     CellGridDimensions *gd,
+                                     GameOfLifePuzzle *puzzle)
+    : p(p), customization(customization), config(config), gd(gd),
+      puzzle(puzzle), rewind_buffer(config->rewind_buffer_size, nullptr),
+      rewind_buf_idx(-1), rewind_initial_idx(-1),
+      caret(p->display, GAME_CELL_WIDTH, GAME_CELL_WIDTH,
+            customization->accent_color),
+      caret_pos({.x = 0, .y = 0}), caret_moved(false),
+      counters_changed(false), mode(PAUSED), updates_since_generation(0),
+      exit_requested(false), puzzle_solved(false), puzzle_failed(false)
+{
+        total_cells = gd->rows * gd->cols;
+        grid_bytes = (total_cells + 7) / 8;
 
         /* Because of memory constraints, we need to use a hand-rolled bitset
            to store each 'frame' of the game simulation. The reason for this
            is that storing the diffs with two integer (x, y) coordinates
            occupies too much memory. */
+        grid = allocate_grid(total_cells);
+        changed_cells = allocate_grid(total_cells);
 
-        uint8_t *grid = allocate_grid(total_cells);
+        if (config->prepopulate_grid && !config->puzzle_mode) {
+                spawn_cells_randomly(p->display, grid, gd);
+        }
+        draw_caret(&caret, &caret_pos, gd, grid, puzzle);
 
-        /* A ring buffer storing previous simulation states that are used to
-           allow for going back in time. Note that each user input also counts
-           as a simulation step so will be included in the rewind buffer. */
-        std::vector<uint8_t *> rewind_buffer(config.rewind_buffer_size,
-                                             nullptr);
+        // The speed is a whole number of updates, so the generations are
+        // evenly spaced in time.
+        updates_per_generation =
+            (1000 / config->simulation_speed) / GAME_LOOP_TIMESTEP;
+}
 
-        int rewind_buf_idx = -1;
-        // Keeps track of the latest diff in the rewind buffer. Prevents us from
-        // wrapping back to it.
-        int rewind_initial_idx = -1;
+GameOfLifeSession::~GameOfLifeSession()
+{
+        for (Grid state : rewind_buffer) {
+                delete[] state;
+        }
+        delete[] grid;
+        delete[] changed_cells;
+}
 
-        if (config.prepopulate_grid) {
-                spawn_cells_randomly(p->display, grid, gd);
+bool GameOfLifeSession::update()
+{
+        if (mode == RUNNING &&
+            ++updates_since_generation == updates_per_generation) {
+                updates_since_generation = 0;
+                take_step();
         }
 
-        int evolution_period =
-            (1000 / config.simulation_speed) / GAME_LOOP_DELAY;
-        int iteration = 0;
+        Direction dir;
+        Action act;
+        if (directional_input_registered(p->directional_controllers, &dir)) {
+                handle_directional_input(dir);
+        }
+        if (action_input_registered(p->action_controllers, &act)) {
+                handle_action_input(act);
+        }
+        return !exit_requested && !puzzle_solved && !puzzle_failed;
+}
 
-        bool exit_requested = false;
-        SimulationMode mode = PAUSED;
-        while (!exit_requested) {
-                if (mode == RUNNING && iteration == evolution_period - 1) {
-                        LOG_DEBUG(TAG, "Taking a simulation step");
-                        StateEvolution evolution = take_simulation_step(
-                            grid, gd, config.use_toroidal_array);
-
-                        render_state_change(p->display, evolution, gd);
-                        save_grid_state_in_rewind_buffer(&rewind_buffer,
-                                                         &rewind_buf_idx, grid);
-                        grid = evolution.second;
-                }
-                Direction dir;
-                Action act;
-                GameOfLifeCell curr =
-                    get_cell(caret_pos.x, caret_pos.y, gd->cols, grid);
-                if (directional_input_registered(p->directional_controllers,
-                                                 &dir)) {
-                        // TODO: clean up control flow to remove this deeply
-                        // nested logic.
-                        if (mode == REWIND) {
-                                grid = handle_rewind(
-                                    dir, &rewind_buffer, rewind_initial_idx,
-                                    &rewind_buf_idx, grid, gd, p->display);
-                        } else {
-                                if (curr == EMPTY) {
-                                        erase_caret(p->display, &caret_pos, gd,
-                                                    Black);
-                                } else if (curr == ALIVE) {
-                                        erase_caret(p->display, &caret_pos, gd,
-                                                    White);
-                                }
+void GameOfLifeSession::render()
+{
+        int cols = gd->cols;
+        bool caret_cell_changed =
+            get_cell(caret_pos.x, caret_pos.y, cols, changed_cells);
 
-                                if (config.use_toroidal_array) {
-                                        translate_toroidal_array(&caret_pos,
-                                                                 dir, gd->rows,
-                                                                 gd->cols);
-                                } else {
-                                        translate_within_bounds(&caret_pos, dir,
-                                                                gd->rows,
-                                                                gd->cols);
-                                }
-                                draw_caret(p->display, &caret_pos, gd,
-                                           customization->accent_color);
+        for (int i = 0; i < grid_bytes; i++) {
+                if (!changed_cells[i]) {
+                        continue;
+                }
+                for (int bit = 0; bit < 8; bit++) {
+                        int cell = i * 8 + bit;
+                        if (cell >= total_cells ||
+                            !(changed_cells[i] & (1 << bit))) {
+                                continue;
                         }
+                        Point position = {.x = cell % cols, .y = cell / cols};
+                        draw_game_cell(p->display, &position, gd,
+                                       get_cell_color(position.x, position.y,
+                                                      cols, grid, puzzle));
                 }
-                if (action_input_registered(p->action_controllers, &act)) {
-                        switch (act) {
-                        case YELLOW:
-                                if (mode == PAUSED) {
-                                        mode = RUNNING;
-                                        LOG_DEBUG(TAG, "Simulation running...");
-                                } else if (mode == REWIND) {
-                                        mode = PAUSED;
-                                        LOG_DEBUG(
-                                            TAG,
-                                            "Simulation paused after rewind.");
-                                        clear_rewind_mode_indicator(
-                                            p, gd, customization);
-                                } else {
-                                        mode = PAUSED;
-                                        LOG_DEBUG(TAG, "Simulation paused.");
-                                }
-                                p->delay_provider->delay_ms(
-                                    MOVE_REGISTERED_DELAY);
-                                break;
-                        case RED:
-                                exit_requested = true;
-                                break;
-                        case BLUE:
-                                if (mode == REWIND) {
-                                        mode = RUNNING;
-                                        clear_rewind_mode_indicator(
-                                            p, gd, customization);
-                                        LOG_DEBUG(TAG, "Simulation running...");
-                                } else if (rewind_buf_idx != -1) {
-                                        // We can only rewind if the buffer has
-                                        // at least one entry.
-                                        mode = REWIND;
-                                        draw_rewind_mode_indicator(
-                                            p, gd, customization);
-                                        // We need to record the latest index in
-                                        // the rewind buffer.
-                                        rewind_initial_idx = rewind_buf_idx;
-                                        LOG_DEBUG(TAG, "Rewind mode enabled.");
-                                }
-                                break;
-                        case GREEN:
-                                Color new_cell_color;
-
-                                // We copy the current state and only modify the
-                                // caret position.
-                                Grid new_grid = allocate_grid(total_cells);
-                                int size = (total_cells + 7) / 8;
-                                std::memcpy(new_grid, grid,
-                                            size * sizeof(uint8_t));
-
-                                if (curr == EMPTY) {
-                                        set_cell(caret_pos.x, caret_pos.y, cols,
-                                                 new_grid, ALIVE);
-                                        new_cell_color = White;
-                                } else if (curr == ALIVE) {
-                                        set_cell(caret_pos.x, caret_pos.y, cols,
-                                                 new_grid, EMPTY);
-                                        new_cell_color = Black;
-                                }
+                changed_cells[i] = 0;
+        }
 
-                                save_grid_state_in_rewind_buffer(
-                                    &rewind_buffer, &rewind_buf_idx, grid);
-                                draw_game_cell(p->display, &caret_pos, gd,
-                                               new_cell_color);
-                                // we need to redraw the caret as we have just
-                                // drawn a cell by clearing the region
-                                draw_caret(p->display, &caret_pos, gd,
-                                           customization->accent_color);
+        // The caret is lost if the cell underneath has been redrawn.
+        if (caret_moved || caret_cell_changed) {
+                draw_caret(&caret, &caret_pos, gd, grid, puzzle);
+                caret_moved = false;
+        }
+        if (counters_changed) {
+                draw_puzzle_counters(p->display, gd, puzzle);
+                counters_changed = false;
+        }
+        p->display->refresh();
+}
 
-                                grid = new_grid;
+void GameOfLifeSession::take_step()
+{
+        LOG_DEBUG(TAG, "Taking a simulation step");
+        StateEvolution evolution =
+            take_simulation_step(grid, gd, config->use_toroidal_array);
+
+        bool any_alive = true;
+        if (puzzle) {
+                any_alive = update_target_coverage(puzzle, evolution.second,
+                                                   total_cells);
+                puzzle->generations++;
+                counters_changed = true;
+        }
+        replace_grid(evolution.second);
 
-                                p->delay_provider->delay_ms(
-                                    MOVE_REGISTERED_DELAY);
-                                break;
-                        }
+        if (puzzle && puzzle->uncovered_cells == 0) {
+                puzzle_solved = true;
+        } else if (puzzle && !any_alive && puzzle->seeds_left == 0) {
+                puzzle_failed = true;
+        }
+}
+
+void GameOfLifeSession::replace_grid(Grid new_grid)
+{
+        for (int i = 0; i < grid_bytes; i++) {
+                changed_cells[i] |= grid[i] ^ new_grid[i];
+        }
+        save_grid_state_in_rewind_buffer(&rewind_buffer, &rewind_buf_idx,
+                                         grid);
+        grid = new_grid;
+}
+
+void GameOfLifeSession::handle_directional_input(Direction dir)
+{
+        if (mode == REWIND) {
+                Grid state = handle_rewind(dir, &rewind_buffer,
+                                           rewind_initial_idx,
+                                           &rewind_buf_idx, grid);
+                // The rewound state stays in the buffer, so we only copy it.
+                for (int i = 0; i < grid_bytes; i++) {
+                        changed_cells[i] |= grid[i] ^ state[i];
+                        grid[i] = state[i];
                 }
-                iteration += 1;
-                iteration %= evolution_period;
-                p->delay_provider->delay_ms(GAME_LOOP_DELAY);
-                p->display->refresh();
+                return;
+        }
+        if (config->use_toroidal_array) {
+                translate_toroidal_array(&caret_pos, dir, gd->rows, gd->cols);
+        } else {
+                translate_within_bounds(&caret_pos, dir, gd->rows, gd->cols);
+        }
+        caret_moved = true;
+}
+
+void GameOfLifeSession::handle_action_input(Action act)
+{
+        GameOfLifeCell curr =
+            get_cell(caret_pos.x, caret_pos.y, gd->cols, grid);
+        switch (act) {
+        case YELLOW:
+                if (mode == PAUSED) {
+                        mode = RUNNING;
+                        updates_since_generation = 0;
+                        LOG_DEBUG(TAG, "Simulation running...");
+                } else if (mode == REWIND) {
+                        mode = PAUSED;
+                        LOG_DEBUG(TAG, "Simulation paused after rewind.");
+                        clear_rewind_mode_indicator(p, gd, customization);
+                } else {
+                        mode = PAUSED;
+                        LOG_DEBUG(TAG, "Simulation paused.");
+                }
+                break;
+        case RED:
+                exit_requested = true;
+                break;
+        case BLUE:
+                if (puzzle) {
+                        // Rewinding would give the user their seeds back, so
+                        // it is not allowed in the puzzle mode.
+                        break;
+                }
+                if (mode == REWIND) {
+                        mode = RUNNING;
+                        updates_since_generation = 0;
+                        clear_rewind_mode_indicator(p, gd, customization);
+                        LOG_DEBUG(TAG, "Simulation running...");
+                } else if (rewind_buf_idx != -1) {
+                        // We can only rewind if the buffer has at least one
+                        // entry.
+                        mode = REWIND;
+                        draw_rewind_mode_indicator(p, gd, customization);
+                        // We need to record the latest index in the rewind
+                        // buffer.
+                        rewind_initial_idx = rewind_buf_idx;
+                        LOG_DEBUG(TAG, "Rewind mode enabled.");
+                }
+                break;
+        case GREEN: {
+                if (puzzle && (curr == ALIVE || puzzle->seeds_left == 0)) {
+                        // In the puzzle mode seeds can only be planted, never
+                        // removed.
+                        break;
+                }
+                if (mode == REWIND) {
+                        // Editing a rewound state continues the history from
+                        // it, the same way as resuming the simulation does.
+                        // Saving it while rewinding would move the rewind
+                        // position and corrupt the buffer.
+                        mode = PAUSED;
+                        clear_rewind_mode_indicator(p, gd, customization);
+                        LOG_DEBUG(TAG, "Simulation paused after rewind.");
+                }
+                // We copy the current state and only modify the caret
+                // position.
+                Grid new_grid = allocate_grid(total_cells);
+                std::memcpy(new_grid, grid, grid_bytes * sizeof(uint8_t));
+                set_cell(caret_pos.x, caret_pos.y, gd->cols, new_grid,
+                         curr == EMPTY ? ALIVE : EMPTY);
+
+                if (puzzle) {
+                        puzzle->seeds_left--;
+                        update_target_coverage(puzzle, new_grid, total_cells);
+                        counters_changed = true;
+                        puzzle_solved = puzzle->uncovered_cells == 0;
+                }
+                replace_grid(new_grid);
+        } break;
         }
-        return UserAction::PlayAgain;
 }
 
 std::optional<UserAction>
@@ -391,7 +663,7 @@ collect_game_of_life_config(Platform *p, GameOfLifeConfiguration *game_config,
                             UserInterfaceCustomization *customization)
 {
         Configuration *config =
-            assemble_game_of_life_configuration(p->persistent_storage);
+            assemble_game_of_life_configuration(p->settings_cache);
         auto maybe_interrupt = collect_configuration(p, config, customization);
         if (maybe_interrupt) {
                 return maybe_interrupt;
@@ -402,15 +674,18 @@ collect_game_of_life_config(Platform *p, GameOfLifeConfiguration *game_config,
         return std::nullopt;
 }
 
-Configuration *assemble_game_of_life_configuration(PersistentStorage *storage)
+Configuration *assemble_game_of_life_configuration(SettingsCache *settings)
 {
         GameOfLifeConfiguration *initial_config =
-            load_initial_game_of_life_config(storage);
+            load_initial_game_of_life_config(settings);
 
-        // Controls if grid will get pre-populated with cells randomly.
-        auto *spawn_randomly = ConfigurationOption::of_strings(
-            "Spawn randomly", {"Yes", "No"},
-            map_boolean_to_yes_or_no(initial_config->prepopulate_grid));
+        // Controls if the grid starts empty, gets pre-populated with cells
+        // randomly or contains a puzzle target.
+        auto *mode = ConfigurationOption::of_strings(
+            "Mode", {"Empty", "Random", "Puzzle"},
+            initial_config->puzzle_mode        ? "Puzzle"
+            : initial_config->prepopulate_grid ? "Random"
+                                               : "Empty");
 
         auto *simulation_speed = ConfigurationOption::of_integers(
             "Evolutions/second", {1, 2, 4}, initial_config->simulation_speed);
@@ -422,7 +697,7 @@ Configuration *assemble_game_of_life_configuration(PersistentStorage *storage)
 
         free(initial_config);
 
-        auto options = {spawn_randomly, simulation_speed, toroidal_array};
+        auto options = {mode, simulation_speed, toroidal_array};
 
         return new Configuration("Game of Life", options, "Start Game");
 }
@@ -444,11 +719,12 @@ void extract_game_config(GameOfLifeConfiguration *game_config,
                          Configuration *config)
 {
 
-        ConfigurationOption prepopulate_grid = *config->options[0];
-        int curr_choice_idx = prepopulate_grid.currently_selected;
-        const char *choice = static_cast<const char **>(
-            prepopulate_grid.available_values)[curr_choice_idx];
-        game_config->prepopulate_grid = extract_yes_or_no_option(choice);
+        ConfigurationOption mode = *config->options[0];
+        int curr_choice_idx = mode.currently_selected;
+        const char *choice =
+            static_cast<const char **>(mode.available_values)[curr_choice_idx];
+        game_config->prepopulate_grid = strcmp(choice, "Random") == 0;
+        game_config->puzzle_mode = strcmp(choice, "Puzzle") == 0;
 
         game_config->rewind_buffer_size = REWIND_BUF_SIZE;
 
@@ -466,8 +742,7 @@ void extract_game_config(GameOfLifeConfiguration *game_config,
             extract_yes_or_no_option(toroidal_array_choice);
 }
 
-StateEvolution take_simulation_step(Grid grid,
-                                    GameOfLifeGridDimensions *dimensions,
+StateEvolution take_simulation_step(Grid grid, CellGridDimensions *dimensions,
                                     bool use_toroidal_array)
 {
         // This assumes that the grid is rectangular.
@@ -523,29 +798,6 @@ StateEvolution take_simulation_step(Grid grid,
         return std::make_pair(grid, new_grid);
 }
 
-void render_state_change(Display *display, StateEvolution evolution,
-                         GameOfLifeGridDimensions *dimensions)
-{
-        int rows = dimensions->rows;
-        int cols = dimensions->cols;
-
-        for (int y = 0; y < rows; y++) {
-                for (int x = 0; x < cols; x++) {
-                        GameOfLifeCell prev =
-                            get_cell(x, y, cols, evolution.first);
-                        GameOfLifeCell curr =
-                            get_cell(x, y, cols, evolution.second);
-
-                        if (curr != prev) {
-                                Color color = curr == ALIVE ? White : Black;
-                                Point position = {.x = x, .y = y};
-                                draw_game_cell(display, &position, dimensions,
-                                               color);
-                        }
-                }
-        }
-}
-
 void save_grid_state_in_rewind_buffer(std::vector<Grid> *rewind_buffer,
                                       int *rewind_buf_idx, Grid grid)
 {
@@ -554,23 +806,22 @@ void save_grid_state_in_rewind_buffer(std::vector<Grid> *rewind_buffer,
         // a ring buffer.
         *rewind_buf_idx = (*rewind_buf_idx + 1) % rewind_buffer->size();
         int idx = *rewind_buf_idx;
-        LOG_DEBUG(TAG, "Current rewind buffer index is now %d",
-                  *rewind_buf_idx);
-        LOG_DEBUG(TAG, "Adding current state to rewind buffer at index %d",
+        // This runs on every simulation step, so it only logs at the trace
+        // level.
+        LOG_TRACE(TAG, "Adding current state to rewind buffer at index %d",
                   *rewind_buf_idx);
         if ((*rewind_buffer)[idx] != nullptr) {
-                LOG_DEBUG(TAG,
+                LOG_TRACE(TAG,
                           "Rewind buffer already has saved state at index %d, "
                           "freeing it",
                           *rewind_buf_idx);
-                delete (*rewind_buffer)[idx];
+                delete[] (*rewind_buffer)[idx];
         }
         (*rewind_buffer)[idx] = grid;
 }
 
 Grid handle_rewind(Direction dir, std::vector<Grid> *rewind_buffer,
-                   int latest_state_idx, int *rewind_buf_idx, Grid grid,
-                   GameOfLifeGridDimensions *gd, Display *display)
+                   int latest_state_idx, int *rewind_buf_idx, Grid grid)
 {
         // Ignore irrelevant input.
         if (dir == UP || dir == DOWN) {
@@ -589,8 +840,6 @@ Grid handle_rewind(Direction dir, std::vector<Grid> *rewind_buffer,
 
         if (forward_in_time) {
                 auto next_state = (*rewind_buffer)[*rewind_buf_idx];
-                render_state_change(display, std::make_pair(grid, next_state),
-                                    gd);
 
                 // Rewind cannot go into the future.
                 if (*rewind_buf_idx == latest_state_idx) {
@@ -601,8 +850,6 @@ Grid handle_rewind(Direction dir, std::vector<Grid> *rewind_buffer,
         } else if (back_in_time) {
                 auto previous_state = (*rewind_buffer)[*rewind_buf_idx];
 
-                render_state_change(display,
-                                    std::make_pair(grid, previous_state), gd);
                 // We need to use proper modulo as % is weird with
                 // negative numbers.
                 *rewind_buf_idx = mathematical_modulo((*rewind_buf_idx - 1),
@@ -629,7 +876,7 @@ Grid handle_rewind(Direction dir, std::vector<Grid> *rewind_buffer,
 }
 
 void spawn_cells_randomly(Display *display, Grid grid,
-                          GameOfLifeGridDimensions *dimensions)
+                          CellGridDimensions *dimensions)
 {
         for (int y = 0; y < dimensions->rows; y++) {
                 for (int x = 0; x < dimensions->cols; x++) {
@@ -645,61 +892,162 @@ void spawn_cells_randomly(Display *display, Grid grid,
         }
 }
 
-GameOfLifeGridDimensions *
-calculate_grid_dimensions(int display_width, int display_height,
-                          int display_rounded_corner_radius)
+GameOfLifePuzzle *generate_puzzle(CellGridDimensions *dimensions,
+                                  bool use_toroidal_array)
 {
-        // Bind input params to short names for improved readability.
-        int w = display_width;
-        int h = display_height;
-        int r = display_rounded_corner_radius;
-
-        int usable_width = w - r;
-        int usable_height = h - r;
+        int rows = dimensions->rows;
+        int cols = dimensions->cols;
+        int total_cells = rows * cols;
+        int size = (total_cells + 7) / 8;
+
+        int patterns_num = sizeof(PUZZLE_PATTERNS) / sizeof(PuzzlePattern);
+        const PuzzlePattern *pattern = &PUZZLE_PATTERNS[rand() % patterns_num];
+        bool flip_x = rand() % 2;
+        bool flip_y = rand() % 2;
+
+        // The pattern is planted in the middle half of the grid to give it
+        // some room to evolve before it hits the edges.
+        int x_range = cols / 2 - PUZZLE_PATTERN_SIZE;
+        int y_range = rows / 2 - PUZZLE_PATTERN_SIZE;
+        int origin_x = cols / 4 + (x_range > 0 ? rand() % x_range : 0);
+        int origin_y = rows / 4 + (y_range > 0 ? rand() % y_range : 0);
+
+        Grid grid = allocate_grid(total_cells);
+        for (int i = 0; i < pattern->cells; i++) {
+                int x = pattern->offsets[i][0];
+                int y = pattern->offsets[i][1];
+                x = flip_x ? PUZZLE_PATTERN_SIZE - 1 - x : x;
+                y = flip_y ? PUZZLE_PATTERN_SIZE - 1 - y : y;
+                set_cell(origin_x + x, origin_y + y, cols, grid, ALIVE);
+        }
 
-        int max_cols = usable_width / GAME_CELL_WIDTH;
-        int max_rows = usable_height / GAME_CELL_WIDTH;
+        GameOfLifePuzzle *puzzle = new GameOfLifePuzzle();
+        puzzle->uncovered_target = allocate_grid(total_cells);
+        int generations =
+            PUZZLE_MIN_GENERATIONS +
+            rand() % (PUZZLE_MAX_GENERATIONS - PUZZLE_MIN_GENERATIONS + 1);
+        for (int i = 0; i < generations; i++) {
+                StateEvolution evolution =
+                    take_simulation_step(grid, dimensions, use_toroidal_array);
+                delete[] evolution.first;
+                grid = evolution.second;
+                for (int j = 0; j < size; j++) {
+                        puzzle->uncovered_target[j] |= grid[j];
+                }
+        }
+        delete[] grid;
 
-        int actual_width = max_cols * GAME_CELL_WIDTH;
-        int actual_height = max_rows * GAME_CELL_WIDTH;
+        puzzle->uncovered_cells = 0;
+        for (int i = 0; i < size; i++) {
+                puzzle->uncovered_cells +=
+                    __builtin_popcount(puzzle->uncovered_target[i]);
+        }
+        puzzle->seeds_total = pattern->cells;
+        puzzle->seeds_left = pattern->cells;
+        puzzle->generations = 0;
+
+        LOG_INFO(TAG,
+                 "Generated puzzle with %d target cells from a %d cell "
+                 "pattern evolved for %d generations.",
+                 puzzle->uncovered_cells, pattern->cells, generations);
+        return puzzle;
+}
 
-        // We calculate centering margins
-        int left_horizontal_margin = (w - actual_width) / 2;
-        int top_vertical_margin = (h - actual_height) / 2;
+void free_puzzle(GameOfLifePuzzle *puzzle)
+{
+        delete[] puzzle->uncovered_target;
+        delete puzzle;
+}
 
-        LOG_DEBUG(TAG,
-                  "Calculated grid dimensions: %d rows, %d cols, "
-                  "left margin: %d, top margin: %d, actual width: %d, "
-                  "actual height: %d",
-                  max_rows, max_cols, left_horizontal_margin,
-                  top_vertical_margin, actual_width, actual_height);
+bool update_target_coverage(GameOfLifePuzzle *puzzle, Grid grid,
+                            int total_cells)
+{
+        int size = (total_cells + 7) / 8;
+        uint8_t any_alive = 0;
+        for (int i = 0; i < size; i++) {
+                uint8_t covered = puzzle->uncovered_target[i] & grid[i];
+                puzzle->uncovered_cells -= __builtin_popcount(covered);
+                puzzle->uncovered_target[i] &= ~grid[i];
+                any_alive |= grid[i];
+        }
+        return any_alive != 0;
+}
 
-        return new GameOfLifeGridDimensions(
-            max_rows, max_cols, top_vertical_margin, left_horizontal_margin,
-            actual_width, actual_height);
+void draw_puzzle_target(Display *display, CellGridDimensions *dimensions,
+                        GameOfLifePuzzle *puzzle)
+{
+        for (int y = 0; y < dimensions->rows; y++) {
+                for (int x = 0; x < dimensions->cols; x++) {
+                        if (get_cell(x, y, dimensions->cols,
+                                     puzzle->uncovered_target)) {
+                                Point position = {.x = x, .y = y};
+                                draw_game_cell(display, &position, dimensions,
+                                               PUZZLE_TARGET_COLOR);
+                        }
+                }
+        }
 }
 
-void draw_caret(Display *display, Point *grid_position,
-                GameOfLifeGridDimensions *dimensions, Color caret_color)
+void draw_puzzle_counters(Display *display, CellGridDimensions *dimensions,
+                          GameOfLifePuzzle *puzzle)
 {
+        int border_offset = 2;
+        int text_above_grid_y = dimensions->top_vertical_margin -
+                                border_offset - FONT_SIZE -
+                                EXPLANATION_ABOVE_GRID_OFFEST;
+
+        // The generations counter is padded to make the text width constant.
+        // Both counters are clamped so that the text always fits the buffer.
+        char text[24];
+        unsigned int seeds = std::clamp(puzzle->seeds_left, 0, 99);
+        unsigned int generations = std::clamp(puzzle->generations, 0, 999);
+        snprintf(text, sizeof(text), "Seeds: %u  Gen: %-3u", seeds,
+                 generations);
+        int text_width = strlen(text) * FONT_WIDTH;
+        int text_x = dimensions->left_horizontal_margin +
+                     (dimensions->actual_width - text_width) / 2;
+#ifdef EMULATOR
+        // The counters are redrawn in place every generation, the emulator
+        // display doesn't clear the text background so the previous text
+        // needs to be erased first.
+        display->clear_region(
+            {.x = text_x, .y = text_above_grid_y},
+            {.x = text_x + text_width, .y = text_above_grid_y + FONT_SIZE},
+            Black);
+#endif
+        display->draw_string({.x = text_x, .y = text_above_grid_y}, text,
+                             FontSize::Size16, Black, White);
+}
 
-        // We need to ensure that the caret is rendered INSIDE the text
-        // cell and its border doesn't overlap the neighbouring cells.
-        // Otherwise, we'll get weird rendering artifacts.
-        int border_offset = 1;
-        Point actual_position = {
-            .x = dimensions->left_horizontal_margin +
-                 grid_position->x * GAME_CELL_WIDTH + border_offset,
-            .y = dimensions->top_vertical_margin +
-                 grid_position->y * GAME_CELL_WIDTH + border_offset};
+Color get_cell_color(int x, int y, int cols, Grid grid,
+                     GameOfLifePuzzle *puzzle)
+{
+        if (get_cell(x, y, cols, grid) == ALIVE) {
+                return White;
+        }
+        if (puzzle && get_cell(x, y, cols, puzzle->uncovered_target)) {
+                return PUZZLE_TARGET_COLOR;
+        }
+        return Black;
+}
 
-        display->draw_rectangle(
-            actual_position, GAME_CELL_WIDTH - 2 * border_offset,
-            GAME_CELL_WIDTH - 2 * border_offset, caret_color, 1, false);
+void draw_caret(CaretOverlay *caret, Point *grid_position,
+                CellGridDimensions *dimensions, Grid grid,
+                GameOfLifePuzzle *puzzle)
+{
+        Point cell_start = {.x = dimensions->left_horizontal_margin +
+                                 grid_position->x * GAME_CELL_WIDTH,
+                            .y = dimensions->top_vertical_margin +
+                                 grid_position->y * GAME_CELL_WIDTH};
+
+        // Cells are filled with a single color, so no mask is needed.
+        Color cell_color = get_cell_color(grid_position->x, grid_position->y,
+                                          dimensions->cols, grid, puzzle);
+        caret->draw(cell_start, nullptr, cell_color, cell_color);
 }
 
 void draw_game_cell(Display *display, Point *grid_position,
-                    GameOfLifeGridDimensions *dimensions, Color color)
+                    CellGridDimensions *dimensions, Color color)
 {
         Point actual_position = {.x = dimensions->left_horizontal_margin +
                                       grid_position->x * GAME_CELL_WIDTH,
@@ -712,29 +1060,9 @@ void draw_game_cell(Display *display, Point *grid_position,
                               color);
 }
 
-void erase_caret(Display *display, Point *grid_position,
-                 GameOfLifeGridDimensions *dimensions,
-                 Color grid_background_color)
-{
-
-        // We need to ensure that the caret is rendered INSIDE the text
-        // cell and its border doesn't overlap the neighbouring cells.
-        // Otherwise, we'll get weird rendering artifacts.
-        int border_offset = 1;
-        Point actual_position = {
-            .x = dimensions->left_horizontal_margin +
-                 grid_position->x * GAME_CELL_WIDTH + border_offset,
-            .y = dimensions->top_vertical_margin +
-                 grid_position->y * GAME_CELL_WIDTH + border_offset};
-
-        display->draw_rectangle(actual_position,
-                                GAME_CELL_WIDTH - 2 * border_offset,
-                                GAME_CELL_WIDTH - 2 * border_offset,
-                                grid_background_color, 1, false);
-}
-
-void draw_game_canvas(Platform *p, GameOfLifeGridDimensions *dimensions,
-                      UserInterfaceCustomization *customization)
+void draw_game_canvas(Platform *p, CellGridDimensions *dimensions,
+                      UserInterfaceCustomization *customization,
+                      bool puzzle_mode)
 
 {
         p->display->initialize();
@@ -797,6 +1125,19 @@ void draw_game_canvas(Platform *p, GameOfLifeGridDimensions *dimensions,
         p->display->draw_string({.x = exit_text_x, .y = text_below_grid_y},
                                 (char *)exit, FontSize::Size16, Black, White);
 
+        // We draw the border after the help indicators to ensure that it
+        // doesn't get cropped by draw string operations above.
+        p->display->draw_rectangle(
+            {.x = x_margin - border_offset, .y = y_margin - border_offset},
+            actual_width + 2 * border_offset, actual_height + 2 * border_offset,
+            customization->accent_color, border_width, false);
+
+        // Rewind is not available in the puzzle mode, the space above the
+        // grid is used for the puzzle counters instead.
+        if (puzzle_mode) {
+                return;
+        }
+
         /* Rendering of help indicators above the grid */
         int text_grid_spacing = 4;
         // Because of slightly different font dimensions, we need this offset
@@ -819,17 +1160,9 @@ void draw_game_canvas(Platform *p, GameOfLifeGridDimensions *dimensions,
         int toggle_text_x = blue_circle_x + d;
         p->display->draw_string({.x = toggle_text_x, .y = text_above_grid_y},
                                 (char *)toggle, FontSize::Size16, Black, White);
-
-        // We draw the border at the end to ensure that it doesn't get cropped
-        // by draw string operations above.
-        p->display->draw_rectangle(
-            {.x = x_margin - border_offset, .y = y_margin - border_offset},
-            actual_width + 2 * border_offset, actual_height + 2 * border_offset,
-            customization->accent_color, border_width, false);
 }
 
-void draw_rewind_mode_indicator(Platform *p,
-                                GameOfLifeGridDimensions *dimensions,
+void draw_rewind_mode_indicator(Platform *p, CellGridDimensions *dimensions,
                                 UserInterfaceCustomization *customization)
 {
 
@@ -865,8 +1198,7 @@ void draw_rewind_mode_indicator(Platform *p,
             indicator_border_color, border_width, false);
 }
 
-void clear_rewind_mode_indicator(Platform *p,
-                                 GameOfLifeGridDimensions *dimensions,
+void clear_rewind_mode_indicator(Platform *p, CellGridDimensions *dimensions,
                                  UserInterfaceCustomization *customization)
 {
 
@@ -7,6 +7,12 @@
 typedef struct GameOfLifeConfiguration {
         bool prepopulate_grid;
         bool use_toroidal_array;
+        /**
+         * In the puzzle mode the user needs to cover a target pattern with
+         * live cells using a limited number of seeds. Takes precedence over
+         * `prepopulate_grid`.
+         */
+        bool puzzle_mode;
         /**
          * Simulation steps taken per second
          */
@@ -0,0 +1,121 @@
+#include "../common/logging.hpp"
+#include "high_scores.hpp"
+
+#define TAG "high_scores"
+
+#define HIGH_SCORES_TABLE_HEADER_SIZE ((int)sizeof(uint8_t))
+
+static_assert(sizeof(HighScoreSlot) == 4, "High score slots must be packed.");
+static_assert(sizeof(HighScoreTable) <= HIGH_SCORES_RECORD_BUDGET,
+              "The high score table must fit into its storage budget.");
+
+static uint32_t unpack_score(HighScoreSlot *slot)
+{
+        return slot->score[0] | (uint32_t)slot->score[1] << 8 |
+               (uint32_t)slot->score[2] << 16;
+}
+
+static void pack_score(HighScoreSlot *slot, uint32_t score)
+{
+        slot->score[0] = score & 0xFF;
+        slot->score[1] = (score >> 8) & 0xFF;
+        slot->score[2] = (score >> 16) & 0xFF;
+}
+
+static int table_length(HighScoreTable *table)
+{
+        return HIGH_SCORES_TABLE_HEADER_SIZE +
+               table->slots_count * (int)sizeof(HighScoreSlot);
+}
+
+HighScores::HighScores(RecordStore *store)
+    : store(store), table{}, table_game(Unknown), dirty(false)
+{
+}
+
+bool HighScores::submit(Game game, uint8_t variant, uint32_t score,
+                        HighScoreOrder order)
+{
+        score = score > HIGH_SCORE_MAX ? HIGH_SCORE_MAX : score;
+        load_table(game);
+
+        HighScoreSlot *slot = find_slot(variant);
+        if (slot) {
+                uint32_t best = unpack_score(slot);
+                bool better = order == HigherIsBetter ? score > best
+                                                      : score < best;
+                if (!better) {
+                        return false;
+                }
+        } else {
+                if (table.slots_count == HIGH_SCORES_MAX_SLOTS) {
+                        LOG_ERROR(TAG, "No slot left for variant %d of %s.",
+                                  variant, game_to_string(game));
+                        return false;
+                }
+                slot = &table.slots[table.slots_count++];
+                slot->variant = variant;
+        }
+
+        LOG_INFO(TAG, "New high score of %s (variant %d): %lu.",
+                 game_to_string(game), variant, (unsigned long)score);
+        pack_score(slot, score);
+        dirty = true;
+        return true;
+}
+
+bool HighScores::get_best(Game game, uint8_t variant, uint32_t *score)
+{
+        load_table(game);
+        HighScoreSlot *slot = find_slot(variant);
+        if (!slot) {
+                return false;
+        }
+        *score = unpack_score(slot);
+        return true;
+}
+
+void HighScores::flush()
+{
+        if (!dirty) {
+                return;
+        }
+        uint8_t key = RECORD_KEY_HIGH_SCORES_BASE + table_game;
+        // Only the used slots are written, the record grows with the number
+        // of played variants.
+        if (store->write(key, &table, table_length(&table),
+                         HIGH_SCORES_RECORD_VERSION)) {
+                dirty = false;
+        }
+}
+
+void HighScores::load_table(Game game)
+{
+        if (game == table_game) {
+                return;
+        }
+        flush();
+
+        table_game = game;
+        dirty = false;
+        uint8_t key = RECORD_KEY_HIGH_SCORES_BASE + game;
+        int length = store->read(key, &table, sizeof(HighScoreTable),
+                                 HIGH_SCORES_RECORD_VERSION);
+        if (length < HIGH_SCORES_TABLE_HEADER_SIZE ||
+            table.slots_count > HIGH_SCORES_MAX_SLOTS ||
+            length != table_length(&table)) {
+                LOG_DEBUG(TAG, "No high scores of %s stored yet.",
+                          game_to_string(game));
+                table.slots_count = 0;
+        }
+}
+
+HighScoreSlot *HighScores::find_slot(uint8_t variant)
+{
+        for (int i = 0; i < table.slots_count; i++) {
+                if (table.slots[i].variant == variant) {
+                        return &table.slots[i];
+                }
+        }
+        return NULL;
+}
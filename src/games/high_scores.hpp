@@ -0,0 +1,98 @@
+#pragma once
+#include <stdint.h>
+
+#include "../common/record_store.hpp"
+#include "game_menu.hpp"
+
+/**
+ * Version of the packed table layout stored in the record store.
+ */
+#define HIGH_SCORES_RECORD_VERSION 1
+/**
+ * Maximum number of configuration variants with a high score per game. 2048
+ * has the most of them: 3 grid sizes times 6 targets.
+ */
+#define HIGH_SCORES_MAX_SLOTS 20
+/**
+ * Scores are packed into 3 bytes, larger ones are clamped.
+ */
+#define HIGH_SCORE_MAX 0xFFFFFF
+/**
+ * Upper bound on the size of the record holding the table of a single game,
+ * it keeps the high scores of all games within a small, fixed part of the
+ * record store.
+ */
+#define HIGH_SCORES_RECORD_BUDGET 96
+
+typedef enum HighScoreOrder {
+        HigherIsBetter = 0,
+        LowerIsBetter = 1,
+} HighScoreOrder;
+
+/**
+ * Best score achieved with a single configuration variant of a game. The
+ * score is stored as 3 little-endian bytes, so a slot takes up 4 bytes.
+ */
+typedef struct HighScoreSlot {
+        uint8_t variant;
+        uint8_t score[3];
+} HighScoreSlot;
+
+/**
+ * High scores of a single game. Only the used slots are stored, so the
+ * record of a game with a single played variant is 5 bytes long.
+ */
+typedef struct HighScoreTable {
+        uint8_t slots_count;
+        HighScoreSlot slots[HIGH_SCORES_MAX_SLOTS];
+} HighScoreTable;
+
+/**
+ * Keeps the best score of each configuration variant of the games.
+ *
+ * The games submit their score once a round is over, what makes a variant
+ * is up to each game (e.g. the grid size and the target tile in 2048). The
+ * table of the game is loaded from the record store on the first submission
+ * and the updated table stays in RAM until `flush` is called after the game
+ * returns, so submitting a score never waits for the storage.
+ */
+class HighScores
+{
+      public:
+        HighScores(RecordStore *store);
+
+        HighScores(const HighScores &) = delete;
+        HighScores &operator=(const HighScores &) = delete;
+
+        /**
+         * Records the score if it is better than the best score of the
+         * variant so far. Returns true if it is the new best score.
+         */
+        bool submit(Game game, uint8_t variant, uint32_t score,
+                    HighScoreOrder order);
+        /**
+         * Looks up the best score of the variant. Returns false if no score
+         * was recorded for it yet.
+         */
+        bool get_best(Game game, uint8_t variant, uint32_t *score);
+        /**
+         * Writes the updated table into the record store.
+         */
+        void flush();
+
+      private:
+        /**
+         * Makes the table of the game the loaded one, the previously loaded
+         * table is written back first if it was changed.
+         */
+        void load_table(Game game);
+        HighScoreSlot *find_slot(uint8_t variant);
+
+        RecordStore *store;
+        HighScoreTable table;
+        /**
+         * Game whose table is loaded, `Unknown` if none is.
+         */
+        Game table_game;
+        bool dirty;
+};
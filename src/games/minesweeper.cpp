@@ -3,84 +3,65 @@
 #include "game_menu.hpp"
 
 #include "../common/configuration.hpp"
+#include "../common/grid_game.hpp"
 #include "../common/logging.hpp"
 #include "../common/constants.hpp"
+#include "../common/fixed_timestep.hpp"
 
 #include "common_transitions.hpp"
+#include "high_scores.hpp"
 #include "settings.hpp"
+#include <algorithm>
 #include <optional>
 #include "minesweeper.hpp"
+#include "minesweeper_board.hpp"
+#include "minesweeper_flood_fill.hpp"
+#include "minesweeper_generator.hpp"
+#include "minesweeper_solver.hpp"
 
 #define TAG "minesweeper"
 
-MinesweeperConfiguration DEFAULT_MINESWEEPER_CONFIG = {.mines_num = 25};
-
-typedef struct MinesweeperGridDimensions {
-        int rows;
-        int cols;
-        int top_vertical_margin;
-        int left_horizontal_margin;
-        int actual_width;
-        int actual_height;
-
-        MinesweeperGridDimensions(int r, int c, int tvm, int lhm, int aw,
-                                  int ah)
-            : rows(r), cols(c), top_vertical_margin(tvm),
-              left_horizontal_margin(lhm), actual_width(aw), actual_height(ah)
-        {
-        }
-} MinesweeperGridDimensions;
-
-typedef struct MinesweeperGridCell {
-        bool is_bomb;
-        bool is_flagged;
-        bool is_uncovered;
-        int adjacent_bombs;
-
-        MinesweeperGridCell()
-            : is_bomb(false), is_flagged(false), is_uncovered(false),
-              adjacent_bombs(0)
-        {
-        }
-
-} MinesweeperGridCell;
+MinesweeperConfiguration DEFAULT_MINESWEEPER_CONFIG = {.mines_num = 25,
+                                                      .auto_flag = false};
 
-static MinesweeperGridDimensions *
-calculate_grid_dimensions(int display_width, int display_height,
-                          int display_rounded_corner_radius);
-static void draw_game_canvas(Platform *p, MinesweeperGridDimensions *dimensions,
+static void draw_game_canvas(Platform *p, CellGridDimensions *dimensions,
                              UserInterfaceCustomization *customization);
 
-static void erase_caret(Display *display, Point *grid_position,
-                        MinesweeperGridDimensions *dimensions,
-                        Color grid_background_color);
-static void draw_caret(Display *display, Point *grid_position,
-                       MinesweeperGridDimensions *dimensions);
 /**
- * Performs a recursive uncovering waterfall: tries to uncover the current
- * cell, if the cell has 0 adjacent mines it uncovers all of its neighbours.
+ * Performs the uncovering waterfall: uncovers the current cell, if the cell has
+ * 0 adjacent mines it uncovers all of its neighbours, and so on. The cells are
+ * uncovered using an iterative scanline flood fill and are marked dirty so
+ * that the grid renders them in a single pass once the move is complete.
+ *
+ * `batch` receives the indices of the uncovered cells. It should have the
+ * capacity for all grid cells reserved upfront so that the fill doesn't
+ * allocate.
+ */
+static void uncover_grid_cells_starting_from(MinesweeperGrid *grid,
+                                             MinesweeperBoard *board,
+                                             Point *grid_position,
+                                             int *total_uncovered,
+                                             std::vector<uint16_t> *batch);
+/**
+ * Chord-click: if the number of flags around the uncovered cell matches its
+ * adjacent mine count, all remaining covered neighbours are uncovered (with
+ * the flood fill applied to each of them) and marked dirty. Returns true if
+ * any of the uncovered neighbours is a mine, which happens when the flags
+ * were placed incorrectly.
  */
-static void uncover_grid_cells_starting_from(
-    Display *display, Point *grid_position,
-    MinesweeperGridDimensions *dimensions,
-    std::vector<std::vector<MinesweeperGridCell>> *grid, int *total_uncovered);
-static void
-uncover_grid_cell(Display *display, Point *grid_position,
-                  MinesweeperGridDimensions *dimensions,
-                  std::vector<std::vector<MinesweeperGridCell>> *grid,
-                  int *total_uncovered);
-static void flag_grid_cell(Display *display, Point *grid_position,
-                           MinesweeperGridDimensions *dimensions,
-                           std::vector<std::vector<MinesweeperGridCell>> *grid,
-                           UserInterfaceCustomization *customization);
-static void
-unflag_grid_cell(Display *display, Point *grid_position,
-                 MinesweeperGridDimensions *dimensions,
-                 std::vector<std::vector<MinesweeperGridCell>> *grid,
-                 Color grid_background_color);
-
-void place_bombs(std::vector<std::vector<MinesweeperGridCell>> *grid,
-                 int bomb_number, Point *caret_position);
+static bool chord_grid_cell(MinesweeperGrid *grid, MinesweeperBoard *board,
+                            Point *grid_position, int *total_uncovered,
+                            std::vector<uint16_t> *batch);
+/**
+ * Feeds the cells uncovered by the latest move to the solver and propagates
+ * the new constraints. Only the frontier around those cells is reprocessed,
+ * so the cost of this doesn't grow with the number of moves. If `auto_flag`
+ * is set, newly deduced mines are flagged on the grid.
+ */
+static void update_solver(MinesweeperGrid *grid, MinesweeperBoard *board,
+                          MinesweeperSolver *solver,
+                          std::vector<uint16_t> *uncovered_batch,
+                          bool auto_flag);
 
 /**
  * Returns true if the user wants to play again. If they press blue on the
@@ -95,18 +76,20 @@ void Minesweeper::game_loop(Platform *p,
 {
         const char *help_text =
             "Use the joystick to move the caret around the grid. Press green "
-            "to uncover a cell, red to place a flag. The aim "
+            "to uncover a cell, red to place a flag and yellow to move the "
+            "caret to a cell that is known to be safe. The aim "
             "is to uncover all cells with no mines. Digits in the grid tell you"
-            " the number of mines around the cell.";
+            " the number of mines around the cell. Pressing green on a digit "
+            "with all of its mines flagged uncovers the remaining neighbours.";
 
         bool exit_requested = false;
         while (!exit_requested) {
                 switch (minesweeper_loop(p, customization)) {
-                case UserAction::PlayAgain:
+                case UserAction::PlayAgain: {
                         LOG_DEBUG(TAG, "Minesweeper game loop finished. "
                                        "Pausing for input ");
                         Direction dir;
-                        Action act;
+                        Action act = Action::YELLOW;
                         pause_until_input(p->directional_controllers,
                                           p->action_controllers, &dir, &act,
                                           p->delay_provider, p->display);
@@ -114,7 +97,7 @@ void Minesweeper::game_loop(Platform *p,
                         if (act == Action::BLUE) {
                                 exit_requested = true;
                         }
-                        break;
+                } break;
                 case UserAction::Exit:
                         exit_requested = true;
                         break;
@@ -127,6 +110,55 @@ void Minesweeper::game_loop(Platform *p,
                 }
         }
 }
+/**
+ * A single Minesweeper game driven by the `FixedTimestepScheduler`. Each
+ * update handles all inputs registered since the previous one, back to back
+ * to keep the caret snappy. The cells changed by those moves are drawn
+ * together by `render`, which does nothing if no input was handled.
+ */
+class MinesweeperSession : public FixedTimestepLoop
+{
+      public:
+        MinesweeperSession(Platform *p, MinesweeperConfiguration *config,
+                           MinesweeperGrid *grid, MinesweeperBoard *board,
+                           MinesweeperSolver *solver);
+
+        MinesweeperSession(const MinesweeperSession &) = delete;
+        MinesweeperSession &operator=(const MinesweeperSession &) = delete;
+
+        bool update() override;
+        void render() override;
+
+        bool is_game_over() { return game_over; }
+        unsigned long get_start_time() { return start_time; }
+
+      private:
+        bool is_finished();
+        void handle_directional_input(Direction dir);
+        void handle_action_input(Action act);
+
+        Platform *p;
+        MinesweeperConfiguration *config;
+        MinesweeperGrid *grid;
+        MinesweeperBoard *board;
+        MinesweeperSolver *solver;
+
+        /* We only place bombs after the user selects the cell to uncover.
+           This avoids situations where the first selected cell is a bomb
+           and the game is immediately over without user's logical error. */
+        bool bombs_placed;
+        /* The time of a game is measured from the first uncovered cell, the
+           user can look around the empty board for as long as they like. */
+        unsigned long start_time;
+        int total_uncovered;
+        std::vector<uint16_t> uncovered_batch;
+        bool game_over;
+        /**
+         * Set if the grid or the caret changed since the last frame.
+         */
+        bool changed;
+};
+
 UserAction minesweeper_loop(Platform *p,
                             UserInterfaceCustomization *customization)
 {
@@ -140,372 +172,429 @@ UserAction minesweeper_loop(Platform *p,
                 return maybe_interrupt.value();
         }
 
-        MinesweeperGridDimensions *gd = calculate_grid_dimensions(
+        CellGridDimensions *gd = calculate_cell_grid_dimensions(
             p->display->get_width(), p->display->get_height(),
-            p->display->get_display_corner_radius());
-        int rows = gd->rows;
-        int cols = gd->cols;
+            p->display->get_display_corner_radius(), FONT_WIDTH, FONT_SIZE);
+
+        /* The grid owns the cells, keeps track of the ones that changed
+           during a move, renders them in batches and takes care of the
+           caret. */
+        MinesweeperRenderer renderer(p->display, gd->cols,
+                                     customization->accent_color);
+        MinesweeperGrid grid(p->display, gd, &renderer, White);
+        int rows = grid.rows();
+        int cols = grid.cols();
 
         draw_game_canvas(p, gd, customization);
         LOG_DEBUG(TAG, "Minesweeper game canvas drawn.");
 
         p->display->refresh();
 
-        std::vector<std::vector<MinesweeperGridCell>> grid(
-            rows, std::vector<MinesweeperGridCell>(cols));
-
-        /* We only place bombs after the user selects the cell to uncover.
-           This avoids situations where the first selected cell is a bomb
-           and the game is immediately over without user's logical error. */
-        bool bombs_placed = false;
-
-        Point caret_position = {.x = 0, .y = 0};
-        draw_caret(p->display, &caret_position, gd);
-        LOG_DEBUG(TAG, "Caret rendered at initial position.");
-
-        int total_uncovered = 0;
-
-        bool is_game_over = false;
-        while (!is_game_over &&
-               !(total_uncovered == cols * rows - config.mines_num)) {
-                Direction dir;
-                Action act;
-                if (directional_input_registered(p->directional_controllers,
-                                                 &dir)) {
-                        LOG_DEBUG(TAG, "Directional input received: %s",
-                                  direction_to_str(dir));
-
-                        if (!bombs_placed) {
-                                /* Before the bombs are placed, we spin the
-                                   random number generator on each step to
-                                   ensure that we don't generate the same grid
-                                   every time we start the game console. */
-                                srand(rand());
-                        }
-
-                        /* Once the cells become uncovered, the background is
-                        set to black. Because of this, we need to change the
-                        erase color */
-                        if (grid[caret_position.y][caret_position.x]
-                                .is_uncovered) {
-                                erase_caret(p->display, &caret_position, gd,
-                                            Black);
-                                // We need to 'uncover' the cell again to ensure
-                                // that the numbers don't get cropped after the
-                                // caret overlaps with them.
-                                uncover_grid_cell(p->display, &caret_position,
-                                                  gd, &grid, &total_uncovered);
-                        } else if (grid[caret_position.y][caret_position.x]
-                                       .is_flagged) {
-                                erase_caret(p->display, &caret_position, gd,
-                                            customization->accent_color);
-                                // We need to unflag and flag the cell again to
-                                // ensure that the flag indicator doesn't get
-                                // cropped after the caret overlaps with them.
-                                unflag_grid_cell(p->display, &caret_position,
-                                                 gd, &grid,
-                                                 customization->accent_color);
-                                flag_grid_cell(p->display, &caret_position, gd,
-                                               &grid, customization);
-                        } else {
-                                erase_caret(p->display, &caret_position, gd,
-                                            customization->accent_color);
-                        }
-                        translate_within_bounds(&caret_position, dir, gd->rows,
-                                                gd->cols);
-                        draw_caret(p->display, &caret_position, gd);
-
-                        p->delay_provider->delay_ms(MOVE_REGISTERED_DELAY);
-                        /* We continue here to skip the additional input
-                           polling delay at the end of the loop and make
-                           the input snappy. */
-                        continue;
-                }
-                if (action_input_registered(p->action_controllers, &act)) {
-                        LOG_DEBUG(TAG, "Action input received: %s",
-                                  action_to_str(act));
-
-                        MinesweeperGridCell cell =
-                            grid[caret_position.y][caret_position.x];
-                        switch (act) {
-                        case Action::RED:
-                                if (!cell.is_uncovered) {
-                                        if (!cell.is_flagged) {
-                                                flag_grid_cell(
-                                                    p->display, &caret_position,
-                                                    gd, &grid, customization);
-
-                                        } else {
-                                                unflag_grid_cell(
-                                                    p->display, &caret_position,
-                                                    gd, &grid,
-                                                    customization
-                                                        ->accent_color);
-                                                draw_caret(p->display,
-                                                           &caret_position, gd);
-                                        }
-                                }
-                                break;
-                        case Action::GREEN:
-                                /* We place bombs only after the first
-                                   cell is uncovered. This is done to
-                                   avoid the situation where the first
-                                   cell is a bomb and we are getting an
-                                   instant game-over. */
-                                if (!bombs_placed) {
-                                        place_bombs(&grid, config.mines_num,
-                                                    &caret_position);
-                                        bombs_placed = true;
-                                        LOG_DEBUG(TAG, "Bombs placed.");
-                                }
-                                if (cell.is_bomb) {
-                                        is_game_over = true;
-                                }
-                                if (!cell.is_flagged) {
-                                        uncover_grid_cells_starting_from(
-                                            p->display, &caret_position, gd,
-                                            &grid, &total_uncovered);
-                                }
-                                break;
-                        default:
-                                LOG_DEBUG(TAG, "Irrelevant action input: %s",
-                                          action_to_str(act));
-                                break;
-                        }
-                        p->delay_provider->delay_ms(MOVE_REGISTERED_DELAY);
-                        /* We continue here to skip the additional input
-                           polling delay at the end of the loop and make
-                           the input snappy. */
-                        continue;
-                }
-                p->delay_provider->delay_ms(INPUT_POLLING_DELAY);
-        }
-
+        MinesweeperBoard board(rows, cols, grid.get_cells());
+        /* The solver tracks the cells that can be deduced from the uncovered
+           part of the board. It is updated incrementally after each move and
+           is used for hints and auto-flagging. */
+        MinesweeperSolver solver(&board, false);
+
+        MinesweeperSession session(p, &config, &grid, &board, &solver);
+        FixedTimestepScheduler scheduler(p->delay_provider,
+                                         INPUT_POLLING_DELAY,
+                                         INPUT_LOOP_MAX_UPDATES_PER_FRAME);
+        scheduler.run(&session);
+        bool is_game_over = session.is_game_over();
+
+        // Auto-flagging makes the game easier, so it is scored separately.
+        uint8_t variant = config.auto_flag << 7 | config.mines_num;
+        bool new_high_score = false;
         // When the game is lost, we make all bombs explode.
         if (is_game_over) {
-                for (int y = 0; y < rows; y++) {
-                        for (int x = 0; x < cols; x++) {
-                                MinesweeperGridCell cell = grid[y][x];
-                                if (cell.is_bomb) {
-                                        Point point = {.x = x, .y = y};
-                                        uncover_grid_cell(p->display, &point,
-                                                          gd, &grid,
-                                                          &total_uncovered);
-                                }
+                grid.hide_caret();
+                for (int idx = 0; idx < board.size(); idx++) {
+                        if (board.is_bomb(idx)) {
+                                board.set_uncovered(idx, true);
+                                grid.mark_dirty(idx);
                         }
                 }
+                grid.render();
 
                 pause_until_any_directional_input(
                     p->directional_controllers, p->delay_provider, p->display);
                 display_game_over(p->display, customization);
-                p->delay_provider->delay_ms(MOVE_REGISTERED_DELAY);
         } else {
+                unsigned long time_ms = p->delay_provider->get_time_ms() -
+                                        session.get_start_time();
+                new_high_score = p->high_scores->submit(
+                    Minesweeper, variant, time_ms, LowerIsBetter);
+
                 pause_until_any_directional_input(
                     p->directional_controllers, p->delay_provider, p->display);
                 display_game_won(p->display, customization);
-                p->delay_provider->delay_ms(MOVE_REGISTERED_DELAY);
+        }
+        // Lost games aren't scored, but they still show the time to beat.
+        uint32_t best_time_ms;
+        if (p->high_scores->get_best(Minesweeper, variant, &best_time_ms)) {
+                char text[32];
+                snprintf(text, sizeof(text), "Best time: %lu.%lu s",
+                         (unsigned long)best_time_ms / 1000,
+                         (unsigned long)best_time_ms % 1000 / 100);
+                display_high_score(p->display, text, new_high_score);
         }
         p->display->refresh();
+        delete gd;
         return UserAction::PlayAgain;
 }
 
-void place_bombs(std::vector<std::vector<MinesweeperGridCell>> *grid,
-                 int bomb_number, Point *caret_position)
+MinesweeperSession::MinesweeperSession(Platform *p,
+                                       MinesweeperConfiguration *config,
+                                       MinesweeperGrid *grid,
+                                       MinesweeperBoard *board,
+                                       MinesweeperSolver *solver)
+    : p(p), config(config), grid(grid), board(board), solver(solver),
+      bombs_placed(false), start_time(0), total_uncovered(0),
+      game_over(false), changed(true)
 {
-        int rows = grid->size();
-        int cols = (*grid->begin().base()).size();
-        for (int i = 0; i < bomb_number; i++) {
-                while (true) {
-                        int x = rand() % cols;
-                        int y = rand() % rows;
-
-                        Point random_position = {.x = x, .y = y};
-
-                        bool is_close_to_caret =
-                            is_adjacent(caret_position, &random_position);
-                        if (!(*grid)[y][x].is_bomb && !is_close_to_caret) {
-                                (*grid)[y][x].is_bomb = true;
-                                (*grid)[y][x].adjacent_bombs = 0;
-
-                                Point current = {.x = x, .y = y};
-                                for (Point nb : get_neighbours_inside_grid(
-                                         &current, rows, cols)) {
-                                        (*grid)[nb.y][nb.x].adjacent_bombs++;
-                                }
+        uncovered_batch.reserve(board->size());
+        grid->set_caret({.x = 0, .y = 0});
+        LOG_DEBUG(TAG, "Caret rendered at initial position.");
+}
 
-                                break;
-                        }
+bool MinesweeperSession::is_finished()
+{
+        return game_over ||
+               total_uncovered == board->size() - config->mines_num;
+}
+
+bool MinesweeperSession::update()
+{
+        while (!is_finished()) {
+                Direction dir;
+                Action act;
+                if (directional_input_registered(p->directional_controllers,
+                                                 &dir)) {
+                        handle_directional_input(dir);
+                } else if (action_input_registered(p->action_controllers,
+                                                   &act)) {
+                        handle_action_input(act);
+                } else {
+                        break;
                 }
+                changed = true;
         }
+        return !is_finished();
 }
 
-void erase_caret(Display *display, Point *grid_position,
-                 MinesweeperGridDimensions *dimensions,
-                 Color grid_background_color)
+void MinesweeperSession::render()
 {
-        // We need to ensure that the caret is rendered INSIDE the text
-        // cell and its border doesn't overlap the neighbouring cells.
-        // Otherwise, we'll get weird rendering artifacts where the border get
-        // clipped.
-        int border_offset = 1;
-        Point actual_position = {
-            .x = dimensions->left_horizontal_margin +
-                 grid_position->x * FONT_WIDTH + border_offset,
-            .y = dimensions->top_vertical_margin +
-                 grid_position->y * FONT_SIZE + border_offset};
-
-        display->draw_rectangle(actual_position, FONT_WIDTH - 2 * border_offset,
-                                FONT_SIZE - 2 * border_offset,
-                                grid_background_color, 1, false);
+        if (!changed) {
+                return;
+        }
+        // All cells changed by the moves since the last frame are drawn at
+        // once.
+        grid->render();
+        p->display->refresh();
+        changed = false;
 }
 
-void draw_caret(Display *display, Point *grid_position,
-                MinesweeperGridDimensions *dimensions)
+void MinesweeperSession::handle_directional_input(Direction dir)
 {
+        LOG_DEBUG(TAG, "Directional input received: %s",
+                  direction_to_str(dir));
+
+        if (!bombs_placed) {
+                /* Before the bombs are placed, we spin the random number
+                   generator on each step to ensure that we don't generate
+                   the same grid every time we start the game console. */
+                srand(rand());
+        }
 
-        // We need to ensure that the caret is rendered INSIDE the text
-        // cell and its border doesn't overlap the neighbouring cells.
-        // Otherwise, we'll get weird rendering artifacts.
-        int border_offset = 1;
-        Point actual_position = {
-            .x = dimensions->left_horizontal_margin +
-                 grid_position->x * FONT_WIDTH + border_offset,
-            .y = dimensions->top_vertical_margin +
-                 grid_position->y * FONT_SIZE + border_offset};
-
-        display->draw_rectangle(actual_position, FONT_WIDTH - 2 * border_offset,
-                                FONT_SIZE - 2 * border_offset, White, 1, false);
+        grid->move_caret(dir, false);
 }
-void uncover_grid_cell(Display *display, Point *grid_position,
-                       MinesweeperGridDimensions *dimensions,
-                       std::vector<std::vector<MinesweeperGridCell>> *grid,
-                       int *total_uncovered)
-{
-
-        Point actual_position = {.x = dimensions->left_horizontal_margin +
-                                      grid_position->x * FONT_WIDTH,
-                                 .y = dimensions->top_vertical_margin +
-                                      grid_position->y * FONT_SIZE};
-
-        char text[2];
 
-        MinesweeperGridCell cell = (*grid)[grid_position->y][grid_position->x];
-        // We need this check as we 're-uncover' cells after the caret
-        // passes over them to remove rendering overlap artifacts.
-        if (!cell.is_uncovered) {
-                (*total_uncovered)++;
-                (*grid)[grid_position->y][grid_position->x].is_uncovered = true;
-        }
-        Color text_color = White;
-        if (cell.is_bomb) {
-                sprintf(text, "*");
-        } else if (cell.adjacent_bombs == 0) {
-                sprintf(text, " ");
-        } else {
-                sprintf(text, "%d", cell.adjacent_bombs);
-                /* We override the rendering color depending on the
-                   number of bombs around the cell to make it easier to
-                   read the UI. */
-                switch (cell.adjacent_bombs) {
-                case 1:
-                        text_color = Cyan;
-                        break;
-                case 2:
-                        text_color = Green;
+void MinesweeperSession::handle_action_input(Action act)
+{
+        LOG_DEBUG(TAG, "Action input received: %s", action_to_str(act));
+
+        Point caret_position = grid->get_caret();
+        int caret_idx = board->index(caret_position.x, caret_position.y);
+        switch (act) {
+        case Action::RED:
+                if (!board->is_uncovered(caret_idx)) {
+                        board->set_flagged(caret_idx,
+                                           !board->is_flagged(caret_idx));
+                        grid->mark_dirty(caret_idx);
+                }
+                break;
+        case Action::GREEN:
+                /* We place bombs only after the first cell is uncovered. This
+                   is done to avoid the situation where the first cell is a
+                   bomb and we are getting an instant game-over. It also
+                   allows us to ensure that the board can be solved from that
+                   cell without guessing. */
+                if (!bombs_placed) {
+                        generate_solvable_board(
+                            board, config->mines_num, &caret_position,
+                            p->delay_provider,
+                            MINESWEEPER_GENERATION_BUDGET_MS);
+                        solver->reset();
+                        // The generator rewrites the cells shared with the
+                        // grid, the flagged ones are redrawn to keep the
+                        // screen in sync with them.
+                        for (int idx = 0; idx < board->size(); idx++) {
+                                if (board->is_flagged(idx)) {
+                                        grid->mark_dirty(idx);
+                                }
+                        }
+                        bombs_placed = true;
+                        start_time = p->delay_provider->get_time_ms();
+                        LOG_DEBUG(TAG, "Bombs placed.");
+                }
+                if (board->is_uncovered(caret_idx)) {
+                        game_over = chord_grid_cell(grid, board,
+                                                    &caret_position,
+                                                    &total_uncovered,
+                                                    &uncovered_batch);
+                        update_solver(grid, board, solver, &uncovered_batch,
+                                      config->auto_flag);
                         break;
-                case 3:
-                        text_color = Red;
+                }
+                if (board->is_bomb(caret_idx)) {
+                        game_over = true;
+                }
+                if (!board->is_flagged(caret_idx)) {
+                        uncover_grid_cells_starting_from(
+                            grid, board, &caret_position, &total_uncovered,
+                            &uncovered_batch);
+                        update_solver(grid, board, solver, &uncovered_batch,
+                                      config->auto_flag);
+                }
+                break;
+        case Action::YELLOW: {
+                if (!bombs_placed) {
+                        LOG_DEBUG(TAG,
+                                  "No hints available before the first move.");
                         break;
-                case 4:
-                        text_color = Magenta;
+                }
+                int safe_idx = solver->find_safe_cell();
+                if (safe_idx == -1) {
+                        LOG_DEBUG(TAG, "No safe cell can be deduced, a guess "
+                                       "is required.");
                         break;
                 }
+                grid->set_caret({.x = board->x_of(safe_idx),
+                                 .y = board->y_of(safe_idx)});
+                LOG_DEBUG(TAG, "Hint: cell (%d, %d) is safe.",
+                          board->x_of(safe_idx), board->y_of(safe_idx));
+        } break;
+        default:
+                LOG_DEBUG(TAG, "Irrelevant action input: %s",
+                          action_to_str(act));
+                break;
         }
-        display->draw_rectangle(actual_position, FONT_WIDTH, FONT_SIZE, Black,
-                                0, true);
+}
 
-        display->draw_string(actual_position, text, FontSize::Size16, Black,
-                             text_color);
+void uncover_grid_cells_starting_from(MinesweeperGrid *grid,
+                                      MinesweeperBoard *board,
+                                      Point *grid_position,
+                                      int *total_uncovered,
+                                      std::vector<uint16_t> *batch)
+{
+        batch->clear();
+        flood_fill_from(board, grid_position->x, grid_position->y,
+                        total_uncovered, batch);
+        for (uint16_t idx : *batch) {
+                grid->mark_dirty(idx);
+        }
 }
 
-void uncover_grid_cells_starting_from(
-    Display *display, Point *grid_position,
-    MinesweeperGridDimensions *dimensions,
-    std::vector<std::vector<MinesweeperGridCell>> *grid, int *total_uncovered)
+bool chord_grid_cell(MinesweeperGrid *grid, MinesweeperBoard *board,
+                     Point *grid_position, int *total_uncovered,
+                     std::vector<uint16_t> *batch)
 {
+        batch->clear();
+        int x = grid_position->x;
+        int y = grid_position->y;
+        int idx = board->index(x, y);
+        if (board->is_bomb(idx) || board->adjacent_bombs(idx) == 0) {
+                return false;
+        }
 
-        uncover_grid_cell(display, grid_position, dimensions, grid,
-                          total_uncovered);
-
-        int rows = grid->size();
-        int cols = (*grid->begin().base()).size();
-        MinesweeperGridCell current_cell =
-            (*grid)[grid_position->y][grid_position->x];
-
-        if (!current_cell.is_bomb && current_cell.adjacent_bombs == 0) {
-                auto neighbours =
-                    get_neighbours_inside_grid(grid_position, rows, cols);
-                for (Point nb : neighbours) {
-                        MinesweeperGridCell neighbour_cell =
-                            (*grid)[nb.y][nb.x];
-
-                        if (!neighbour_cell.is_uncovered &&
-                            !neighbour_cell.is_flagged) {
-                                uncover_grid_cells_starting_from(
-                                    display, &nb, dimensions, grid,
-                                    total_uncovered);
+        int flags = 0;
+        for (int ny = y - 1; ny <= y + 1; ny++) {
+                for (int nx = x - 1; nx <= x + 1; nx++) {
+                        if (board->contains(nx, ny) &&
+                            board->is_flagged(nx, ny)) {
+                                flags++;
+                        }
+                }
+        }
+        if (flags != board->adjacent_bombs(idx)) {
+                LOG_DEBUG(TAG, "Chord ignored: %d flags around a cell with %d "
+                               "adjacent mines.",
+                          flags, board->adjacent_bombs(idx));
+                return false;
+        }
+
+        bool mine_uncovered = false;
+        for (int ny = y - 1; ny <= y + 1; ny++) {
+                for (int nx = x - 1; nx <= x + 1; nx++) {
+                        if (!board->contains(nx, ny)) {
+                                continue;
+                        }
+                        int nb = board->index(nx, ny);
+                        if (board->is_uncovered(nb) || board->is_flagged(nb)) {
+                                continue;
+                        }
+                        if (board->is_bomb(nb)) {
+                                mine_uncovered = true;
                         }
+                        flood_fill_from(board, nx, ny, total_uncovered, batch);
                 }
         }
+        LOG_DEBUG(TAG, "Chord uncovered %d cells.", (int)batch->size());
+        for (uint16_t idx : *batch) {
+                grid->mark_dirty(idx);
+        }
+        return mine_uncovered;
 }
 
-void flag_grid_cell(Display *display, Point *grid_position,
-                    MinesweeperGridDimensions *dimensions,
-                    std::vector<std::vector<MinesweeperGridCell>> *grid,
-                    UserInterfaceCustomization *customization)
+MinesweeperRenderer::MinesweeperRenderer(Display *display, int max_run_length,
+                                         Color covered_color)
+    : covered_color(covered_color)
 {
+        glyphs = new GlyphCache(display, Size16, "12345678*f");
+        run_mask = new uint8_t[glyphs->mask_size(max_run_length)];
+        run_text = new char[max_run_length + 1];
+}
 
-        (*grid)[grid_position->y][grid_position->x].is_flagged = true;
-        Point actual_position = {.x = dimensions->left_horizontal_margin +
-                                      grid_position->x * FONT_WIDTH,
-                                 .y = dimensions->top_vertical_margin +
-                                      grid_position->y * FONT_SIZE};
-
-        {
+MinesweeperRenderer::~MinesweeperRenderer()
+{
+        delete glyphs;
+        delete[] run_mask;
+        delete[] run_text;
+}
 
-                char text[2];
-                sprintf(text, "f");
-                display->draw_string(actual_position, text, FontSize::Size16,
-                                     customization->accent_color, White);
+CellAppearance MinesweeperRenderer::get_appearance(const uint8_t &cell)
+{
+        CellAppearance appearance = {.mask = nullptr,
+                                     .background = get_background(cell),
+                                     .foreground = get_foreground(cell)};
+        char label[2] = {get_label(cell), '\0'};
+        if (label[0] != ' ') {
+                glyphs->compose(label, 1, run_mask);
+                appearance.mask = run_mask;
         }
-        if (false) {
+        return appearance;
+}
 
-                char text[2];
-                sprintf(text, "*");
-                display->draw_string(actual_position, text, FontSize::Size16,
-                                     customization->accent_color, White);
+/**
+ * The run is split into parts of cells that share the same colors, each of
+ * them is composed in memory and sent to the display as a single bitmap.
+ * Blank cells don't show their foreground, so they join a part of any text
+ * color.
+ */
+void MinesweeperRenderer::draw_run(Display *display, Point start,
+                                   const uint8_t *cells, int length)
+{
+        int i = 0;
+        while (i < length) {
+                int part_start = i;
+                Color background = get_background(cells[i]);
+                Color foreground = get_foreground(cells[i]);
+                bool foreground_set = false;
+
+                while (i < length &&
+                       get_background(cells[i]) == background) {
+                        char label = get_label(cells[i]);
+                        if (label != ' ') {
+                                Color color = get_foreground(cells[i]);
+                                if (foreground_set && color != foreground) {
+                                        break;
+                                }
+                                foreground = color;
+                                foreground_set = true;
+                        }
+                        run_text[i - part_start] = label;
+                        i++;
+                }
+                int part_length = i - part_start;
+                run_text[part_length] = '\0';
+
+                glyphs->compose(run_text, part_length, run_mask);
+                display->draw_bitmap(
+                    {.x = start.x + part_start * FONT_WIDTH, .y = start.y},
+                    part_length * FONT_WIDTH, FONT_SIZE, run_mask, background,
+                    foreground);
         }
 }
 
-void unflag_grid_cell(Display *display, Point *grid_position,
-                      MinesweeperGridDimensions *dimensions,
-                      std::vector<std::vector<MinesweeperGridCell>> *grid,
-                      Color grid_background_color)
+char MinesweeperRenderer::get_label(uint8_t cell)
 {
+        if (!(cell & MINESWEEPER_UNCOVERED_BIT)) {
+                return cell & MINESWEEPER_FLAG_BIT ? 'f' : ' ';
+        }
+        if (cell & MINESWEEPER_BOMB_BIT) {
+                return '*';
+        }
+        int adjacent_bombs = cell & MINESWEEPER_ADJACENT_BOMBS_MASK;
+        return adjacent_bombs == 0 ? ' ' : '0' + adjacent_bombs;
+}
 
-        (*grid)[grid_position->y][grid_position->x].is_flagged = false;
-        Point actual_position = {.x = dimensions->left_horizontal_margin +
-                                      grid_position->x * FONT_WIDTH,
-                                 .y = dimensions->top_vertical_margin +
-                                      grid_position->y * FONT_SIZE};
+Color MinesweeperRenderer::get_background(uint8_t cell)
+{
+        return cell & MINESWEEPER_UNCOVERED_BIT ? Black : covered_color;
+}
 
-        display->clear_region(actual_position,
-                              {.x = actual_position.x + FONT_WIDTH,
-                               .y = actual_position.y + FONT_SIZE},
-                              grid_background_color);
+/**
+ * We override the rendering color depending on the number of bombs around the
+ * cell to make it easier to read the UI.
+ */
+Color MinesweeperRenderer::get_foreground(uint8_t cell)
+{
+        if (!(cell & MINESWEEPER_UNCOVERED_BIT)) {
+                return cell & MINESWEEPER_FLAG_BIT ? White : covered_color;
+        }
+        if (cell & MINESWEEPER_BOMB_BIT) {
+                return White;
+        }
+        switch (cell & MINESWEEPER_ADJACENT_BOMBS_MASK) {
+        case 1:
+                return Cyan;
+        case 2:
+                return Green;
+        case 3:
+                return Red;
+        case 4:
+                return Magenta;
+        default:
+                return White;
+        }
+}
+void update_solver(MinesweeperGrid *grid, MinesweeperBoard *board,
+                   MinesweeperSolver *solver,
+                   std::vector<uint16_t> *uncovered_batch, bool auto_flag)
+{
+        for (uint16_t idx : *uncovered_batch) {
+                if (!board->is_bomb(idx)) {
+                        solver->cell_uncovered(idx);
+                }
+        }
+        int deductions = solver->propagate();
+        LOG_DEBUG(TAG, "Solver made %d new deductions.", deductions);
+
+        // Mines are reported by the solver one at a time, so we need to drain
+        // them even if auto-flagging is off.
+        int mine_idx;
+        while ((mine_idx = solver->next_deduced_mine()) != -1) {
+                if (!auto_flag || board->is_flagged(mine_idx) ||
+                    board->is_uncovered(mine_idx)) {
+                        continue;
+                }
+                board->set_flagged(mine_idx, true);
+                grid->mark_dirty(mine_idx);
+        }
 }
 
-Configuration *assemble_minesweeper_configuration(PersistentStorage *storage);
+Configuration *assemble_minesweeper_configuration(SettingsCache *settings);
 void extract_game_config(MinesweeperConfiguration *game_config,
                          Configuration *config);
 
@@ -514,7 +603,7 @@ collect_minesweeper_config(Platform *p, MinesweeperConfiguration *game_config,
                            UserInterfaceCustomization *customization)
 {
         Configuration *config =
-            assemble_minesweeper_configuration(p->persistent_storage);
+            assemble_minesweeper_configuration(p->settings_cache);
 
         auto maybe_interrupt = collect_configuration(p, config, customization);
         if (maybe_interrupt) {
@@ -527,48 +616,54 @@ collect_minesweeper_config(Platform *p, MinesweeperConfiguration *game_config,
 }
 
 MinesweeperConfiguration *
-load_initial_minesweeper_config(PersistentStorage *storage)
+load_initial_minesweeper_config(SettingsCache *settings)
 {
-        int storage_offset = get_settings_storage_offsets()[Minesweeper];
-        LOG_DEBUG(TAG, "Loading minesweeper saved config from offset %d",
-                  storage_offset);
+        LOG_DEBUG(TAG, "Loading minesweeper saved config.");
 
-        MinesweeperConfiguration config = {.mines_num = 0};
+        MinesweeperConfiguration config = {.mines_num = 0, .auto_flag = false};
 
-        LOG_DEBUG(
-            TAG, "Trying to load initial settings from the persistent storage");
-        storage->get(storage_offset, config);
+        LOG_DEBUG(TAG, "Trying to load initial settings from the cache.");
+        bool loaded = settings->get(Minesweeper, &config);
 
         MinesweeperConfiguration *output = new MinesweeperConfiguration();
 
-        if (config.mines_num == 0) {
+        if (!loaded) {
                 LOG_DEBUG(TAG,
                           "The storage does not contain a valid "
                           "minesweeper configuration, using default values.");
                 memcpy(output, &DEFAULT_MINESWEEPER_CONFIG,
                        sizeof(MinesweeperConfiguration));
-                storage->put(storage_offset, DEFAULT_MINESWEEPER_CONFIG);
+                settings->put(Minesweeper, &DEFAULT_MINESWEEPER_CONFIG);
 
         } else {
                 LOG_DEBUG(TAG, "Using configuration from persistent storage.");
                 memcpy(output, &config, sizeof(MinesweeperConfiguration));
         }
 
-        LOG_DEBUG(TAG, "Loaded minesweeper game configuration: mines_num=%d",
-                  output->mines_num);
+        LOG_DEBUG(TAG,
+                  "Loaded minesweeper game configuration: mines_num=%d, "
+                  "auto_flag=%d",
+                  output->mines_num, output->auto_flag);
 
         return output;
 }
 
-Configuration *assemble_minesweeper_configuration(PersistentStorage *storage)
+bool extract_yes_or_no_option(const char *value);
+const char *map_boolean_to_yes_or_no(bool value);
+
+Configuration *assemble_minesweeper_configuration(SettingsCache *settings)
 {
         MinesweeperConfiguration *initial_config =
-            load_initial_minesweeper_config(storage);
+            load_initial_minesweeper_config(settings);
 
         ConfigurationOption *mines_count = ConfigurationOption::of_integers(
             "Number of mines", {10, 15, 25, 30, 35}, initial_config->mines_num);
 
-        std::vector<ConfigurationOption *> options = {mines_count};
+        ConfigurationOption *auto_flag = ConfigurationOption::of_strings(
+            "Auto-flag mines", {"Yes", "No"},
+            map_boolean_to_yes_or_no(initial_config->auto_flag));
+
+        std::vector<ConfigurationOption *> options = {mines_count, auto_flag};
 
         return new Configuration("Minesweeper", options, "Start Game");
 }
@@ -583,43 +678,15 @@ void extract_game_config(MinesweeperConfiguration *game_config,
         int curr_mines_count_idx = mines_num.currently_selected;
         game_config->mines_num = static_cast<int *>(
             mines_num.available_values)[curr_mines_count_idx];
-}
-
-MinesweeperGridDimensions *
-calculate_grid_dimensions(int display_width, int display_height,
-                          int display_rounded_corner_radius)
-{
-        // Bind input params to short names for improved readability.
-        int w = display_width;
-        int h = display_height;
-        int r = display_rounded_corner_radius;
-
-        int usable_width = w - r;
-        int usable_height = h - r;
 
-        int max_cols = usable_width / FONT_WIDTH;
-        int max_rows = usable_height / FONT_SIZE;
-
-        int actual_width = max_cols * FONT_WIDTH;
-        int actual_height = max_rows * FONT_SIZE;
-
-        // We calculate centering margins
-        int left_horizontal_margin = (w - actual_width) / 2;
-        int top_vertical_margin = (h - actual_height) / 2;
-
-        LOG_DEBUG(TAG,
-                  "Calculated grid dimensions: %d rows, %d cols, "
-                  "left margin: %d, top margin: %d, actual width: %d, "
-                  "actual height: %d",
-                  max_rows, max_cols, left_horizontal_margin,
-                  top_vertical_margin, actual_width, actual_height);
-
-        return new MinesweeperGridDimensions(
-            max_rows, max_cols, top_vertical_margin, left_horizontal_margin,
-            actual_width, actual_height);
+        ConfigurationOption auto_flag = *config->options[1];
+        int auto_flag_choice_idx = auto_flag.currently_selected;
+        const char *auto_flag_choice = static_cast<const char **>(
+            auto_flag.available_values)[auto_flag_choice_idx];
+        game_config->auto_flag = extract_yes_or_no_option(auto_flag_choice);
 }
 
-void draw_game_canvas(Platform *p, MinesweeperGridDimensions *dimensions,
+void draw_game_canvas(Platform *p, CellGridDimensions *dimensions,
                       UserInterfaceCustomization *customization)
 
 {
@@ -2,12 +2,68 @@
 #include "game_executor.hpp"
 #include "common_transitions.hpp"
 #include "../common/configuration.hpp"
+#include "../common/glyph_cache.hpp"
+#include "../common/grid_game.hpp"
 #include <optional>
 
 typedef struct MinesweeperConfiguration {
         int mines_num;
+        /**
+         * If set, cells that the solver deduces to be mines are flagged
+         * automatically after each move.
+         */
+        bool auto_flag;
 } MinesweeperConfiguration;
 
+/**
+ * Renders the cells of the Minesweeper grid. The labels of the cells (digits,
+ * the bomb symbol and the flag) are rasterized once when the game starts. A
+ * run of adjacent cells in the same row can then be composed in memory and
+ * sent to the display as a single bitmap, instead of clearing and drawing each
+ * cell separately.
+ */
+class MinesweeperRenderer
+{
+      public:
+        /**
+         * `max_run_length` is the longest run of cells that can be drawn at
+         * once, i.e. the number of grid columns. Covered cells are filled
+         * with `covered_color`.
+         */
+        MinesweeperRenderer(Display *display, int max_run_length,
+                            Color covered_color);
+        ~MinesweeperRenderer();
+
+        MinesweeperRenderer(const MinesweeperRenderer &) = delete;
+        MinesweeperRenderer &operator=(const MinesweeperRenderer &) = delete;
+
+        /**
+         * The returned mask is valid until the next call to the renderer.
+         */
+        CellAppearance get_appearance(const uint8_t &cell);
+        void draw_run(Display *display, Point start, const uint8_t *cells,
+                      int length);
+
+      private:
+        char get_label(uint8_t cell);
+        Color get_background(uint8_t cell);
+        Color get_foreground(uint8_t cell);
+
+        Color covered_color;
+        GlyphCache *glyphs;
+        uint8_t *run_mask;
+        char *run_text;
+};
+
+/**
+ * The largest grid that fits on any of the supported displays, the grid on the
+ * emulator is 24x12 cells.
+ */
+#define MINESWEEPER_MAX_CELLS 288
+
+typedef GridGame<uint8_t, MinesweeperRenderer, MINESWEEPER_MAX_CELLS>
+    MinesweeperGrid;
+
 /**
  * Similar to `collect_configuration` from `configuration.hpp`, it returns true
  * if the configuration was successfully collected. Otherwise, if the user
@@ -0,0 +1,128 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+/* Layout of a single byte-sized cell of the minesweeper board. */
+#define MINESWEEPER_ADJACENT_BOMBS_MASK 0x0F
+#define MINESWEEPER_BOMB_BIT 0x10
+#define MINESWEEPER_FLAG_BIT 0x20
+#define MINESWEEPER_UNCOVERED_BIT 0x40
+
+/**
+ * Minesweeper board stored as a flat row-major array with one byte per cell.
+ * The lower four bits of each cell hold the number of adjacent bombs (at most
+ * 8) and the upper bits indicate whether the cell is a bomb, is flagged or has
+ * been uncovered.
+ *
+ * Cells can be addressed either using their (x, y) grid position or their
+ * index in the row-major order, the latter is useful for compactly storing
+ * cell positions in queues and batches.
+ */
+class MinesweeperBoard
+{
+      public:
+        int rows;
+        int cols;
+
+        MinesweeperBoard(int rows, int cols)
+            : rows(rows), cols(cols), cells(new uint8_t[rows * cols]),
+              owns_cells(true)
+        {
+                clear();
+        }
+        /**
+         * Creates a board on top of externally owned cell storage of at least
+         * `rows * cols` bytes, e.g. the cells of the grid engine. This lets the
+         * game rules and the rendering share a single copy of the cells.
+         */
+        MinesweeperBoard(int rows, int cols, uint8_t *storage)
+            : rows(rows), cols(cols), cells(storage), owns_cells(false)
+        {
+                clear();
+        }
+        ~MinesweeperBoard()
+        {
+                if (owns_cells) {
+                        delete[] cells;
+                }
+        }
+
+        MinesweeperBoard(const MinesweeperBoard &) = delete;
+        MinesweeperBoard &operator=(const MinesweeperBoard &) = delete;
+
+        /**
+         * Resets all cells to covered, unflagged and without bombs.
+         */
+        void clear() { memset(cells, 0, rows * cols); }
+        /**
+         * Removes the bombs and the adjacent bomb counts, the flags and the
+         * uncovered cells are kept. The board generator uses this as the
+         * user can place flags before the bombs are placed.
+         */
+        void clear_bombs()
+        {
+                for (int idx = 0; idx < rows * cols; idx++) {
+                        cells[idx] &= ~(MINESWEEPER_BOMB_BIT |
+                                        MINESWEEPER_ADJACENT_BOMBS_MASK);
+                }
+        }
+
+        int size() { return rows * cols; }
+        int index(int x, int y) { return y * cols + x; }
+        int x_of(int idx) { return idx % cols; }
+        int y_of(int idx) { return idx / cols; }
+        bool contains(int x, int y)
+        {
+                return x >= 0 && y >= 0 && x < cols && y < rows;
+        }
+
+        bool is_bomb(int idx) { return cells[idx] & MINESWEEPER_BOMB_BIT; }
+        bool is_flagged(int idx) { return cells[idx] & MINESWEEPER_FLAG_BIT; }
+        bool is_uncovered(int idx)
+        {
+                return cells[idx] & MINESWEEPER_UNCOVERED_BIT;
+        }
+        int adjacent_bombs(int idx)
+        {
+                return cells[idx] & MINESWEEPER_ADJACENT_BOMBS_MASK;
+        }
+
+        void set_bomb(int idx, bool value)
+        {
+                set_bit(idx, MINESWEEPER_BOMB_BIT, value);
+        }
+        void set_flagged(int idx, bool value)
+        {
+                set_bit(idx, MINESWEEPER_FLAG_BIT, value);
+        }
+        void set_uncovered(int idx, bool value)
+        {
+                set_bit(idx, MINESWEEPER_UNCOVERED_BIT, value);
+        }
+        void set_adjacent_bombs(int idx, int count)
+        {
+                cells[idx] = (cells[idx] & ~MINESWEEPER_ADJACENT_BOMBS_MASK) |
+                             (count & MINESWEEPER_ADJACENT_BOMBS_MASK);
+        }
+
+        bool is_bomb(int x, int y) { return is_bomb(index(x, y)); }
+        bool is_flagged(int x, int y) { return is_flagged(index(x, y)); }
+        bool is_uncovered(int x, int y) { return is_uncovered(index(x, y)); }
+        int adjacent_bombs(int x, int y)
+        {
+                return adjacent_bombs(index(x, y));
+        }
+
+      private:
+        void set_bit(int idx, uint8_t bit, bool value)
+        {
+                if (value) {
+                        cells[idx] |= bit;
+                } else {
+                        cells[idx] &= ~bit;
+                }
+        }
+
+        uint8_t *cells;
+        bool owns_cells;
+};
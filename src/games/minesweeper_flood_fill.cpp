@@ -0,0 +1,155 @@
+#include <algorithm>
+
+#include "minesweeper_flood_fill.hpp"
+
+#include "../common/logging.hpp"
+
+#define TAG "minesweeper"
+
+/**
+ * Returns true if any of the neighbours of the cell is an uncovered cell with
+ * no adjacent mines. Such cells need to be uncovered by the flood fill.
+ */
+static bool has_uncovered_empty_neighbour(MinesweeperBoard *board, int x,
+                                          int y)
+{
+        for (int ny = y - 1; ny <= y + 1; ny++) {
+                for (int nx = x - 1; nx <= x + 1; nx++) {
+                        if (!board->contains(nx, ny) || (nx == x && ny == y)) {
+                                continue;
+                        }
+                        int idx = board->index(nx, ny);
+                        if (board->is_uncovered(idx) && !board->is_bomb(idx) &&
+                            board->adjacent_bombs(idx) == 0) {
+                                return true;
+                        }
+                }
+        }
+        return false;
+}
+
+void flood_fill_from(MinesweeperBoard *board, int start_x, int start_y,
+                     int *total_uncovered, std::vector<uint16_t> *batch,
+                     int queue_capacity)
+{
+        int rows = board->rows;
+        int cols = board->cols;
+
+        uint16_t queue[FLOOD_FILL_QUEUE_CAPACITY];
+        int capacity =
+            std::clamp(queue_capacity, 1, FLOOD_FILL_QUEUE_CAPACITY);
+        int queue_head = 0;
+        int queue_size = 0;
+        bool queue_overflowed = false;
+
+        auto push_seed = [&](int x, int y) {
+                if (queue_size == capacity) {
+                        queue_overflowed = true;
+                        return;
+                }
+                int tail = (queue_head + queue_size) % capacity;
+                queue[tail] = board->index(x, y);
+                queue_size++;
+        };
+
+        // Empty cells that haven't been uncovered yet are the ones that
+        // propagate the fill.
+        auto is_fillable = [&](int x, int y) {
+                int idx = board->index(x, y);
+                return !board->is_uncovered(idx) && !board->is_flagged(idx) &&
+                       !board->is_bomb(idx) && board->adjacent_bombs(idx) == 0;
+        };
+
+        auto reveal = [&](int x, int y) {
+                int idx = board->index(x, y);
+                if (board->is_uncovered(idx) || board->is_flagged(idx)) {
+                        return;
+                }
+                board->set_uncovered(idx, true);
+                (*total_uncovered)++;
+                batch->push_back(idx);
+        };
+
+        // Uncovers all neighbours of an uncovered span of empty cells in row
+        // `y`. Numbered neighbours are uncovered right away, whereas for each
+        // run of empty neighbours we only queue a single seed.
+        auto expand_span = [&](int y, int left, int right) {
+                int from = left > 0 ? left - 1 : 0;
+                int to = right < cols - 1 ? right + 1 : cols - 1;
+                reveal(from, y);
+                reveal(to, y);
+                for (int ny = y - 1; ny <= y + 1; ny += 2) {
+                        if (ny < 0 || ny >= rows) {
+                                continue;
+                        }
+                        bool in_run = false;
+                        for (int x = from; x <= to; x++) {
+                                if (is_fillable(x, ny)) {
+                                        if (!in_run) {
+                                                push_seed(x, ny);
+                                        }
+                                        in_run = true;
+                                } else {
+                                        in_run = false;
+                                        reveal(x, ny);
+                                }
+                        }
+                }
+        };
+
+        int start = board->index(start_x, start_y);
+        if (is_fillable(start_x, start_y)) {
+                push_seed(start_x, start_y);
+        } else {
+                reveal(start_x, start_y);
+                if (!board->is_bomb(start) &&
+                    board->adjacent_bombs(start) == 0) {
+                        expand_span(start_y, start_x, start_x);
+                }
+        }
+
+        while (true) {
+                if (queue_size == 0) {
+                        if (!queue_overflowed) {
+                                break;
+                        }
+                        LOG_DEBUG(TAG, "Flood fill queue overflowed, "
+                                       "rescanning the grid for seeds.");
+                        queue_overflowed = false;
+                        for (int sy = 0; sy < rows; sy++) {
+                                for (int sx = 0; sx < cols; sx++) {
+                                        if (is_fillable(sx, sy) &&
+                                            has_uncovered_empty_neighbour(
+                                                board, sx, sy)) {
+                                                push_seed(sx, sy);
+                                        }
+                                }
+                        }
+                        continue;
+                }
+
+                int idx = queue[queue_head];
+                queue_head = (queue_head + 1) % capacity;
+                queue_size--;
+
+                int x = board->x_of(idx);
+                int y = board->y_of(idx);
+                // The same run can be seeded from both of its adjacent rows.
+                if (!is_fillable(x, y)) {
+                        continue;
+                }
+
+                int left = x;
+                int right = x;
+                while (left > 0 && is_fillable(left - 1, y)) {
+                        left--;
+                }
+                while (right < cols - 1 && is_fillable(right + 1, y)) {
+                        right++;
+                }
+                for (int i = left; i <= right; i++) {
+                        reveal(i, y);
+                }
+                expand_span(y, left, right);
+        }
+}
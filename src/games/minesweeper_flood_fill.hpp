@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "minesweeper_board.hpp"
+
+/**
+ * Capacity of the seed queue of the flood fill. The scanline fill only queues
+ * one seed per run of empty cells adjacent to an uncovered span, so this
+ * comfortably covers the grid sizes that fit on the display. If the queue
+ * ever overflows, the fill rescans the grid for the dropped seeds, so the
+ * result is correct regardless of the capacity.
+ */
+#define FLOOD_FILL_QUEUE_CAPACITY 64
+
+/**
+ * Uncovers the cell and, if it has no adjacent mines, its neighbours until
+ * the whole empty region is revealed. The indices of the newly uncovered
+ * cells are appended to `batch`, nothing is rendered.
+ *
+ * The queue can be limited to fewer than `FLOOD_FILL_QUEUE_CAPACITY` seeds,
+ * which lets the stress test exercise the rescan after an overflow.
+ */
+void flood_fill_from(MinesweeperBoard *board, int start_x, int start_y,
+                     int *total_uncovered, std::vector<uint16_t> *batch,
+                     int queue_capacity = FLOOD_FILL_QUEUE_CAPACITY);
@@ -0,0 +1,125 @@
+#include <stdlib.h>
+
+#include "minesweeper_generator.hpp"
+#include "minesweeper_solver.hpp"
+
+#include "../common/logging.hpp"
+
+#define TAG "minesweeper_generator"
+
+void place_bombs(MinesweeperBoard *board, int bomb_number,
+                 Point *caret_position, uint16_t *cell_indices)
+{
+        int rows = board->rows;
+        int cols = board->cols;
+
+        // Only the cells outside of the caret neighbourhood are candidates.
+        int candidates_num = 0;
+        for (int idx = 0; idx < board->size(); idx++) {
+                Point position = {.x = board->x_of(idx),
+                                  .y = board->y_of(idx)};
+                if (!is_adjacent(caret_position, &position)) {
+                        cell_indices[candidates_num++] = idx;
+                }
+        }
+        if (bomb_number > candidates_num) {
+                LOG_INFO(TAG, "Cannot place %d bombs, only %d cells available",
+                         bomb_number, candidates_num);
+                bomb_number = candidates_num;
+        }
+
+        // Partial Fisher-Yates shuffle: after the i-th step, the first i
+        // entries are a uniformly random selection of the candidates, so we
+        // need exactly one random draw per bomb.
+        for (int i = 0; i < bomb_number; i++) {
+                int j = i + rand() % (candidates_num - i);
+                uint16_t selected = cell_indices[j];
+                cell_indices[j] = cell_indices[i];
+                cell_indices[i] = selected;
+                board->set_bomb(selected, true);
+        }
+
+        // Adjacent bomb counts are computed in a single pass over the grid.
+        for (int y = 0; y < rows; y++) {
+                for (int x = 0; x < cols; x++) {
+                        int idx = board->index(x, y);
+                        if (board->is_bomb(idx)) {
+                                board->set_adjacent_bombs(idx, 0);
+                                continue;
+                        }
+                        int count = 0;
+                        for (int ny = y - 1; ny <= y + 1; ny++) {
+                                for (int nx = x - 1; nx <= x + 1; nx++) {
+                                        if (board->contains(nx, ny) &&
+                                            board->is_bomb(nx, ny)) {
+                                                count++;
+                                        }
+                                }
+                        }
+                        board->set_adjacent_bombs(idx, count);
+                }
+        }
+}
+
+/**
+ * Simulates a player that only makes logical deductions, starting from the
+ * first click. Returns true if all safe cells end up uncovered.
+ */
+static bool is_solvable_without_guessing(MinesweeperBoard *board,
+                                         MinesweeperSolver *solver,
+                                         int mines_num, int first_click_idx)
+{
+        solver->reset();
+        board->set_uncovered(first_click_idx, true);
+        solver->cell_uncovered(first_click_idx);
+        solver->propagate();
+
+        int uncovered = 0;
+        for (int i = 0; i < board->size(); i++) {
+                if (board->is_uncovered(i)) {
+                        uncovered++;
+                        board->set_uncovered(i, false);
+                }
+        }
+        return uncovered == board->size() - mines_num;
+}
+
+MinesweeperGenerationReport
+generate_solvable_board(MinesweeperBoard *board, int mines_num,
+                        Point *first_click, DelayProvider *clock,
+                        unsigned long time_budget_ms)
+{
+        unsigned long start_time = clock->get_time_ms();
+        MinesweeperSolver solver(board, true);
+        uint16_t *cell_indices = new uint16_t[board->size()];
+        int first_click_idx = board->index(first_click->x, first_click->y);
+
+        MinesweeperGenerationReport report = {
+            .solvable = false, .attempts = 0, .duration_ms = 0};
+
+        while (true) {
+                // The flags placed before the first move are part of the
+                // game state, only the previous attempt is removed.
+                board->clear_bombs();
+                place_bombs(board, mines_num, first_click, cell_indices);
+                report.attempts++;
+
+                if (is_solvable_without_guessing(board, &solver, mines_num,
+                                                 first_click_idx)) {
+                        report.solvable = true;
+                        break;
+                }
+                if (clock->get_time_ms() - start_time >= time_budget_ms) {
+                        break;
+                }
+        }
+
+        delete[] cell_indices;
+        report.duration_ms = clock->get_time_ms() - start_time;
+        LOG_INFO(TAG,
+                 "Generated %s board with %d mines in %lu ms after %d "
+                 "attempts",
+                 report.solvable ? "solvable" : "unverified", mines_num,
+                 report.duration_ms, report.attempts);
+        return report;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+
+#include "../common/platform/interface/delay.hpp"
+#include "../common/point.hpp"
+#include "minesweeper_board.hpp"
+
+/**
+ * Time budget for finding a board that can be solved without guessing. If no
+ * such board is found within the budget, the last generated board is used.
+ */
+#define MINESWEEPER_GENERATION_BUDGET_MS 1000
+
+/**
+ * Summary of a single board generation, used for reporting the latency of
+ * the generator.
+ */
+typedef struct MinesweeperGenerationReport {
+        /**
+         * Set if the final board can be solved from the first click without
+         * guessing.
+         */
+        bool solvable;
+        /**
+         * Number of mine layouts that were tried.
+         */
+        int attempts;
+        unsigned long duration_ms;
+} MinesweeperGenerationReport;
+
+/**
+ * Places `bomb_number` bombs randomly on the board, leaving the caret position
+ * and its neighbours free of bombs. The adjacent bomb counts of all cells are
+ * updated accordingly.
+ *
+ * The bomb positions are drawn using a partial Fisher-Yates shuffle of the
+ * candidate cells, so the placement takes the same time regardless of how
+ * dense the board is. `cell_indices` is a scratch buffer for the shuffle, it
+ * needs to have room for `board->size()` entries.
+ */
+void place_bombs(MinesweeperBoard *board, int bomb_number,
+                 Point *caret_position, uint16_t *cell_indices);
+
+/**
+ * Generates a mine layout that can be solved without guessing after the
+ * player uncovers the `first_click` cell. Layouts are placed randomly and
+ * checked by simulating the player with the constraint propagation solver,
+ * unsolvable ones are regenerated until the time budget runs out.
+ *
+ * The board is left with all cells covered. The flags placed by the player
+ * before the first move are kept.
+ */
+MinesweeperGenerationReport
+generate_solvable_board(MinesweeperBoard *board, int mines_num,
+                        Point *first_click, DelayProvider *clock,
+                        unsigned long time_budget_ms);
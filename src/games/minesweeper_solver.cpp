@@ -0,0 +1,280 @@
+#include "minesweeper_solver.hpp"
+
+#include <cstring>
+
+/**
+ * A cell has at most 8 neighbours, so this bounds the size of each constraint.
+ */
+#define MAX_NEIGHBOURS 8
+
+/**
+ * The subset rule compares constraints of cells that share at least one
+ * neighbour, i.e. cells that are at most two rows/columns apart.
+ */
+#define SUBSET_RULE_RADIUS 2
+
+MinesweeperSolver::MinesweeperSolver(MinesweeperBoard *board,
+                                     bool reveal_safe_cells)
+    : board(board), reveal_safe_cells(reveal_safe_cells),
+      bitset_size((board->size() + 7) / 8),
+      known_mines(new uint8_t[bitset_size]),
+      known_safe(new uint8_t[bitset_size]), scheduled(new uint8_t[bitset_size]),
+      worklist(new uint16_t[board->size()]),
+      deduced_mines(new uint16_t[board->size()])
+{
+        reset();
+}
+
+MinesweeperSolver::~MinesweeperSolver()
+{
+        delete[] known_mines;
+        delete[] known_safe;
+        delete[] scheduled;
+        delete[] worklist;
+        delete[] deduced_mines;
+}
+
+void MinesweeperSolver::reset()
+{
+        memset(known_mines, 0, bitset_size);
+        memset(known_safe, 0, bitset_size);
+        memset(scheduled, 0, bitset_size);
+        worklist_head = 0;
+        worklist_size = 0;
+        deduced_mines_head = 0;
+        deduced_mines_size = 0;
+        deductions = 0;
+}
+
+void MinesweeperSolver::cell_uncovered(int idx)
+{
+        set_bit(known_safe, idx);
+        schedule(idx);
+        schedule_uncovered_neighbours(idx);
+}
+
+int MinesweeperSolver::propagate()
+{
+        int deductions_before = deductions;
+        while (worklist_size > 0) {
+                int idx = worklist[worklist_head];
+                worklist_head = (worklist_head + 1) % board->size();
+                worklist_size--;
+                clear_bit(scheduled, idx);
+                evaluate(idx);
+        }
+        return deductions - deductions_before;
+}
+
+int MinesweeperSolver::find_safe_cell()
+{
+        for (int i = 0; i < bitset_size; i++) {
+                if (known_safe[i] == 0) {
+                        continue;
+                }
+                for (int idx = i * 8; idx < (i + 1) * 8 && idx < board->size();
+                     idx++) {
+                        if (is_known_safe(idx) && !board->is_uncovered(idx)) {
+                                return idx;
+                        }
+                }
+        }
+        return -1;
+}
+
+int MinesweeperSolver::next_deduced_mine()
+{
+        if (deduced_mines_head == deduced_mines_size) {
+                return -1;
+        }
+        return deduced_mines[deduced_mines_head++];
+}
+
+void MinesweeperSolver::evaluate(int idx)
+{
+        if (!is_constraint(idx)) {
+                return;
+        }
+
+        uint16_t unknown[MAX_NEIGHBOURS];
+        int remaining_mines;
+        int unknown_num =
+            collect_unknown_neighbours(idx, unknown, &remaining_mines);
+        if (unknown_num == 0) {
+                return;
+        }
+
+        if (remaining_mines == 0) {
+                for (int i = 0; i < unknown_num; i++) {
+                        mark_safe(unknown[i]);
+                }
+                return;
+        }
+        if (remaining_mines == unknown_num) {
+                for (int i = 0; i < unknown_num; i++) {
+                        mark_mine(unknown[i]);
+                }
+                return;
+        }
+        apply_subset_rule(idx);
+}
+
+/**
+ * Checks if the constraint of the cell is a subset of the constraint of any
+ * nearby cell (or the other way around). In that case, the difference of the
+ * two remaining mine counts applies to the cells that are present only in the
+ * larger constraint, which can allow us to deduce that all of them are safe or
+ * all of them are mines.
+ */
+void MinesweeperSolver::apply_subset_rule(int idx)
+{
+        uint16_t a[MAX_NEIGHBOURS];
+        int a_remaining;
+        int a_num = collect_unknown_neighbours(idx, a, &a_remaining);
+
+        int x = board->x_of(idx);
+        int y = board->y_of(idx);
+        for (int ny = y - SUBSET_RULE_RADIUS; ny <= y + SUBSET_RULE_RADIUS;
+             ny++) {
+                for (int nx = x - SUBSET_RULE_RADIUS;
+                     nx <= x + SUBSET_RULE_RADIUS; nx++) {
+                        if (!board->contains(nx, ny) || (nx == x && ny == y)) {
+                                continue;
+                        }
+                        int other = board->index(nx, ny);
+                        if (!is_constraint(other)) {
+                                continue;
+                        }
+
+                        uint16_t b[MAX_NEIGHBOURS];
+                        int b_remaining;
+                        int b_num =
+                            collect_unknown_neighbours(other, b, &b_remaining);
+                        if (b_num == 0 || b_num == a_num) {
+                                continue;
+                        }
+
+                        // We always check if the smaller constraint is a
+                        // subset of the larger one.
+                        uint16_t *small = a_num < b_num ? a : b;
+                        uint16_t *large = a_num < b_num ? b : a;
+                        int small_num = a_num < b_num ? a_num : b_num;
+                        int large_num = a_num < b_num ? b_num : a_num;
+                        int remaining_diff = a_num < b_num
+                                                 ? b_remaining - a_remaining
+                                                 : a_remaining - b_remaining;
+
+                        // Both lists are sorted in the row-major order, so we
+                        // can find the difference by merging them.
+                        uint16_t difference[MAX_NEIGHBOURS];
+                        int difference_num = 0;
+                        int i = 0;
+                        for (int j = 0; j < large_num; j++) {
+                                if (i < small_num && small[i] == large[j]) {
+                                        i++;
+                                } else {
+                                        difference[difference_num++] = large[j];
+                                }
+                        }
+                        if (i < small_num) {
+                                // Not a subset.
+                                continue;
+                        }
+
+                        if (remaining_diff == 0) {
+                                for (int k = 0; k < difference_num; k++) {
+                                        mark_safe(difference[k]);
+                                }
+                                return;
+                        }
+                        if (remaining_diff == difference_num) {
+                                for (int k = 0; k < difference_num; k++) {
+                                        mark_mine(difference[k]);
+                                }
+                                return;
+                        }
+                }
+        }
+}
+
+/**
+ * Collects the neighbours of the cell whose state isn't known yet (in the
+ * row-major order) and computes how many of them have to be mines.
+ */
+int MinesweeperSolver::collect_unknown_neighbours(int idx, uint16_t *unknown,
+                                                  int *remaining_mines)
+{
+        int x = board->x_of(idx);
+        int y = board->y_of(idx);
+        int unknown_num = 0;
+        *remaining_mines = board->adjacent_bombs(idx);
+        for (int ny = y - 1; ny <= y + 1; ny++) {
+                for (int nx = x - 1; nx <= x + 1; nx++) {
+                        if (!board->contains(nx, ny) || (nx == x && ny == y)) {
+                                continue;
+                        }
+                        int nb = board->index(nx, ny);
+                        if (is_known_mine(nb)) {
+                                (*remaining_mines)--;
+                        } else if (!is_known_safe(nb)) {
+                                unknown[unknown_num++] = nb;
+                        }
+                }
+        }
+        return unknown_num;
+}
+
+bool MinesweeperSolver::is_constraint(int idx)
+{
+        return board->is_uncovered(idx) && !board->is_bomb(idx);
+}
+
+void MinesweeperSolver::mark_safe(int idx)
+{
+        if (is_known_safe(idx)) {
+                return;
+        }
+        deductions++;
+        if (reveal_safe_cells) {
+                board->set_uncovered(idx, true);
+                cell_uncovered(idx);
+                return;
+        }
+        set_bit(known_safe, idx);
+        schedule_uncovered_neighbours(idx);
+}
+
+void MinesweeperSolver::mark_mine(int idx)
+{
+        if (is_known_mine(idx)) {
+                return;
+        }
+        deductions++;
+        set_bit(known_mines, idx);
+        deduced_mines[deduced_mines_size++] = idx;
+        schedule_uncovered_neighbours(idx);
+}
+
+void MinesweeperSolver::schedule(int idx)
+{
+        if (!is_constraint(idx) || get_bit(scheduled, idx)) {
+                return;
+        }
+        set_bit(scheduled, idx);
+        int tail = (worklist_head + worklist_size) % board->size();
+        worklist[tail] = idx;
+        worklist_size++;
+}
+
+void MinesweeperSolver::schedule_uncovered_neighbours(int idx)
+{
+        int x = board->x_of(idx);
+        int y = board->y_of(idx);
+        for (int ny = y - 1; ny <= y + 1; ny++) {
+                for (int nx = x - 1; nx <= x + 1; nx++) {
+                        if (board->contains(nx, ny) && !(nx == x && ny == y)) {
+                                schedule(board->index(nx, ny));
+                        }
+                }
+        }
+}
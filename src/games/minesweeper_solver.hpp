@@ -0,0 +1,130 @@
+#pragma once
+#include <cstdint>
+
+#include "minesweeper_board.hpp"
+
+/**
+ * Constraint propagation solver for Minesweeper boards.
+ *
+ * The solver only uses the information that is available to the player: the
+ * adjacent bomb counts of uncovered cells. Each uncovered cell constrains its
+ * covered neighbours, and the solver repeatedly applies two rules:
+ *
+ * - if the number of remaining mines around a cell is zero, all its unknown
+ *   neighbours are safe; if it is equal to the number of unknown neighbours,
+ *   all of them are mines,
+ * - if the unknown neighbours of one cell are a subset of the unknown
+ *   neighbours of another cell, the difference of their remaining mine counts
+ *   applies to the cells that aren't shared (subset rule).
+ *
+ * The work is driven by a worklist of uncovered cells whose constraints have
+ * changed, so after the initial propagation, each move only reprocesses the
+ * part of the frontier that it touched.
+ *
+ * Flags placed by the user are ignored, as they could be wrong. Instead, the
+ * solver keeps its own record of the deduced mines and safe cells.
+ */
+class MinesweeperSolver
+{
+      public:
+        /**
+         * If `reveal_safe_cells` is set, the solver uncovers all cells that
+         * it deduces to be safe on the board. This is used for simulating the
+         * player when checking if a board can be solved without guessing.
+         */
+        MinesweeperSolver(MinesweeperBoard *board, bool reveal_safe_cells);
+        ~MinesweeperSolver();
+
+        MinesweeperSolver(const MinesweeperSolver &) = delete;
+        MinesweeperSolver &operator=(const MinesweeperSolver &) = delete;
+
+        /**
+         * Forgets all deductions, this needs to be called when the layout of
+         * the mines on the board changes.
+         */
+        void reset();
+
+        /**
+         * Notifies the solver that the cell has been uncovered. The cell and
+         * its uncovered neighbours are scheduled for re-evaluation.
+         */
+        void cell_uncovered(int idx);
+
+        /**
+         * Applies the rules to all scheduled cells until no further
+         * deductions can be made. Returns the number of new deductions.
+         */
+        int propagate();
+
+        bool is_known_mine(int idx) { return get_bit(known_mines, idx); }
+        bool is_known_safe(int idx) { return get_bit(known_safe, idx); }
+
+        /**
+         * Returns the index of a covered cell that is known to be safe, or -1
+         * if there is no such cell.
+         */
+        int find_safe_cell();
+
+        /**
+         * Returns the index of the next mine deduced since the last call, or
+         * -1 if no new mines have been deduced. This allows for flagging the
+         * deduced mines without scanning the whole board.
+         */
+        int next_deduced_mine();
+
+        /**
+         * Total number of mines and safe cells deduced since the last reset.
+         */
+        int get_deductions_count() { return deductions; }
+
+      private:
+        void evaluate(int idx);
+        void apply_subset_rule(int idx);
+        int collect_unknown_neighbours(int idx, uint16_t *unknown,
+                                       int *remaining_mines);
+        bool is_constraint(int idx);
+        void mark_safe(int idx);
+        void mark_mine(int idx);
+        void schedule(int idx);
+        void schedule_uncovered_neighbours(int idx);
+
+        bool get_bit(uint8_t *bitset, int idx)
+        {
+                return bitset[idx / 8] & (1 << (idx % 8));
+        }
+        void set_bit(uint8_t *bitset, int idx)
+        {
+                bitset[idx / 8] |= 1 << (idx % 8);
+        }
+        void clear_bit(uint8_t *bitset, int idx)
+        {
+                bitset[idx / 8] &= ~(1 << (idx % 8));
+        }
+
+        MinesweeperBoard *board;
+        bool reveal_safe_cells;
+        int bitset_size;
+        uint8_t *known_mines;
+        uint8_t *known_safe;
+        /**
+         * Cells that are currently present in the worklist.
+         */
+        uint8_t *scheduled;
+        /**
+         * Circular worklist of cells whose constraints need to be evaluated.
+         * Each cell is present at most once, so it never holds more than the
+         * number of cells on the board.
+         */
+        uint16_t *worklist;
+        int worklist_head;
+        int worklist_size;
+        /**
+         * Mines deduced since the last call to `next_deduced_mine`. Each mine
+         * is deduced only once, so it can't hold more than the number of
+         * cells on the board.
+         */
+        uint16_t *deduced_mines;
+        int deduced_mines_head;
+        int deduced_mines_size;
+        int deductions;
+};
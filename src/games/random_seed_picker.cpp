@@ -18,10 +18,10 @@
  * Assembles the generic configuration struct that can be used to collect user
  * input specifying the game of life configuration.
  */
-Configuration *assemble_game_of_life_configuration(PersistentStorage *storage);
+Configuration *assemble_game_of_life_configuration(SettingsCache *settings);
 
 RandomSeedPickerConfiguration *
-load_initial_seed_picker_config(PersistentStorage *storage)
+load_initial_seed_picker_config(SettingsCache *settings)
 {
         /*
               int storage_offset =
@@ -104,7 +104,7 @@ void collect_random_seed_picker_configuration(
     GameCustomization *customization)
 {
         Configuration *config =
-            assemble_random_seed_picker_configuration(p->persistent_storage);
+            assemble_random_seed_picker_configuration(p->settings_cache);
         enter_configuration_collection_loop(p, config,
                                             customization->accent_color);
         extract_game_config(game_config, config);
@@ -112,10 +112,10 @@ void collect_random_seed_picker_configuration(
 }
 
 Configuration *
-assemble_random_seed_picker_configuration(PersistentStorage *storage)
+assemble_random_seed_picker_configuration(SettingsCache *settings)
 {
         GameOfLifeConfiguration *initial_config =
-            load_initial_game_of_life_config(storage);
+            load_initial_game_of_life_config(settings);
 
         Configuration *config = new Configuration();
         config->name = "Random Seed Picker";
@@ -5,6 +5,9 @@
 #include "settings.hpp"
 #include "game_of_life.hpp"
 #include "minesweeper.hpp"
+#include "random_seed_picker.hpp"
+#include "snake.hpp"
+#include "sudoku.hpp"
 
 #define TAG "settings"
 
@@ -23,14 +26,14 @@ void Settings::game_loop(Platform *p, UserInterfaceCustomization *custom)
                 Game selected_game;
                 extract_menu_setting(&selected_game, config);
 
-                std::vector<int> offsets = get_settings_storage_offsets();
-                int offset = offsets[selected_game];
-                LOG_DEBUG(
-                    TAG,
-                    "Computed configuration storage offset for game %s: %d",
-                    game_to_string(selected_game), offset);
+                LOG_DEBUG(TAG, "Modifying the configuration of %s.",
+                          game_to_string(selected_game));
 
-                PersistentStorage storage = *(p->persistent_storage);
+                // The cache only writes the changed configurations into the
+                // storage once the settings menu is left, see `select_game`.
+                SettingsCache *settings = p->settings_cache;
+                // If the user requests the help screen, the config isn't
+                // collected and we must not overwrite the stored one with it.
 
                 switch (selected_game) {
                 case MainMenu: {
@@ -39,7 +42,9 @@ void Settings::game_loop(Platform *p, UserInterfaceCustomization *custom)
                         if (action && action.value() == UserAction::Exit) {
                                 return;
                         }
-                        storage.put(offset, config);
+                        if (!action) {
+                                settings->put(selected_game, &config);
+                        }
                 } break;
                 case Clean2048: {
                         Game2048Configuration config;
@@ -47,7 +52,9 @@ void Settings::game_loop(Platform *p, UserInterfaceCustomization *custom)
                         if (action && action.value() == UserAction::Exit) {
                                 return;
                         }
-                        storage.put(offset, config);
+                        if (!action) {
+                                settings->put(selected_game, &config);
+                        }
                 } break;
                 case Minesweeper: {
                         MinesweeperConfiguration config;
@@ -56,7 +63,9 @@ void Settings::game_loop(Platform *p, UserInterfaceCustomization *custom)
                         if (action && action.value() == UserAction::Exit) {
                                 return;
                         }
-                        storage.put(offset, config);
+                        if (!action) {
+                                settings->put(selected_game, &config);
+                        }
                 } break;
                 case GameOfLife: {
                         GameOfLifeConfiguration config;
@@ -65,7 +74,29 @@ void Settings::game_loop(Platform *p, UserInterfaceCustomization *custom)
                         if (action && action.value() == UserAction::Exit) {
                                 return;
                         }
-                        storage.put(offset, config);
+                        if (!action) {
+                                settings->put(selected_game, &config);
+                        }
+                } break;
+                case Snake: {
+                        SnakeConfiguration config;
+                        auto action = collect_snake_config(p, &config, custom);
+                        if (action && action.value() == UserAction::Exit) {
+                                return;
+                        }
+                        if (!action) {
+                                settings->put(selected_game, &config);
+                        }
+                } break;
+                case Sudoku: {
+                        SudokuConfiguration config;
+                        auto action = collect_sudoku_config(p, &config, custom);
+                        if (action && action.value() == UserAction::Exit) {
+                                return;
+                        }
+                        if (!action) {
+                                settings->put(selected_game, &config);
+                        }
                 } break;
                 default:
                         return;
@@ -74,25 +105,18 @@ void Settings::game_loop(Platform *p, UserInterfaceCustomization *custom)
         }
 }
 
-std::vector<int> get_settings_storage_offsets()
+uint8_t settings_record_key(Game game)
 {
-        std::vector<int> offsets(7);
-        offsets[MainMenu] = 0;
-        offsets[Clean2048] = offsets[MainMenu] + sizeof(GameMenuConfiguration);
-        offsets[Minesweeper] =
-            offsets[Clean2048] + sizeof(Game2048Configuration);
-        offsets[GameOfLife] =
-            offsets[Minesweeper] + sizeof(MinesweeperConfiguration);
-        offsets[RandomSeedPicker] =
-            offsets[GameOfLife] + sizeof(GameOfLifeConfiguration);
-        return offsets;
+        return RECORD_KEY_SETTINGS_BASE + game;
 }
+
 Configuration *assemble_settings_menu_configuration()
 {
 
         auto available_games = {
             game_to_string(Game::MainMenu), game_to_string(Game::Minesweeper),
-            game_to_string(Game::Clean2048), game_to_string(Game::GameOfLife)};
+            game_to_string(Game::Clean2048), game_to_string(Game::GameOfLife),
+            game_to_string(Game::Snake), game_to_string(Game::Sudoku)};
 
         auto *menu = ConfigurationOption::of_strings(
             "Modify", available_games, game_to_string(Game::MainMenu));
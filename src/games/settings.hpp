@@ -1,7 +1,22 @@
 #pragma once
 #include "game_executor.hpp"
 #include "common_transitions.hpp"
-std::vector<int> get_settings_storage_offsets();
+#include "game_menu.hpp"
+#include "../common/record_store.hpp"
+#include "settings_cache.hpp"
+
+/**
+ * Version of the layout of the configuration structs stored in the record
+ * store. It needs to be bumped whenever any of them changes, the records
+ * with the old layout are then replaced with the default configuration.
+ */
+#define SETTINGS_RECORD_VERSION 1
+
+/**
+ * Returns the key of the record holding the default configuration of the
+ * given game.
+ */
+uint8_t settings_record_key(Game game);
 
 /**
  * This 'game' is a settings menu responsible for setting the default values of
@@ -0,0 +1,81 @@
+#include <string.h>
+
+#include "../common/logging.hpp"
+#include "settings.hpp"
+#include "settings_cache.hpp"
+
+#define TAG "settings_cache"
+
+SettingsCache::SettingsCache(RecordStore *store) : store(store), entries{} {}
+
+void SettingsCache::load()
+{
+        int loaded = 0;
+        for (int game = 0; game < SETTINGS_CACHE_GAMES; game++) {
+                SettingsCacheEntry *entry = &entries[game];
+                int length = store->read(settings_record_key((Game)game),
+                                         entry->data, SETTINGS_CACHE_ENTRY_SIZE,
+                                         SETTINGS_RECORD_VERSION);
+                entry->valid = length >= 0;
+                entry->dirty = false;
+                entry->length = entry->valid ? length : 0;
+                loaded += entry->valid;
+        }
+        LOG_DEBUG(TAG, "Loaded %d game configurations.", loaded);
+}
+
+void SettingsCache::flush()
+{
+        for (int game = 0; game < SETTINGS_CACHE_GAMES; game++) {
+                SettingsCacheEntry *entry = &entries[game];
+                if (!entry->dirty) {
+                        continue;
+                }
+                LOG_DEBUG(TAG, "Writing the configuration of %s.",
+                          game_to_string((Game)game));
+                // A failed write is retried by the next flush, the cached
+                // configuration is still used until then.
+                if (store->write(settings_record_key((Game)game), entry->data,
+                                 entry->length, SETTINGS_RECORD_VERSION)) {
+                        entry->dirty = false;
+                }
+        }
+}
+
+SettingsCacheEntry *SettingsCache::entry_of(Game game)
+{
+        if (game < 0 || game >= SETTINGS_CACHE_GAMES) {
+                LOG_ERROR(TAG, "No cache entry for game %d.", game);
+                return NULL;
+        }
+        return &entries[game];
+}
+
+bool SettingsCache::get(Game game, void *data, int length)
+{
+        SettingsCacheEntry *entry = entry_of(game);
+        if (!entry || !entry->valid || entry->length != length) {
+                return false;
+        }
+        memcpy(data, entry->data, length);
+        return true;
+}
+
+bool SettingsCache::put(Game game, const void *data, int length)
+{
+        SettingsCacheEntry *entry = entry_of(game);
+        if (!entry || length > SETTINGS_CACHE_ENTRY_SIZE) {
+                LOG_ERROR(TAG, "Configuration of %d bytes can't be cached.",
+                          length);
+                return false;
+        }
+        if (entry->valid && entry->length == length &&
+            memcmp(entry->data, data, length) == 0) {
+                return true;
+        }
+        memcpy(entry->data, data, length);
+        entry->valid = true;
+        entry->dirty = true;
+        entry->length = length;
+        return true;
+}
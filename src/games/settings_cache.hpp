@@ -0,0 +1,86 @@
+#pragma once
+#include <stdint.h>
+
+#include "../common/record_store.hpp"
+#include "game_menu.hpp"
+
+/**
+ * Number of games that can have their default configuration cached, it
+ * needs to be larger than the highest value of the `Game` enum.
+ */
+#define SETTINGS_CACHE_GAMES 16
+/**
+ * Maximum size of a cached configuration struct. All configuration structs
+ * of the games are currently at most 12 bytes large.
+ */
+#define SETTINGS_CACHE_ENTRY_SIZE 16
+
+typedef struct SettingsCacheEntry {
+        /**
+         * Set if `data` holds a configuration, either loaded from the record
+         * store or put into the cache since.
+         */
+        bool valid;
+        /**
+         * Set if the configuration was changed and needs to be written into
+         * the record store by the next `flush`.
+         */
+        bool dirty;
+        uint8_t length;
+        uint8_t data[SETTINGS_CACHE_ENTRY_SIZE];
+} SettingsCacheEntry;
+
+/**
+ * Write-back cache of the default configurations of all games.
+ *
+ * The configurations are read from the record store once on startup, the
+ * games then only copy them from RAM when assembling their configuration
+ * screens. Changed configurations (including the defaults put into the cache
+ * if no configuration was stored yet) are only marked as dirty and written
+ * into the record store together by `flush`, which is called once the user
+ * leaves the settings menu or a game.
+ */
+class SettingsCache
+{
+      public:
+        SettingsCache(RecordStore *store);
+
+        SettingsCache(const SettingsCache &) = delete;
+        SettingsCache &operator=(const SettingsCache &) = delete;
+
+        /**
+         * Loads the configurations of all games from the record store, it
+         * needs to be called after the store is mounted.
+         */
+        void load();
+        /**
+         * Writes all dirty configurations into the record store.
+         */
+        void flush();
+
+        /**
+         * Copies the cached configuration of the game into `t`. Returns false
+         * if there is no configuration of the size of `T`.
+         */
+        template <typename T> bool get(Game game, T *t)
+        {
+                return get(game, t, sizeof(T));
+        }
+        /**
+         * Replaces the cached configuration of the game, it is written into
+         * the record store by the next `flush` if it differs from the current
+         * one.
+         */
+        template <typename T> bool put(Game game, const T *t)
+        {
+                return put(game, t, sizeof(T));
+        }
+
+      private:
+        bool get(Game game, void *data, int length);
+        bool put(Game game, const void *data, int length);
+        SettingsCacheEntry *entry_of(Game game);
+
+        RecordStore *store;
+        SettingsCacheEntry entries[SETTINGS_CACHE_GAMES];
+};
@@ -0,0 +1,536 @@
+#include <cstdint>
+#include <cstring>
+#include <stdio.h>
+
+#include "../common/configuration.hpp"
+#include "../common/constants.hpp"
+#include "../common/grid_game.hpp"
+#include "../common/logging.hpp"
+#include "game_menu.hpp"
+#include "settings.hpp"
+#include "snake.hpp"
+#include "snake_body.hpp"
+
+#define TAG "snake"
+
+#define SNAKE_CELL_WIDTH 10
+#define SNAKE_INITIAL_LENGTH 3
+
+/**
+ * The game loop polls for input much more frequently than the snake moves so
+ * that turns are registered no matter when the user moves the joystick
+ * within a tick.
+ */
+#define SNAKE_INPUT_POLLING_DELAY 5
+
+/**
+ * Rendering a tick is allowed to take at most 1/SNAKE_RENDER_BUDGET_FACTOR of
+ * the tick period, the rest is left for polling input. If the display can't
+ * keep up with the configured speed (e.g. on the LCD), the ticks are slowed
+ * down instead of being rendered back to back without registering any turns
+ * in between.
+ */
+#define SNAKE_RENDER_BUDGET_FACTOR 2
+
+/**
+ * Smoothing factor of the moving average of the render time. It keeps a
+ * single slow frame from noticeably slowing down the game.
+ */
+#define RENDER_TIME_SMOOTHING 0.2f
+
+#ifdef EMULATOR
+#define EXPLANATION_ABOVE_GRID_OFFEST 4
+#else
+#define EXPLANATION_ABOVE_GRID_OFFEST 0
+#endif
+
+SnakeConfiguration DEFAULT_SNAKE_CONFIG = {.speed = 6, .wrap_around = false};
+
+/**
+ * Input-to-pixel latency of the turns taken during the game, measured from
+ * the moment the turn was polled until the new head of the snake has been
+ * sent to the display. This allows for using the game as a latency benchmark
+ * on the real console.
+ */
+typedef struct TurnLatencyStats {
+        int samples;
+        unsigned long total_ms;
+        unsigned long max_ms;
+} TurnLatencyStats;
+
+typedef enum StepOutcome {
+        MOVED = 0,
+        ATE_FOOD = 1,
+        CRASHED = 2,
+} StepOutcome;
+
+static Configuration *
+assemble_snake_configuration(SettingsCache *settings);
+static void extract_game_config(SnakeConfiguration *game_config,
+                                Configuration *config);
+
+static void draw_game_canvas(Platform *p, CellGridDimensions *dimensions,
+                             UserInterfaceCustomization *customization);
+static void draw_score(Display *display, CellGridDimensions *dimensions,
+                       int score);
+static void draw_snake_cell(Display *display, CellGridDimensions *dimensions,
+                            int cell, Color color);
+
+/**
+ * Moves the snake one cell in the given direction. The cell of the new head is
+ * returned in `new_head` and, unless the snake grew by eating the food, the
+ * cell freed by the tail in `freed_tail`.
+ */
+static StepOutcome take_step(SnakeBody *body, CellGridDimensions *dimensions,
+                             Direction heading, bool wrap_around, int food,
+                             int *new_head, int *freed_tail);
+/**
+ * Places the food on a random free cell. Returns -1 if the snake fills the
+ * whole grid.
+ */
+static int spawn_food(SnakeBody *body, int total_cells);
+
+UserAction snake_loop(Platform *platform,
+                      UserInterfaceCustomization *customization);
+
+void Snake::game_loop(Platform *p, UserInterfaceCustomization *customization)
+{
+        const char *help_text =
+            "Use the joystick to steer the snake. Eat the food to grow, but "
+            "don't crash into the walls or your own tail. Press yellow to "
+            "pause and blue to exit.";
+
+        bool exit_requested = false;
+        while (!exit_requested) {
+                switch (snake_loop(p, customization)) {
+                case UserAction::PlayAgain: {
+                        LOG_DEBUG(TAG, "Snake game loop finished. "
+                                       "Pausing for input ");
+                        Direction dir;
+                        Action act = Action::YELLOW;
+                        pause_until_input(p->directional_controllers,
+                                          p->action_controllers, &dir, &act,
+                                          p->delay_provider, p->display);
+
+                        if (act == Action::BLUE) {
+                                exit_requested = true;
+                        }
+                } break;
+                case UserAction::Exit:
+                        exit_requested = true;
+                        break;
+                case UserAction::ShowHelp:
+                        LOG_DEBUG(TAG, "User requested snake help screen");
+                        render_wrapped_help_text(p, customization, help_text);
+                        wait_until_green_pressed(p);
+                        break;
+                }
+        }
+}
+
+UserAction snake_loop(Platform *p, UserInterfaceCustomization *customization)
+{
+        LOG_DEBUG(TAG, "Entering Snake game loop");
+        SnakeConfiguration config;
+
+        auto maybe_interrupt = collect_snake_config(p, &config, customization);
+        if (maybe_interrupt) {
+                return maybe_interrupt.value();
+        }
+
+        CellGridDimensions *gd = calculate_cell_grid_dimensions(
+            p->display->get_width(), p->display->get_height(),
+            p->display->get_display_corner_radius(), SNAKE_CELL_WIDTH,
+            SNAKE_CELL_WIDTH);
+        int cols = gd->cols;
+        int total_cells = gd->rows * gd->cols;
+
+        draw_game_canvas(p, gd, customization);
+        LOG_DEBUG(TAG, "Snake game canvas drawn.");
+
+        Color snake_color = customization->accent_color;
+        Color food_color = snake_color == White ? Red : White;
+
+        // The snake starts in the middle of the grid heading right.
+        SnakeBody body(total_cells);
+        int start = (gd->rows / 2) * cols + cols / 2 - SNAKE_INITIAL_LENGTH;
+        for (int i = 0; i < SNAKE_INITIAL_LENGTH; i++) {
+                body.push_head(start + i);
+                draw_snake_cell(p->display, gd, start + i, snake_color);
+        }
+        Direction heading = RIGHT;
+
+        int food = spawn_food(&body, total_cells);
+        draw_snake_cell(p->display, gd, food, food_color);
+        int score = 0;
+        draw_score(p->display, gd, score);
+        p->display->refresh();
+
+        int configured_period = 1000 / config.speed;
+        int tick_period = configured_period;
+        float render_time = 0;
+
+        // Only a single turn is applied per tick, this prevents two quick
+        // turns from folding the snake back onto itself.
+        bool turn_pending = false;
+        Direction pending_heading = heading;
+        unsigned long turn_time = 0;
+        TurnLatencyStats latency = {.samples = 0, .total_ms = 0, .max_ms = 0};
+
+        bool paused = false;
+        bool is_game_over = false;
+        bool is_game_won = false;
+        bool exit_requested = false;
+        unsigned long next_tick =
+            p->delay_provider->get_time_ms() + tick_period;
+        while (!is_game_over && !is_game_won && !exit_requested) {
+                Direction dir;
+                Action act;
+                if (!paused && !turn_pending &&
+                    directional_input_registered(p->directional_controllers,
+                                                 &dir)) {
+                        // Reversing the snake would make it crash into its
+                        // own body immediately, so such input is ignored.
+                        bool is_reverse = (dir + 2) % 4 == heading;
+                        if (dir != heading && !is_reverse) {
+                                pending_heading = dir;
+                                turn_pending = true;
+                                turn_time = p->delay_provider->get_time_ms();
+                                LOG_DEBUG(TAG, "Turn registered: %s",
+                                          direction_to_str(dir));
+                        }
+                }
+                if (action_input_registered(p->action_controllers, &act)) {
+                        if (act == Action::BLUE) {
+                                LOG_DEBUG(TAG, "User requested to exit game.");
+                                exit_requested = true;
+                        } else if (act == Action::YELLOW) {
+                                paused = !paused;
+                                LOG_DEBUG(TAG, "Game %s.",
+                                          paused ? "paused" : "resumed");
+                                next_tick = p->delay_provider->get_time_ms() +
+                                            tick_period;
+                        }
+                }
+
+                unsigned long now = p->delay_provider->get_time_ms();
+                if (paused || now < next_tick) {
+                        p->delay_provider->delay_ms(SNAKE_INPUT_POLLING_DELAY);
+                        continue;
+                }
+
+                if (turn_pending) {
+                        heading = pending_heading;
+                }
+
+                int new_head;
+                int freed_tail = -1;
+                StepOutcome outcome =
+                    take_step(&body, gd, heading, config.wrap_around, food,
+                              &new_head, &freed_tail);
+                if (outcome == CRASHED) {
+                        LOG_DEBUG(TAG, "The snake crashed.");
+                        is_game_over = true;
+                        break;
+                }
+
+                // Only the cells that changed are drawn: the new head, the
+                // cell freed by the tail, and the new food if it was eaten.
+                draw_snake_cell(p->display, gd, new_head, snake_color);
+                if (freed_tail != -1) {
+                        draw_snake_cell(p->display, gd, freed_tail, Black);
+                }
+                if (outcome == ATE_FOOD) {
+                        score++;
+                        draw_score(p->display, gd, score);
+                        food = spawn_food(&body, total_cells);
+                        if (food == -1) {
+                                is_game_won = true;
+                        } else {
+                                draw_snake_cell(p->display, gd, food,
+                                                food_color);
+                        }
+                }
+                p->display->refresh();
+
+                unsigned long rendered = p->delay_provider->get_time_ms();
+                if (turn_pending) {
+                        unsigned long turn_latency = rendered - turn_time;
+                        latency.samples++;
+                        latency.total_ms += turn_latency;
+                        if (turn_latency > latency.max_ms) {
+                                latency.max_ms = turn_latency;
+                        }
+                        turn_pending = false;
+                }
+
+                float sample = rendered - now;
+                render_time = (1 - RENDER_TIME_SMOOTHING) * render_time +
+                              RENDER_TIME_SMOOTHING * sample;
+                int required_period =
+                    (int)(render_time * SNAKE_RENDER_BUDGET_FACTOR);
+                int adapted_period = required_period > configured_period
+                                         ? required_period
+                                         : configured_period;
+                if (adapted_period != tick_period) {
+                        LOG_DEBUG(TAG,
+                                  "Tick period adapted to %d ms (average "
+                                  "render time %d ms).",
+                                  adapted_period, (int)render_time);
+                        tick_period = adapted_period;
+                }
+
+                next_tick += tick_period;
+                // If we fell behind, we don't try to catch up by moving the
+                // snake multiple times in a row.
+                if (next_tick < rendered) {
+                        next_tick = rendered;
+                }
+        }
+
+        if (latency.samples > 0) {
+                LOG_INFO(TAG,
+                         "Input-to-pixel latency over %d turns: average %lu "
+                         "ms, max %lu ms. Tick period: %d ms.",
+                         latency.samples, latency.total_ms / latency.samples,
+                         latency.max_ms, tick_period);
+        }
+
+        delete gd;
+        if (exit_requested) {
+                return UserAction::Exit;
+        }
+
+        pause_until_any_directional_input(p->directional_controllers,
+                                          p->delay_provider, p->display);
+        if (is_game_won) {
+                display_game_won(p->display, customization);
+        } else {
+                display_game_over(p->display, customization);
+        }
+        p->display->refresh();
+        return UserAction::PlayAgain;
+}
+
+StepOutcome take_step(SnakeBody *body, CellGridDimensions *dimensions,
+                      Direction heading, bool wrap_around, int food,
+                      int *new_head, int *freed_tail)
+{
+        int cols = dimensions->cols;
+        int rows = dimensions->rows;
+        Point head = {.x = body->head() % cols, .y = body->head() / cols};
+
+        if (wrap_around) {
+                translate_toroidal_array(&head, heading, rows, cols);
+        } else {
+                translate(&head, heading);
+                if (head.x < 0 || head.y < 0 || head.x >= cols ||
+                    head.y >= rows) {
+                        return CRASHED;
+                }
+        }
+        *new_head = head.y * cols + head.x;
+
+        bool ate_food = *new_head == food;
+        // The tail moves away in the same tick, so the snake is allowed to
+        // move into the cell that it is currently occupying.
+        if (!ate_food) {
+                *freed_tail = body->pop_tail();
+        }
+        if (body->occupies(*new_head)) {
+                return CRASHED;
+        }
+        body->push_head(*new_head);
+        return ate_food ? ATE_FOOD : MOVED;
+}
+
+int spawn_food(SnakeBody *body, int total_cells)
+{
+        if (body->length() == total_cells) {
+                return -1;
+        }
+        // If the random cell is taken, we take the next free one. This keeps
+        // the number of random draws constant as the snake grows.
+        int cell = rand() % total_cells;
+        while (body->occupies(cell)) {
+                cell = (cell + 1) % total_cells;
+        }
+        return cell;
+}
+
+void draw_snake_cell(Display *display, CellGridDimensions *dimensions,
+                     int cell, Color color)
+{
+        Point start = dimensions->cell_start(cell % dimensions->cols,
+                                             cell / dimensions->cols);
+        display->clear_region(start,
+                              {.x = start.x + dimensions->cell_width,
+                               .y = start.y + dimensions->cell_height},
+                              color);
+}
+
+std::optional<UserAction>
+collect_snake_config(Platform *p, SnakeConfiguration *game_config,
+                     UserInterfaceCustomization *customization)
+{
+        Configuration *config =
+            assemble_snake_configuration(p->settings_cache);
+
+        auto maybe_interrupt = collect_configuration(p, config, customization);
+        if (maybe_interrupt) {
+                return maybe_interrupt;
+        }
+
+        extract_game_config(game_config, config);
+        free_configuration(config);
+        return std::nullopt;
+}
+
+SnakeConfiguration *load_initial_snake_config(SettingsCache *settings)
+{
+        SnakeConfiguration config = {.speed = 0, .wrap_around = false};
+
+        LOG_DEBUG(TAG, "Trying to load initial settings from the cache.");
+        bool loaded = settings->get(Snake, &config);
+
+        SnakeConfiguration *output = new SnakeConfiguration();
+
+        if (!loaded) {
+                LOG_DEBUG(TAG,
+                          "The storage does not contain a valid "
+                          "snake configuration, using default values.");
+                memcpy(output, &DEFAULT_SNAKE_CONFIG,
+                       sizeof(SnakeConfiguration));
+                settings->put(Snake, &DEFAULT_SNAKE_CONFIG);
+
+        } else {
+                LOG_DEBUG(TAG, "Using configuration from persistent storage.");
+                memcpy(output, &config, sizeof(SnakeConfiguration));
+        }
+
+        LOG_DEBUG(TAG, "Loaded snake configuration: speed=%d, wrap_around=%d",
+                  output->speed, output->wrap_around);
+
+        return output;
+}
+
+bool extract_yes_or_no_option(const char *value);
+const char *map_boolean_to_yes_or_no(bool value);
+
+Configuration *assemble_snake_configuration(SettingsCache *settings)
+{
+        SnakeConfiguration *initial_config =
+            load_initial_snake_config(settings);
+
+        ConfigurationOption *speed = ConfigurationOption::of_integers(
+            "Moves/second", {4, 6, 8, 10}, initial_config->speed);
+
+        ConfigurationOption *wrap_around = ConfigurationOption::of_strings(
+            "Wrap around", {"Yes", "No"},
+            map_boolean_to_yes_or_no(initial_config->wrap_around));
+
+        free(initial_config);
+
+        std::vector<ConfigurationOption *> options = {speed, wrap_around};
+
+        return new Configuration("Snake", options, "Start Game");
+}
+
+void extract_game_config(SnakeConfiguration *game_config,
+                         Configuration *config)
+{
+        ConfigurationOption speed = *config->options[0];
+        int curr_speed_idx = speed.currently_selected;
+        game_config->speed =
+            static_cast<int *>(speed.available_values)[curr_speed_idx];
+
+        ConfigurationOption wrap_around = *config->options[1];
+        int wrap_around_choice_idx = wrap_around.currently_selected;
+        const char *wrap_around_choice = static_cast<const char **>(
+            wrap_around.available_values)[wrap_around_choice_idx];
+        game_config->wrap_around = extract_yes_or_no_option(wrap_around_choice);
+}
+
+void draw_score(Display *display, CellGridDimensions *dimensions, int score)
+{
+        int border_offset = 2;
+        int text_above_grid_y = dimensions->top_vertical_margin -
+                                border_offset - FONT_SIZE -
+                                EXPLANATION_ABOVE_GRID_OFFEST;
+
+        char text[32];
+        snprintf(text, sizeof(text), "Score: %d", score);
+        int text_width = strlen(text) * FONT_WIDTH;
+        int text_x = dimensions->left_horizontal_margin +
+                     (dimensions->actual_width - text_width) / 2;
+#ifdef EMULATOR
+        // The score is redrawn in place after each food pickup, the emulator
+        // display doesn't clear the text background. The text is centered
+        // and grows with the score, so the whole line above the grid is
+        // erased.
+        display->clear_region(
+            {.x = dimensions->left_horizontal_margin, .y = text_above_grid_y},
+            {.x = dimensions->left_horizontal_margin +
+                  dimensions->actual_width,
+             .y = text_above_grid_y + FONT_SIZE},
+            Black);
+#endif
+        display->draw_string({.x = text_x, .y = text_above_grid_y}, text,
+                             FontSize::Size16, Black, White);
+}
+
+void draw_game_canvas(Platform *p, CellGridDimensions *dimensions,
+                      UserInterfaceCustomization *customization)
+{
+        p->display->initialize();
+        p->display->clear(Black);
+
+        int x_margin = dimensions->left_horizontal_margin;
+        int y_margin = dimensions->top_vertical_margin;
+
+        int actual_width = dimensions->actual_width;
+        int actual_height = dimensions->actual_height;
+
+        int border_width = 1;
+        // The border is drawn slightly outside of the grid so that the snake
+        // cells along the edges don't overwrite it.
+        int border_offset = 2;
+
+        /* Rendering of help indicators below the grid */
+        int text_below_grid_y = y_margin + actual_height + border_offset;
+        int r = FONT_SIZE / 4;
+        int d = 2 * r;
+        int circle_y_axis = text_below_grid_y + FONT_SIZE / 2 + r / 4;
+        const char *pause = "Pause";
+        int pause_len = strlen(pause) * FONT_WIDTH;
+        const char *exit = "Exit";
+        int exit_len = strlen(exit) * FONT_WIDTH;
+        // We calculate the even spacing for the two indicators
+        int explanations_num = 2;
+        int circles_width = explanations_num * d;
+        int total_width = pause_len + exit_len + circles_width;
+        int available_width = p->display->get_width() - 2 * x_margin;
+        int remainder_space = available_width - total_width;
+        int even_separator = remainder_space / (explanations_num + 1);
+
+        int yellow_circle_x = x_margin + even_separator;
+        p->display->draw_circle({.x = yellow_circle_x, .y = circle_y_axis}, r,
+                                Yellow, 0, true);
+        int pause_text_x = yellow_circle_x + d;
+        p->display->draw_string({.x = pause_text_x, .y = text_below_grid_y},
+                                (char *)pause, FontSize::Size16, Black, White);
+
+        int blue_circle_x = pause_text_x + pause_len + even_separator;
+        p->display->draw_circle({.x = blue_circle_x, .y = circle_y_axis}, r,
+                                DarkBlue, 0, true);
+        int exit_text_x = blue_circle_x + d;
+        p->display->draw_string({.x = exit_text_x, .y = text_below_grid_y},
+                                (char *)exit, FontSize::Size16, Black, White);
+
+        // We draw the border at the end to ensure that it doesn't get cropped
+        // by draw string operations above.
+        p->display->draw_rectangle(
+            {.x = x_margin - border_offset, .y = y_margin - border_offset},
+            actual_width + 2 * border_offset, actual_height + 2 * border_offset,
+            customization->accent_color, border_width, false);
+}
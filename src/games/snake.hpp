@@ -0,0 +1,37 @@
+#pragma once
+#include "game_executor.hpp"
+#include "common_transitions.hpp"
+#include "../common/configuration.hpp"
+#include <optional>
+
+typedef struct SnakeConfiguration {
+        /**
+         * Number of cells the snake moves per second.
+         */
+        int speed;
+        /**
+         * If set, the snake leaves the grid on one edge and enters on the
+         * opposite one instead of crashing into the wall.
+         */
+        bool wrap_around;
+} SnakeConfiguration;
+
+/**
+ * Similar to `collect_configuration` from `configuration.hpp`, it returns true
+ * if the configuration was successfully collected. Otherwise, if the user
+ * requested exit by pressing the blue button, it returns false and this needs
+ * to be handled by the main game loop.
+ */
+std::optional<UserAction>
+collect_snake_config(Platform *p, SnakeConfiguration *game_config,
+                     UserInterfaceCustomization *customization);
+
+class Snake : public GameExecutor
+{
+      public:
+        virtual void
+        game_loop(Platform *p,
+                  UserInterfaceCustomization *customization) override;
+
+        Snake() {}
+};
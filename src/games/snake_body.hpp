@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Body of the snake stored as a fixed-capacity ring buffer of row-major cell
+ * indices, ordered from the tail to the head. Moving the snake only pushes
+ * the new head and pops the old tail, so a tick takes constant time no matter
+ * how long the snake is.
+ *
+ * The cells occupied by the body are also tracked in a bitset, this allows
+ * for checking collisions without walking the whole body.
+ *
+ * The capacity is the number of cells on the grid as the snake can never be
+ * longer than that, so the buffer never needs to grow during the game.
+ */
+class SnakeBody
+{
+      public:
+        SnakeBody(int capacity)
+            : capacity(capacity), cells(new uint16_t[capacity]),
+              occupancy(new uint8_t[(capacity + 7) / 8]), tail_idx(0),
+              body_length(0)
+        {
+                memset(occupancy, 0, (capacity + 7) / 8);
+        }
+        ~SnakeBody()
+        {
+                delete[] cells;
+                delete[] occupancy;
+        }
+
+        SnakeBody(const SnakeBody &) = delete;
+        SnakeBody &operator=(const SnakeBody &) = delete;
+
+        int length() { return body_length; }
+        bool is_full() { return body_length == capacity; }
+
+        int head() { return cells[(tail_idx + body_length - 1) % capacity]; }
+        int tail() { return cells[tail_idx]; }
+
+        bool occupies(int cell)
+        {
+                return occupancy[cell / 8] & (1 << (cell % 8));
+        }
+
+        /**
+         * Adds a new head segment, the cell needs to be free.
+         */
+        void push_head(int cell)
+        {
+                cells[(tail_idx + body_length) % capacity] = cell;
+                body_length++;
+                occupancy[cell / 8] |= 1 << (cell % 8);
+        }
+
+        /**
+         * Removes the last segment of the tail and returns its cell.
+         */
+        int pop_tail()
+        {
+                int cell = cells[tail_idx];
+                tail_idx = (tail_idx + 1) % capacity;
+                body_length--;
+                occupancy[cell / 8] &= ~(1 << (cell % 8));
+                return cell;
+        }
+
+      private:
+        int capacity;
+        uint16_t *cells;
+        uint8_t *occupancy;
+        int tail_idx;
+        int body_length;
+};
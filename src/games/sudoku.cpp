@@ -0,0 +1,584 @@
+#include <cstdint>
+#include <cstring>
+
+#include "../common/configuration.hpp"
+#include "../common/constants.hpp"
+#include "../common/fixed_timestep.hpp"
+#include "../common/logging.hpp"
+#include "game_menu.hpp"
+#include "settings.hpp"
+#include "sudoku.hpp"
+#include "sudoku_generator.hpp"
+
+#define TAG "sudoku"
+
+/**
+ * Every cell has 20 peers: the other cells in its row, column and box.
+ */
+#define SUDOKU_PEERS 20
+
+SudokuConfiguration DEFAULT_SUDOKU_CONFIG = {.difficulty = Medium};
+
+static CellGridDimensions *calculate_sudoku_grid_dimensions(Display *display);
+static void draw_game_canvas(Platform *p, CellGridDimensions *dimensions,
+                             UserInterfaceCustomization *customization);
+
+/**
+ * Places the digit in the cell (0 clears it) and updates the conflict markers
+ * of the cell and its peers. Only the cells whose state changes are marked
+ * dirty, so the next render redraws just the digits that changed.
+ */
+static void set_digit(SudokuGrid *grid, int cell, int digit);
+static void collect_peers(int cell, uint8_t *peers);
+static bool has_conflict(SudokuGrid *grid, int cell);
+static bool is_solved(SudokuGrid *grid);
+
+static Configuration *
+assemble_sudoku_configuration(SettingsCache *settings);
+static void extract_game_config(SudokuConfiguration *game_config,
+                                Configuration *config);
+
+UserAction sudoku_loop(Platform *platform,
+                       UserInterfaceCustomization *customization);
+
+void Sudoku::game_loop(Platform *p, UserInterfaceCustomization *customization)
+{
+        const char *help_text =
+            "Use the joystick to move the caret around the grid. Press green "
+            "to increase the digit in the cell, red to decrease it and yellow "
+            "to reveal the correct digit. Clashing digits turn red. Press "
+            "blue to exit.";
+
+        bool exit_requested = false;
+        while (!exit_requested) {
+                switch (sudoku_loop(p, customization)) {
+                case UserAction::PlayAgain: {
+                        LOG_DEBUG(TAG, "Sudoku game loop finished. "
+                                       "Pausing for input ");
+                        Direction dir;
+                        Action act = Action::YELLOW;
+                        pause_until_input(p->directional_controllers,
+                                          p->action_controllers, &dir, &act,
+                                          p->delay_provider, p->display);
+
+                        if (act == Action::BLUE) {
+                                exit_requested = true;
+                        }
+                } break;
+                case UserAction::Exit:
+                        exit_requested = true;
+                        break;
+                case UserAction::ShowHelp:
+                        LOG_DEBUG(TAG, "User requested sudoku help screen");
+                        render_wrapped_help_text(p, customization, help_text);
+                        wait_until_green_pressed(p);
+                        break;
+                }
+        }
+}
+
+/**
+ * A single Sudoku game driven by the `FixedTimestepScheduler`. Each update
+ * handles all inputs registered since the previous one and the digits
+ * changed by them are drawn together by `render`.
+ */
+class SudokuSession : public FixedTimestepLoop
+{
+      public:
+        SudokuSession(Platform *p, SudokuGrid *grid, uint8_t *solution)
+            : p(p), grid(grid), solution(solution), is_won(false),
+              exit_requested(false), changed(false)
+        {
+        }
+
+        bool update() override;
+        void render() override;
+
+        bool is_exit_requested() { return exit_requested; }
+
+      private:
+        void handle_action_input(Action act);
+
+        Platform *p;
+        SudokuGrid *grid;
+        uint8_t *solution;
+        bool is_won;
+        bool exit_requested;
+        /**
+         * Set if the grid or the caret changed since the last frame.
+         */
+        bool changed;
+};
+
+UserAction sudoku_loop(Platform *p, UserInterfaceCustomization *customization)
+{
+        LOG_DEBUG(TAG, "Entering Sudoku game loop");
+        SudokuConfiguration config;
+
+        auto maybe_interrupt =
+            collect_sudoku_config(p, &config, customization);
+        if (maybe_interrupt) {
+                return maybe_interrupt.value();
+        }
+
+        CellGridDimensions *gd = calculate_sudoku_grid_dimensions(p->display);
+        draw_game_canvas(p, gd, customization);
+        LOG_DEBUG(TAG, "Sudoku game canvas drawn.");
+
+        uint8_t puzzle[SUDOKU_CELLS];
+        uint8_t solution[SUDOKU_CELLS];
+        generate_sudoku(puzzle, solution, config.difficulty, p->delay_provider,
+                        SUDOKU_GENERATION_BUDGET_MS);
+
+        SudokuRenderer renderer(p->display, gd->cell_width, Cyan);
+        SudokuGrid grid(p->display, gd, &renderer,
+                        customization->accent_color);
+        for (int cell = 0; cell < SUDOKU_CELLS; cell++) {
+                if (puzzle[cell] != 0) {
+                        grid.set(cell % SUDOKU_SIZE, cell / SUDOKU_SIZE,
+                                 puzzle[cell] | SUDOKU_GIVEN_BIT);
+                }
+        }
+        grid.render();
+        grid.set_caret({.x = 0, .y = 0});
+        p->display->refresh();
+
+        SudokuSession session(p, &grid, solution);
+        FixedTimestepScheduler scheduler(p->delay_provider,
+                                         INPUT_POLLING_DELAY,
+                                         INPUT_LOOP_MAX_UPDATES_PER_FRAME);
+        scheduler.run(&session);
+        if (session.is_exit_requested()) {
+                LOG_DEBUG(TAG, "User requested to exit game.");
+                delete gd;
+                return UserAction::Exit;
+        }
+
+        pause_until_any_directional_input(p->directional_controllers,
+                                          p->delay_provider, p->display);
+        display_game_won(p->display, customization);
+        p->display->refresh();
+        delete gd;
+        return UserAction::PlayAgain;
+}
+
+bool SudokuSession::update()
+{
+        while (!is_won && !exit_requested) {
+                Direction dir;
+                Action act;
+                if (directional_input_registered(p->directional_controllers,
+                                                 &dir)) {
+                        grid->move_caret(dir, false);
+                } else if (action_input_registered(p->action_controllers,
+                                                   &act)) {
+                        handle_action_input(act);
+                } else {
+                        break;
+                }
+                changed = true;
+        }
+        return !is_won && !exit_requested;
+}
+
+void SudokuSession::render()
+{
+        if (!changed) {
+                return;
+        }
+        // Only the digits that changed are redrawn.
+        grid->render();
+        p->display->refresh();
+        changed = false;
+}
+
+void SudokuSession::handle_action_input(Action act)
+{
+        Point caret = grid->get_caret();
+        int cell = grid->index(caret.x, caret.y);
+        uint8_t value = grid->get(caret.x, caret.y);
+        int digit = value & SUDOKU_DIGIT_MASK;
+        bool given = value & SUDOKU_GIVEN_BIT;
+
+        switch (act) {
+        case Action::GREEN:
+                if (!given) {
+                        set_digit(grid, cell, (digit + 1) % 10);
+                }
+                break;
+        case Action::RED:
+                if (!given) {
+                        set_digit(grid, cell, (digit + 9) % 10);
+                }
+                break;
+        case Action::YELLOW:
+                if (!given && digit != solution[cell]) {
+                        LOG_DEBUG(TAG, "Hint: cell (%d, %d) is %d.", caret.x,
+                                  caret.y, solution[cell]);
+                        set_digit(grid, cell, solution[cell]);
+                }
+                break;
+        case Action::BLUE:
+                exit_requested = true;
+                return;
+        }
+        is_won = is_solved(grid);
+}
+
+void set_digit(SudokuGrid *grid, int cell, int digit)
+{
+        uint8_t *cells = grid->get_cells();
+        grid->set(cell % SUDOKU_SIZE, cell / SUDOKU_SIZE,
+                  (cells[cell] & ~SUDOKU_DIGIT_MASK) | digit);
+
+        // Changing a digit can only affect the conflicts within its peers.
+        uint8_t peers[SUDOKU_PEERS + 1];
+        collect_peers(cell, peers);
+        peers[SUDOKU_PEERS] = cell;
+        for (int i = 0; i < SUDOKU_PEERS + 1; i++) {
+                int affected = peers[i];
+                uint8_t value = cells[affected] & ~SUDOKU_CONFLICT_BIT;
+                if (has_conflict(grid, affected)) {
+                        value |= SUDOKU_CONFLICT_BIT;
+                }
+                grid->set(affected % SUDOKU_SIZE, affected / SUDOKU_SIZE,
+                          value);
+        }
+}
+
+void collect_peers(int cell, uint8_t *peers)
+{
+        int row = cell / SUDOKU_SIZE;
+        int col = cell % SUDOKU_SIZE;
+        int box_row = row - row % SUDOKU_BOX_SIZE;
+        int box_col = col - col % SUDOKU_BOX_SIZE;
+
+        int count = 0;
+        for (int i = 0; i < SUDOKU_SIZE; i++) {
+                if (i != col) {
+                        peers[count++] = row * SUDOKU_SIZE + i;
+                }
+                if (i != row) {
+                        peers[count++] = i * SUDOKU_SIZE + col;
+                }
+        }
+        // The cells of the box that share the row or column with the cell
+        // have already been collected above.
+        for (int r = box_row; r < box_row + SUDOKU_BOX_SIZE; r++) {
+                for (int c = box_col; c < box_col + SUDOKU_BOX_SIZE; c++) {
+                        if (r != row && c != col) {
+                                peers[count++] = r * SUDOKU_SIZE + c;
+                        }
+                }
+        }
+}
+
+bool has_conflict(SudokuGrid *grid, int cell)
+{
+        uint8_t *cells = grid->get_cells();
+        int digit = cells[cell] & SUDOKU_DIGIT_MASK;
+        if (digit == 0) {
+                return false;
+        }
+        uint8_t peers[SUDOKU_PEERS];
+        collect_peers(cell, peers);
+        for (int i = 0; i < SUDOKU_PEERS; i++) {
+                if ((cells[peers[i]] & SUDOKU_DIGIT_MASK) == digit) {
+                        return true;
+                }
+        }
+        return false;
+}
+
+/**
+ * A complete grid without conflicts is the solution. The generated puzzles
+ * have a unique solution, so there is no need to compare it with the one
+ * produced by the generator.
+ */
+bool is_solved(SudokuGrid *grid)
+{
+        uint8_t *cells = grid->get_cells();
+        for (int cell = 0; cell < SUDOKU_CELLS; cell++) {
+                if ((cells[cell] & SUDOKU_DIGIT_MASK) == 0 ||
+                    (cells[cell] & SUDOKU_CONFLICT_BIT)) {
+                        return false;
+                }
+        }
+        return true;
+}
+
+SudokuRenderer::SudokuRenderer(Display *display, int cell_size,
+                               Color user_digit_color)
+    : cell_size(cell_size), user_digit_color(user_digit_color)
+{
+        glyphs = new GlyphCache(display, Size16, "123456789");
+        glyph_mask = new uint8_t[glyphs->mask_size(1)];
+        int stride = (cell_size + 7) / 8;
+        cell_mask = new uint8_t[stride * cell_size];
+        inside_mask = new uint8_t[stride * cell_size];
+}
+
+SudokuRenderer::~SudokuRenderer()
+{
+        delete glyphs;
+        delete[] glyph_mask;
+        delete[] cell_mask;
+        delete[] inside_mask;
+}
+
+CellAppearance SudokuRenderer::get_appearance(const uint8_t &cell)
+{
+        compose_digit(cell & SUDOKU_DIGIT_MASK, cell_mask, cell_size, 0);
+        return {.mask = cell_mask,
+                .background = Black,
+                .foreground = get_foreground(cell)};
+}
+
+/**
+ * The cells are separated by the grid lines, so each of them is sent to the
+ * display as a separate bitmap that covers only the inside of the cell.
+ */
+void SudokuRenderer::draw_run(Display *display, Point start,
+                              const uint8_t *cells, int length)
+{
+        int inside_size = cell_size - 1;
+        for (int i = 0; i < length; i++) {
+                compose_digit(cells[i] & SUDOKU_DIGIT_MASK, inside_mask,
+                              inside_size, 1);
+                display->draw_bitmap(
+                    {.x = start.x + i * cell_size + 1, .y = start.y + 1},
+                    inside_size, inside_size, inside_mask, Black,
+                    get_foreground(cells[i]));
+        }
+}
+
+void SudokuRenderer::compose_digit(int digit, uint8_t *mask, int size,
+                                   int origin)
+{
+        int stride = (size + 7) / 8;
+        memset(mask, 0, stride * size);
+        if (digit == 0) {
+                return;
+        }
+
+        char label[2] = {(char)('0' + digit), '\0'};
+        glyphs->compose(label, 1, glyph_mask);
+
+        int glyph_width = glyphs->get_glyph_width();
+        int glyph_height = glyphs->get_glyph_height();
+        int glyph_stride = (glyph_width + 7) / 8;
+        // The digit is centered inside the grid lines of the cell.
+        int x_offset = 1 + (cell_size - 1 - glyph_width) / 2 - origin;
+        int y_offset = 1 + (cell_size - 1 - glyph_height) / 2 - origin;
+        for (int y = 0; y < glyph_height; y++) {
+                for (int x = 0; x < glyph_width; x++) {
+                        if (!(glyph_mask[y * glyph_stride + x / 8] &
+                              (0x80 >> (x % 8)))) {
+                                continue;
+                        }
+                        int mx = x + x_offset;
+                        int my = y + y_offset;
+                        mask[my * stride + mx / 8] |= 0x80 >> (mx % 8);
+                }
+        }
+}
+
+Color SudokuRenderer::get_foreground(uint8_t cell)
+{
+        if (cell & SUDOKU_CONFLICT_BIT) {
+                return Red;
+        }
+        return cell & SUDOKU_GIVEN_BIT ? White : user_digit_color;
+}
+
+/**
+ * The 9x9 grid uses the largest square cells that fit into the part of the
+ * display that isn't cut off by its rounded corners. One extra pixel is
+ * reserved for the grid line along the right and bottom edges.
+ */
+CellGridDimensions *calculate_sudoku_grid_dimensions(Display *display)
+{
+        int w = display->get_width();
+        int h = display->get_height();
+        int r = display->get_display_corner_radius();
+
+        int usable_size = (w < h ? w : h) - r - 1;
+        int cell_size = usable_size / SUDOKU_SIZE;
+        int grid_size = cell_size * SUDOKU_SIZE;
+
+        int left_horizontal_margin = (w - grid_size) / 2;
+        int top_vertical_margin = (h - grid_size) / 2;
+
+        LOG_DEBUG(TAG, "Calculated sudoku cell size: %d, left margin: %d, top "
+                       "margin: %d",
+                  cell_size, left_horizontal_margin, top_vertical_margin);
+
+        return new CellGridDimensions(
+            SUDOKU_SIZE, SUDOKU_SIZE, top_vertical_margin,
+            left_horizontal_margin, grid_size, grid_size, cell_size, cell_size);
+}
+
+std::optional<UserAction>
+collect_sudoku_config(Platform *p, SudokuConfiguration *game_config,
+                      UserInterfaceCustomization *customization)
+{
+        Configuration *config =
+            assemble_sudoku_configuration(p->settings_cache);
+
+        auto maybe_interrupt = collect_configuration(p, config, customization);
+        if (maybe_interrupt) {
+                return maybe_interrupt;
+        }
+
+        extract_game_config(game_config, config);
+        free_configuration(config);
+        return std::nullopt;
+}
+
+SudokuConfiguration *load_initial_sudoku_config(SettingsCache *settings)
+{
+        SudokuConfiguration config = {.difficulty = (SudokuDifficulty)0};
+
+        LOG_DEBUG(TAG, "Trying to load initial settings from the cache.");
+        bool loaded = settings->get(Sudoku, &config);
+
+        SudokuConfiguration *output = new SudokuConfiguration();
+
+        if (!loaded) {
+                LOG_DEBUG(TAG,
+                          "The storage does not contain a valid "
+                          "sudoku configuration, using default values.");
+                memcpy(output, &DEFAULT_SUDOKU_CONFIG,
+                       sizeof(SudokuConfiguration));
+                settings->put(Sudoku, &DEFAULT_SUDOKU_CONFIG);
+
+        } else {
+                LOG_DEBUG(TAG, "Using configuration from persistent storage.");
+                memcpy(output, &config, sizeof(SudokuConfiguration));
+        }
+
+        LOG_DEBUG(TAG, "Loaded sudoku configuration: difficulty=%d",
+                  output->difficulty);
+
+        return output;
+}
+
+const char *difficulty_to_str(SudokuDifficulty difficulty)
+{
+        switch (difficulty) {
+        case Easy:
+                return "Easy";
+        case Medium:
+                return "Medium";
+        case Hard:
+                return "Hard";
+        default:
+                return "Unknown";
+        }
+}
+
+SudokuDifficulty difficulty_from_str(const char *name)
+{
+        if (strcmp(name, difficulty_to_str(Medium)) == 0) {
+                return Medium;
+        } else if (strcmp(name, difficulty_to_str(Hard)) == 0) {
+                return Hard;
+        }
+        return Easy;
+}
+
+Configuration *assemble_sudoku_configuration(SettingsCache *settings)
+{
+        SudokuConfiguration *initial_config =
+            load_initial_sudoku_config(settings);
+
+        ConfigurationOption *difficulty = ConfigurationOption::of_strings(
+            "Difficulty",
+            {difficulty_to_str(Easy), difficulty_to_str(Medium),
+             difficulty_to_str(Hard)},
+            difficulty_to_str(initial_config->difficulty));
+
+        free(initial_config);
+
+        std::vector<ConfigurationOption *> options = {difficulty};
+
+        return new Configuration("Sudoku", options, "Start Game");
+}
+
+void extract_game_config(SudokuConfiguration *game_config,
+                         Configuration *config)
+{
+        ConfigurationOption difficulty = *config->options[0];
+        int curr_difficulty_idx = difficulty.currently_selected;
+        game_config->difficulty =
+            difficulty_from_str(static_cast<const char **>(
+                difficulty.available_values)[curr_difficulty_idx]);
+}
+
+void draw_game_canvas(Platform *p, CellGridDimensions *dimensions,
+                      UserInterfaceCustomization *customization)
+{
+        p->display->initialize();
+        p->display->clear(Black);
+
+        int x_margin = dimensions->left_horizontal_margin;
+        int y_margin = dimensions->top_vertical_margin;
+        int grid_size = dimensions->actual_width;
+        int cell_size = dimensions->cell_width;
+
+        /* Grid lines are drawn along the top and left edge of each cell, the
+           lines separating the 3x3 boxes use the accent color. */
+        for (int i = 0; i <= SUDOKU_SIZE; i++) {
+                bool is_box_line = i % SUDOKU_BOX_SIZE == 0;
+                Color color = is_box_line ? customization->accent_color : Gray;
+                int offset = i * cell_size;
+                p->display->clear_region(
+                    {.x = x_margin + offset, .y = y_margin},
+                    {.x = x_margin + offset + 1, .y = y_margin + grid_size + 1},
+                    color);
+                p->display->clear_region(
+                    {.x = x_margin, .y = y_margin + offset},
+                    {.x = x_margin + grid_size + 1, .y = y_margin + offset + 1},
+                    color);
+        }
+
+        /* Rendering of help indicators below the grid */
+        int text_below_grid_y = y_margin + grid_size + 2;
+        int r = FONT_SIZE / 4;
+        int d = 2 * r;
+        int circle_y_axis = text_below_grid_y + FONT_SIZE / 2 + r / 4;
+        const char *next = "Next";
+        int next_len = strlen(next) * FONT_WIDTH;
+        const char *prev = "Prev";
+        int prev_len = strlen(prev) * FONT_WIDTH;
+        const char *hint = "Hint";
+        int hint_len = strlen(hint) * FONT_WIDTH;
+        // We calculate the even spacing for the three indicators
+        int explanations_num = 3;
+        int circles_width = explanations_num * d;
+        int total_width = next_len + prev_len + hint_len + circles_width;
+        int available_width = p->display->get_width() - 2 * x_margin;
+        int remainder_space = available_width - total_width;
+        int even_separator = remainder_space / (explanations_num + 1);
+
+        int green_circle_x = x_margin + even_separator;
+        p->display->draw_circle({.x = green_circle_x, .y = circle_y_axis}, r,
+                                Green, 0, true);
+        int next_text_x = green_circle_x + d;
+        p->display->draw_string({.x = next_text_x, .y = text_below_grid_y},
+                                (char *)next, FontSize::Size16, Black, White);
+
+        int red_circle_x = next_text_x + next_len + even_separator;
+        p->display->draw_circle({.x = red_circle_x, .y = circle_y_axis}, r, Red,
+                                0, true);
+        int prev_text_x = red_circle_x + d;
+        p->display->draw_string({.x = prev_text_x, .y = text_below_grid_y},
+                                (char *)prev, FontSize::Size16, Black, White);
+
+        int yellow_circle_x = prev_text_x + prev_len + even_separator;
+        p->display->draw_circle({.x = yellow_circle_x, .y = circle_y_axis}, r,
+                                Yellow, 0, true);
+        int hint_text_x = yellow_circle_x + d;
+        p->display->draw_string({.x = hint_text_x, .y = text_below_grid_y},
+                                (char *)hint, FontSize::Size16, Black, White);
+}
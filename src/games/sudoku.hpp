@@ -0,0 +1,83 @@
+#pragma once
+#include "game_executor.hpp"
+#include "common_transitions.hpp"
+#include "../common/configuration.hpp"
+#include "../common/glyph_cache.hpp"
+#include "../common/grid_game.hpp"
+#include "sudoku_generator.hpp"
+#include <optional>
+
+/* Layout of a single byte-sized cell of the Sudoku grid. */
+#define SUDOKU_DIGIT_MASK 0x0F
+#define SUDOKU_GIVEN_BIT 0x10
+#define SUDOKU_CONFLICT_BIT 0x20
+
+typedef struct SudokuConfiguration {
+        SudokuDifficulty difficulty;
+} SudokuConfiguration;
+
+/**
+ * Renders the cells of the Sudoku grid. Each cell is drawn as a single bitmap
+ * composed from the cached digit glyphs. The grid lines are drawn once with
+ * the canvas and occupy the top and left pixel row of each cell, so cells only
+ * redraw their inside and never touch the lines.
+ */
+class SudokuRenderer
+{
+      public:
+        /**
+         * Digits entered by the user are drawn using `user_digit_color` to
+         * distinguish them from the given ones.
+         */
+        SudokuRenderer(Display *display, int cell_size,
+                       Color user_digit_color);
+        ~SudokuRenderer();
+
+        SudokuRenderer(const SudokuRenderer &) = delete;
+        SudokuRenderer &operator=(const SudokuRenderer &) = delete;
+
+        /**
+         * The returned mask is valid until the next call to the renderer.
+         */
+        CellAppearance get_appearance(const uint8_t &cell);
+        void draw_run(Display *display, Point start, const uint8_t *cells,
+                      int length);
+
+      private:
+        /**
+         * Composes the mask of a `size` x `size` square with the digit
+         * centered in the cell. `origin` is the offset of the square from the
+         * top left corner of the cell.
+         */
+        void compose_digit(int digit, uint8_t *mask, int size, int origin);
+        Color get_foreground(uint8_t cell);
+
+        GlyphCache *glyphs;
+        int cell_size;
+        Color user_digit_color;
+        uint8_t *glyph_mask;
+        uint8_t *cell_mask;
+        uint8_t *inside_mask;
+};
+
+typedef GridGame<uint8_t, SudokuRenderer, SUDOKU_CELLS> SudokuGrid;
+
+/**
+ * Similar to `collect_configuration` from `configuration.hpp`, it returns true
+ * if the configuration was successfully collected. Otherwise, if the user
+ * requested exit by pressing the blue button, it returns false and this needs
+ * to be handled by the main game loop.
+ */
+std::optional<UserAction>
+collect_sudoku_config(Platform *p, SudokuConfiguration *game_config,
+                      UserInterfaceCustomization *customization);
+
+class Sudoku : public GameExecutor
+{
+      public:
+        virtual void
+        game_loop(Platform *p,
+                  UserInterfaceCustomization *customization) override;
+
+        Sudoku() {}
+};
@@ -0,0 +1,125 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "sudoku_generator.hpp"
+#include "sudoku_puzzle_bank.hpp"
+
+#include "../common/logging.hpp"
+
+#define TAG "sudoku_generator"
+
+int sudoku_target_clues(SudokuDifficulty difficulty)
+{
+        switch (difficulty) {
+        case Easy:
+                return 38;
+        case Medium:
+                return 32;
+        case Hard:
+        default:
+                return 27;
+        }
+}
+
+SudokuGenerationReport generate_sudoku(uint8_t *puzzle, uint8_t *solution,
+                                       SudokuDifficulty difficulty,
+                                       DelayProvider *clock,
+                                       unsigned long time_budget_ms)
+{
+        unsigned long start_time = clock->get_time_ms();
+        int target_clues = sudoku_target_clues(difficulty);
+        SudokuSolver solver;
+
+        // Solving an empty grid with randomized digit order gives us a random
+        // complete grid.
+        memset(puzzle, 0, SUDOKU_CELLS);
+        solver.load(puzzle);
+        solver.solve(true);
+        memcpy(solution, solver.get_grid(), SUDOKU_CELLS);
+        memcpy(puzzle, solution, SUDOKU_CELLS);
+
+        uint8_t order[SUDOKU_CELLS];
+        for (int i = 0; i < SUDOKU_CELLS; i++) {
+                order[i] = i;
+        }
+        for (int i = SUDOKU_CELLS - 1; i > 0; i--) {
+                int j = rand() % (i + 1);
+                uint8_t tmp = order[i];
+                order[i] = order[j];
+                order[j] = tmp;
+        }
+
+        SudokuGenerationReport report = {
+            .clues = SUDOKU_CELLS, .from_bank = false, .duration_ms = 0};
+
+        // Each removal keeps the solution unique, so the puzzle is valid at
+        // any point of this loop, it only gets harder.
+        for (int i = 0; i < SUDOKU_CELLS && report.clues > target_clues; i++) {
+                if (clock->get_time_ms() - start_time >= time_budget_ms) {
+                        break;
+                }
+                int cell = order[i];
+                uint8_t digit = puzzle[cell];
+                puzzle[cell] = 0;
+                solver.load(puzzle);
+                if (solver.count_solutions(2) == 1) {
+                        report.clues--;
+                } else {
+                        puzzle[cell] = digit;
+                }
+        }
+
+        if (report.clues > target_clues) {
+                LOG_INFO(TAG,
+                         "Only reached %d clues out of %d, using a puzzle "
+                         "from the bank.",
+                         report.clues, target_clues);
+                load_sudoku_from_bank(puzzle, solution, difficulty);
+                report.clues = 0;
+                for (int i = 0; i < SUDOKU_CELLS; i++) {
+                        report.clues += puzzle[i] != 0;
+                }
+                report.from_bank = true;
+        }
+
+        report.duration_ms = clock->get_time_ms() - start_time;
+        LOG_INFO(TAG, "Generated sudoku with %d clues in %lu ms%s",
+                 report.clues, report.duration_ms,
+                 report.from_bank ? " (from bank)" : "");
+        return report;
+}
+
+void load_sudoku_from_bank(uint8_t *puzzle, uint8_t *solution,
+                           SudokuDifficulty difficulty)
+{
+        int index = rand() % SUDOKU_BANK_PUZZLES_PER_DIFFICULTY;
+        const char *encoded = get_bank_puzzle(difficulty, index);
+
+        // Random relabelling of the digits, digit d becomes labels[d - 1].
+        uint8_t labels[SUDOKU_SIZE];
+        for (int i = 0; i < SUDOKU_SIZE; i++) {
+                labels[i] = i + 1;
+        }
+        for (int i = SUDOKU_SIZE - 1; i > 0; i--) {
+                int j = rand() % (i + 1);
+                uint8_t tmp = labels[i];
+                labels[i] = labels[j];
+                labels[j] = tmp;
+        }
+        bool transpose = rand() % 2;
+
+        for (int row = 0; row < SUDOKU_SIZE; row++) {
+                for (int col = 0; col < SUDOKU_SIZE; col++) {
+                        int source = transpose ? col * SUDOKU_SIZE + row
+                                               : row * SUDOKU_SIZE + col;
+                        char c = pgm_read_byte(encoded + source);
+                        puzzle[row * SUDOKU_SIZE + col] =
+                            c == '.' ? 0 : labels[c - '1'];
+                }
+        }
+
+        SudokuSolver solver;
+        solver.load(puzzle);
+        solver.solve(false);
+        memcpy(solution, solver.get_grid(), SUDOKU_CELLS);
+}
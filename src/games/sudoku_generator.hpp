@@ -0,0 +1,63 @@
+#pragma once
+#include <cstdint>
+
+#include "../common/platform/interface/delay.hpp"
+#include "sudoku_solver.hpp"
+
+/**
+ * Time budget for removing clues from a generated grid. If the target number
+ * of clues isn't reached within the budget, a puzzle from the built-in bank
+ * is used instead.
+ */
+#define SUDOKU_GENERATION_BUDGET_MS 1000
+
+typedef enum SudokuDifficulty : int {
+        Easy = 1,
+        Medium = 2,
+        Hard = 3,
+} SudokuDifficulty;
+
+/**
+ * Summary of a single puzzle generation, used for reporting the latency of
+ * the generator.
+ */
+typedef struct SudokuGenerationReport {
+        /**
+         * Number of digits given in the final puzzle.
+         */
+        int clues;
+        /**
+         * Set if the generator ran out of time and the puzzle was taken from
+         * the built-in bank.
+         */
+        bool from_bank;
+        unsigned long duration_ms;
+} SudokuGenerationReport;
+
+/**
+ * Number of digits that are given in a puzzle of the difficulty.
+ */
+int sudoku_target_clues(SudokuDifficulty difficulty);
+
+/**
+ * Generates a puzzle with a unique solution. A random complete grid is
+ * generated first and its digits are then removed in a random order, each
+ * removal is only kept if the puzzle still has a unique solution. Removal
+ * stops once the target number of clues for the difficulty is reached.
+ *
+ * Both `puzzle` and `solution` need room for 81 cells, empty cells of the
+ * puzzle are 0.
+ */
+SudokuGenerationReport generate_sudoku(uint8_t *puzzle, uint8_t *solution,
+                                       SudokuDifficulty difficulty,
+                                       DelayProvider *clock,
+                                       unsigned long time_budget_ms);
+
+/**
+ * Loads a random puzzle of the difficulty from the built-in bank. The puzzle
+ * is transformed by relabelling its digits and transposing it, this preserves
+ * the uniqueness of its solution while making the small bank less
+ * repetitive.
+ */
+void load_sudoku_from_bank(uint8_t *puzzle, uint8_t *solution,
+                           SudokuDifficulty difficulty);
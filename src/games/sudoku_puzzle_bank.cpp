@@ -0,0 +1,63 @@
+#include "sudoku_puzzle_bank.hpp"
+
+/**
+ * Puzzles with unique solutions used when the generator can't reach the
+ * target number of clues within its time budget (this can happen on the
+ * Arduino). Each row of the bank holds the puzzles of one difficulty, in the
+ * order of the `SudokuDifficulty` enum.
+ *
+ * The bank was generated offline by running `sudoku-benchmark --bank 6`.
+ */
+const char SUDOKU_PUZZLE_BANK[][SUDOKU_BANK_PUZZLES_PER_DIFFICULTY]
+                             [SUDOKU_CELLS + 1] PROGMEM = {
+    // Easy
+    {
+        "28.....16.....8.24.5..42..84.....1.....4"
+        "95.7...713.2.5913.846.2.7....4.1542.613..",
+        "..1......2978.5.1..43..782...257.6...15."
+        ".4..8.76.829...6...34..524..81..73.4...82",
+        "2...9...5.1.546728..52.7.6...3.6...24..."
+        "..3..172.34596.34.8...1.2.4.5..9.5.1..6..",
+        ".512.7.6.732.8...9..8.3.72.6...5.1.3.14."
+        ".8.728.3..1.5...68..2......4953..95...8.6",
+        "21..8..646...721.85.86.4.973.5...6...21."
+        "..84.....5..7..96.2.451...198.261...6....",
+        "146.8..725.....834.8.427.....4268..7.61."
+        "5..4.....9456...7..1....189.6.256..8.2...",
+    },
+    // Medium
+    {
+        ".4..31..79.385.....18.27...3..48.61....."
+        "1...5.....94328..26...4......52.....43..8",
+        ".24..8...1...7...5....438.661832.5.4...."
+        "..21..9..15...5.7..1.3.9....4.....1.964..",
+        "6.....3.5.84752.1...5.69..4....289...96."
+        ".7.3....193..7.67935..8....1.....4.......",
+        "....7.....715.6..3..5..92..51.7....67.83"
+        "625...3.........49.16.5..7....28..9.2.43.",
+        "4..16...2.1..5..4.7.38.4....46..1.27...7"
+        "......8.2.6.3.5.....6.32.4.1...8..167...4",
+        "...5.4..8..5.71..4.4123.9.7...6...8.2.3."
+        "...7.5.4..72.1.5.12.....1.4...9.39....1..",
+    },
+    // Hard
+    {
+        ".8...1....9......4..6.43....4....6..5.7."
+        ".9..2...5.41....5...27.2..6.7.416..1....8",
+        "...85...6.326...9......74.53.6.2.97....."
+        "...1..5.......6.9.........9.3.6.71358....",
+        ".5.7..4..7..6....946...91.2...8..7919..."
+        "....4..8..1.....1......59..3....8....72.5",
+        "18....7...5.....23...287...8.45..3..3..4"
+        "2.18...98.........94..62.........4.16....",
+        "...1..2.8.......4529..3...631..4......85"
+        "..6..4..6..3.7..3.6..52....7.4...4..5....",
+        "..862.........18...3..4.5.6.......599.2."
+        "...4..5.4..72.4....697.6..1.7.......3...1",
+    },
+};
+
+const char *get_bank_puzzle(SudokuDifficulty difficulty, int index)
+{
+        return SUDOKU_PUZZLE_BANK[difficulty - 1][index];
+}
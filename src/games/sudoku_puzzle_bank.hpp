@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+
+#include "sudoku_generator.hpp"
+
+#ifdef EMULATOR
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#else
+#include <avr/pgmspace.h>
+#endif
+
+#define SUDOKU_BANK_PUZZLES_PER_DIFFICULTY 6
+
+/**
+ * Returns the puzzle from the bank of pre-generated puzzles. The puzzles are
+ * stored in the program memory as 81 characters in the row-major order, with
+ * '.' for the empty cells, so they need to be read using `pgm_read_byte`.
+ */
+const char *get_bank_puzzle(SudokuDifficulty difficulty, int index);
@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "sudoku_solver.hpp"
+
+SudokuSolver::SudokuSolver()
+{
+        memset(grid, 0, sizeof(grid));
+        memset(rows, 0, sizeof(rows));
+        memset(cols, 0, sizeof(cols));
+        memset(boxes, 0, sizeof(boxes));
+}
+
+bool SudokuSolver::load(const uint8_t *puzzle)
+{
+        memset(grid, 0, sizeof(grid));
+        memset(rows, 0, sizeof(rows));
+        memset(cols, 0, sizeof(cols));
+        memset(boxes, 0, sizeof(boxes));
+
+        for (int cell = 0; cell < SUDOKU_CELLS; cell++) {
+                int digit = puzzle[cell];
+                if (digit == 0) {
+                        continue;
+                }
+                if (!(cell_candidates(cell) & (1 << (digit - 1)))) {
+                        return false;
+                }
+                place(cell, digit);
+        }
+        return true;
+}
+
+int SudokuSolver::count_solutions(int limit) { return search(limit, false); }
+
+bool SudokuSolver::solve(bool randomize) { return search(1, randomize) == 1; }
+
+/**
+ * Depth-first search over the empty cells. Each level of the stack holds the
+ * cell that was branched on and its candidates that are still to be tried.
+ * When the search stops because `limit` solutions were found, the grid is left
+ * filled with the last solution.
+ */
+int SudokuSolver::search(int limit, bool randomize)
+{
+        int solutions = 0;
+        uint16_t candidates;
+        int cell = select_cell(&candidates);
+        if (cell == -1) {
+                return 1;
+        }
+        if (candidates == 0) {
+                return 0;
+        }
+
+        int depth = 0;
+        stack_cells[0] = cell;
+        stack_candidates[0] = candidates;
+        while (depth >= 0) {
+                cell = stack_cells[depth];
+                // Undo the digit that was tried at this depth previously.
+                if (grid[cell] != 0) {
+                        remove(cell);
+                }
+                uint16_t remaining = stack_candidates[depth];
+                if (remaining == 0) {
+                        depth--;
+                        continue;
+                }
+
+                uint16_t choice = remaining;
+                if (randomize) {
+                        // Clearing the lowest set bits selects a uniformly
+                        // random candidate.
+                        int skip = rand() % __builtin_popcount(remaining);
+                        while (skip-- > 0) {
+                                choice &= choice - 1;
+                        }
+                }
+                int bit = __builtin_ctz(choice);
+                stack_candidates[depth] = remaining & ~(1 << bit);
+                place(cell, bit + 1);
+
+                int next = select_cell(&candidates);
+                if (next == -1) {
+                        solutions++;
+                        if (solutions >= limit) {
+                                return solutions;
+                        }
+                        continue;
+                }
+                // Dead end, we try the next digit at the current depth.
+                if (candidates == 0) {
+                        continue;
+                }
+                depth++;
+                stack_cells[depth] = next;
+                stack_candidates[depth] = candidates;
+        }
+        return solutions;
+}
+
+int SudokuSolver::select_cell(uint16_t *candidates)
+{
+        int best_cell = -1;
+        int best_count = SUDOKU_SIZE + 1;
+        for (int cell = 0; cell < SUDOKU_CELLS; cell++) {
+                if (grid[cell] != 0) {
+                        continue;
+                }
+                uint16_t mask = cell_candidates(cell);
+                int count = __builtin_popcount(mask);
+                if (count < best_count) {
+                        best_cell = cell;
+                        best_count = count;
+                        *candidates = mask;
+                        // A cell with 0 or 1 candidates can't be beaten.
+                        if (count <= 1) {
+                                break;
+                        }
+                }
+        }
+        return best_cell;
+}
+
+void SudokuSolver::place(int cell, int digit)
+{
+        uint16_t bit = 1 << (digit - 1);
+        grid[cell] = digit;
+        rows[cell / SUDOKU_SIZE] |= bit;
+        cols[cell % SUDOKU_SIZE] |= bit;
+        boxes[box_of(cell)] |= bit;
+}
+
+void SudokuSolver::remove(int cell)
+{
+        uint16_t bit = 1 << (grid[cell] - 1);
+        grid[cell] = 0;
+        rows[cell / SUDOKU_SIZE] &= ~bit;
+        cols[cell % SUDOKU_SIZE] &= ~bit;
+        boxes[box_of(cell)] &= ~bit;
+}
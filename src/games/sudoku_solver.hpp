@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+
+#define SUDOKU_SIZE 9
+#define SUDOKU_CELLS 81
+#define SUDOKU_BOX_SIZE 3
+/* Bitmask with all nine digits set, bit `d - 1` represents the digit `d`. */
+#define SUDOKU_ALL_DIGITS 0x1FF
+
+/**
+ * Backtracking Sudoku solver based on candidate bitmasks.
+ *
+ * For each row, column and box, the solver keeps a 9-bit mask of the digits
+ * that are already placed there, so the candidates of a cell are computed
+ * with two ORs and a negation. At each step it branches on the empty cell with
+ * the fewest candidates (minimum remaining values), which keeps the search
+ * tree small enough for checking the uniqueness of a puzzle on the Arduino.
+ *
+ * The search is iterative and uses fixed-size stacks, so its memory usage
+ * doesn't depend on the depth of the recursion.
+ *
+ * Grids are stored as 81 bytes in the row-major order, 0 is an empty cell.
+ */
+class SudokuSolver
+{
+      public:
+        SudokuSolver();
+
+        /**
+         * Loads the grid into the solver. Returns false if the digits that are
+         * already placed contradict each other, such a grid has no solutions.
+         */
+        bool load(const uint8_t *grid);
+
+        /**
+         * Counts the solutions of the loaded grid, stopping once `limit` of
+         * them have been found. Checking if a puzzle has a unique solution
+         * only needs a limit of 2.
+         */
+        int count_solutions(int limit);
+
+        /**
+         * Solves the loaded grid. If `randomize` is set, the digits are tried
+         * in a random order, which allows for generating random complete
+         * grids by solving an empty one. Returns false if there is no
+         * solution.
+         */
+        bool solve(bool randomize);
+
+        /**
+         * After a successful `solve`, contains the solution.
+         */
+        const uint8_t *get_grid() { return grid; }
+
+      private:
+        int search(int limit, bool randomize);
+        /**
+         * Returns the empty cell with the fewest candidates and stores the
+         * candidates in `candidates`. Returns -1 if the grid is full.
+         */
+        int select_cell(uint16_t *candidates);
+        void place(int cell, int digit);
+        void remove(int cell);
+
+        uint16_t cell_candidates(int cell)
+        {
+                return ~(rows[cell / SUDOKU_SIZE] | cols[cell % SUDOKU_SIZE] |
+                         boxes[box_of(cell)]) &
+                       SUDOKU_ALL_DIGITS;
+        }
+        static int box_of(int cell)
+        {
+                int row = cell / SUDOKU_SIZE;
+                int col = cell % SUDOKU_SIZE;
+                return (row / SUDOKU_BOX_SIZE) * SUDOKU_BOX_SIZE +
+                       col / SUDOKU_BOX_SIZE;
+        }
+
+        uint8_t grid[SUDOKU_CELLS];
+        uint16_t rows[SUDOKU_SIZE];
+        uint16_t cols[SUDOKU_SIZE];
+        uint16_t boxes[SUDOKU_SIZE];
+
+        /**
+         * Search stacks: the cell that was branched on at each depth and
+         * the candidates that haven't been tried there yet.
+         */
+        uint8_t stack_cells[SUDOKU_CELLS];
+        uint16_t stack_candidates[SUDOKU_CELLS];
+};